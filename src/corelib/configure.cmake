@@ -181,6 +181,28 @@ std::filesystem::copy(
 "# FIXME: qmake: CONFIG += c++17
 )
 
+# epoll
+qt_config_compile_test(epoll
+    LABEL "epoll"
+    CODE
+"
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+int main(int argc, char **argv)
+{
+    (void)argc; (void)argv;
+    /* BEGIN TEST: */
+struct epoll_event ev;
+int fd = epoll_create1(EPOLL_CLOEXEC);
+epoll_ctl(fd, EPOLL_CTL_ADD, 0, &ev);
+epoll_wait(fd, &ev, 1, 0);
+timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    /* END TEST: */
+    return 0;
+}
+")
+
 # eventfd
 qt_config_compile_test(eventfd
     LABEL "eventfd"
@@ -307,6 +329,29 @@ inotify_rm_watch(0, 1);
 }
 ")
 
+# io_uring
+qt_config_compile_test(io_uring
+    LABEL "io_uring"
+    CODE
+"
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+int main(int argc, char **argv)
+{
+    (void)argc; (void)argv;
+    /* BEGIN TEST: */
+struct io_uring_params params = {};
+int fd = syscall(__NR_io_uring_setup, 8, &params);
+syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, 0, 0);
+syscall(__NR_io_uring_enter, fd, 0, 0, 0, 0, 0);
+(void)IORING_OP_READ;
+    /* END TEST: */
+    return 0;
+}
+")
+
 # ipc_sysv
 qt_config_compile_test(ipc_sysv
     LABEL "SysV IPC"
@@ -561,6 +606,10 @@ qt_feature("cxx17_filesystem" PUBLIC
     LABEL "C++17 <filesystem>"
     CONDITION TEST_cxx17_filesystem
 )
+qt_feature("epoll" PRIVATE
+    LABEL "epoll event dispatcher"
+    CONDITION LINUX AND TEST_epoll
+)
 qt_feature("eventfd" PUBLIC
     LABEL "eventfd"
     CONDITION NOT WASM AND TEST_eventfd
@@ -603,6 +652,10 @@ qt_feature("inotify" PUBLIC PRIVATE
     CONDITION TEST_inotify
 )
 qt_feature_definition("inotify" "QT_NO_INOTIFY" NEGATE VALUE "1")
+qt_feature("io_uring" PRIVATE
+    LABEL "io_uring"
+    CONDITION LINUX AND TEST_io_uring
+)
 qt_feature("ipc_posix"
     LABEL "Using POSIX IPC"
     AUTODETECT NOT WIN32
@@ -935,6 +988,11 @@ qt_feature("etw" PRIVATE
     ENABLE INPUT_trace STREQUAL 'etw' OR ( INPUT_trace STREQUAL 'yes' AND WIN32 )
     DISABLE INPUT_trace STREQUAL 'lttng' OR INPUT_trace STREQUAL 'no'
 )
+qt_feature("eventstatistics" PRIVATE
+    LABEL "Event loop statistics"
+    PURPOSE "Records event dispatch latency histograms per thread."
+    AUTODETECT OFF
+)
 qt_feature("forkfd_pidfd" PRIVATE
     LABEL "CLONE_PIDFD support in forkfd"
     CONDITION LINUX
@@ -957,6 +1015,14 @@ qt_configure_add_summary_section(NAME "Qt Core")
 qt_configure_add_summary_entry(ARGS "doubleconversion")
 qt_configure_add_summary_entry(ARGS "system-doubleconversion")
 qt_configure_add_summary_entry(ARGS "glib")
+qt_configure_add_summary_entry(
+    ARGS "epoll"
+    CONDITION LINUX
+)
+qt_configure_add_summary_entry(
+    ARGS "io_uring"
+    CONDITION LINUX
+)
 qt_configure_add_summary_entry(ARGS "icu")
 qt_configure_add_summary_entry(ARGS "system-libb2")
 qt_configure_add_summary_entry(ARGS "mimetype-database")
@@ -915,6 +915,7 @@ bool QFile::open(OpenMode mode)
         QIODevice::open(mode);
         if (mode & Append)
             seek(size());
+        d->startAsyncIo();
         return true;
     }
     QFile::FileError err = d->fileEngine->error();
@@ -990,6 +991,7 @@ bool QFile::open(FILE *fh, OpenMode mode, FileHandleFlags handleFlags)
                 QIODevice::seek(pos);
             }
         }
+        d->startAsyncIo();
         return true;
     }
     return false;
@@ -1042,6 +1044,7 @@ bool QFile::open(int fd, OpenMode mode, FileHandleFlags handleFlags)
                 QIODevice::seek(pos);
             }
         }
+        d->startAsyncIo();
         return true;
     }
     return false;
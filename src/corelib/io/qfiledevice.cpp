@@ -42,6 +42,10 @@
 #include "qfiledevice_p.h"
 #include "qfsfileengine_p.h"
 
+#if QT_CONFIG(io_uring)
+#  include "qioring_p.h"
+#endif
+
 #ifdef QT_NO_QOBJECT
 #define tr(X) QString::fromLatin1(X)
 #endif
@@ -52,6 +56,16 @@ QT_BEGIN_NAMESPACE
 #define QFILE_WRITEBUFFER_SIZE 16384
 #endif
 
+#if QT_CONFIG(io_uring)
+// size of a single asynchronous read, and how much data may pile up in the
+// read buffer before read-ahead pauses
+enum {
+    AsyncReadChunkSize = 256 * 1024,
+    AsyncReadAheadLimit = 4 * AsyncReadChunkSize,
+    AsyncMaxWriteSize = 1024 * 1024 * 1024
+};
+#endif
+
 QFileDevicePrivate::QFileDevicePrivate()
     : cachedSize(0),
       error(QFile::NoError), lastWasWrite(false)
@@ -68,6 +82,166 @@ QAbstractFileEngine *QFileDevicePrivate::engine() const
     return fileEngine.get();
 }
 
+/*!
+    \internal
+
+    Switches an open device to asynchronous I/O if that was requested and is
+    possible for this file. Called whenever the device has been opened.
+*/
+void QFileDevicePrivate::startAsyncIo()
+{
+#if QT_CONFIG(io_uring)
+    Q_Q(QFileDevice);
+    if (!asyncRequested || ioRing || openMode == QIODevice::NotOpen || !fileEngine
+        || fileEngine->isSequential() || fileEngine->handle() == -1) {
+        return;
+    }
+
+    QIORing *ring = QIORing::threadInstance();
+    if (!ring)
+        return;
+
+    // the write buffer is bypassed from now on
+    if (!q->flush())
+        return;
+    lastWasWrite = false;
+
+    // asynchronous reads append to the read buffer at devicePos, so both
+    // must describe the same position
+    if (devicePos != pos + buffer.size()) {
+        buffer.clear();
+        devicePos = pos;
+    }
+
+    ioRing = ring;
+    asyncReadAtEnd = false;
+    startAsyncRead();
+#endif
+}
+
+/*!
+    \internal
+
+    Waits for all asynchronous operations to finish and switches back to
+    blocking I/O.
+*/
+void QFileDevicePrivate::stopAsyncIo()
+{
+#if QT_CONFIG(io_uring)
+    if (!ioRing)
+        return;
+
+    waitForAsyncWrites(QDeadlineTimer(QDeadlineTimer::Forever), true);
+
+    // a read still in flight is discarded by asyncReadFinished()
+    QIORing *ring = ioRing;
+    ioRing = nullptr;
+    if (asyncReadId)
+        ring->waitForCompleted(asyncReadId);
+#endif
+}
+
+#if QT_CONFIG(io_uring)
+void QFileDevicePrivate::startAsyncRead()
+{
+    if (!ioRing || asyncReadId || asyncReadAtEnd || !(openMode & QIODevice::ReadOnly)
+        || buffer.size() >= AsyncReadAheadLimit) {
+        return;
+    }
+
+    // The completion handler keeps a reference to the chunk, so the kernel
+    // always writes to valid memory.
+    QByteArray chunk(AsyncReadChunkSize, Qt::Uninitialized);
+    char *data = chunk.data(); // must not detach once the handler shares it
+    const qint64 offset = devicePos;
+    asyncReadId = ioRing->read(fileEngine->handle(), data, AsyncReadChunkSize, offset,
+                               [this, chunk, offset](qint64 result) {
+        asyncReadFinished(chunk, offset, result);
+    });
+    if (!asyncReadId)
+        setError(QFileDevice::ReadError, errno);
+}
+
+void QFileDevicePrivate::asyncReadFinished(const QByteArray &chunk, qint64 offset, qint64 result)
+{
+    Q_Q(QFileDevice);
+    asyncReadId = 0;
+
+    // Stale if asynchronous I/O was stopped, or if the device position was
+    // changed by a seek or a write while the read was in flight.
+    if (!ioRing)
+        return;
+    if (offset != devicePos) {
+        startAsyncRead();
+        return;
+    }
+
+    if (result < 0) {
+        setError(QFileDevice::ReadError, int(-result));
+        return;
+    }
+    if (result == 0) {
+        asyncReadAtEnd = true;
+        return;
+    }
+
+    // a full chunk is handed over without copying
+    if (result == chunk.size())
+        buffer.append(chunk);
+    else
+        buffer.append(chunk.constData(), result);
+    devicePos += result;
+    startAsyncRead();
+
+    emit q->readyRead();
+}
+
+bool QFileDevicePrivate::submitAsyncWrite(const QByteArray &chunk, qint64 offset)
+{
+    const quint64 id = ioRing->write(fileEngine->handle(), chunk.constData(), chunk.size(), offset,
+                                     [this, chunk, offset](qint64 result) {
+        asyncWriteFinished(chunk, offset, result);
+    });
+    if (!id) {
+        setError(QFileDevice::WriteError, errno);
+        return false;
+    }
+    asyncWriteIds.append(id);
+    return true;
+}
+
+void QFileDevicePrivate::asyncWriteFinished(const QByteArray &chunk, qint64 offset, qint64 result)
+{
+    Q_Q(QFileDevice);
+    QIORing *ring = QIORing::threadInstance();
+    asyncWriteIds.removeIf([ring](quint64 id) { return !ring->isPending(id); });
+
+    if (result < 0) {
+        asyncPendingWriteBytes -= chunk.size();
+        setError(QFileDevice::WriteError, int(-result));
+        return;
+    }
+
+    asyncPendingWriteBytes -= result;
+    if (result < chunk.size() && (!ioRing || !submitAsyncWrite(chunk.mid(result), offset + result)))
+        asyncPendingWriteBytes -= chunk.size() - result;
+
+    emit q->bytesWritten(result);
+}
+
+bool QFileDevicePrivate::waitForAsyncWrites(QDeadlineTimer deadline, bool all)
+{
+    if (asyncWriteIds.isEmpty())
+        return false;
+    QIORing *ring = QIORing::threadInstance();
+    do {
+        if (!ring->waitForCompleted(asyncWriteIds.constFirst(), deadline))
+            return false;
+    } while (all && !asyncWriteIds.isEmpty());
+    return true;
+}
+#endif // QT_CONFIG(io_uring)
+
 void QFileDevicePrivate::setError(QFileDevice::FileError err)
 {
     error = err;
@@ -282,6 +456,12 @@ bool QFileDevice::flush()
         return false;
     }
 
+#if QT_CONFIG(io_uring)
+    d->waitForAsyncWrites(QDeadlineTimer(QDeadlineTimer::Forever), true);
+    if (d->error == QFileDevice::WriteError)
+        return false;
+#endif
+
     if (!d->writeBuffer.isEmpty()) {
         qint64 size = d->writeBuffer.nextDataBlockSize();
         qint64 written = d->fileEngine->write(d->writeBuffer.readPointer(), size);
@@ -317,6 +497,7 @@ void QFileDevice::close()
     if (!isOpen())
         return;
     bool flushed = flush();
+    d->stopAsyncIo();
     QIODevice::close();
 
     // reset write buffer
@@ -364,6 +545,12 @@ bool QFileDevice::atEnd() const
     if (!d->ensureFlushed())
         return false;
 
+#if QT_CONFIG(io_uring)
+    // the engine's file position is not used for asynchronous reads
+    if (d->ioRing)
+        return pos() >= size();
+#endif
+
     // If the file engine knows best, say what it says.
     if (d->fileEngine->supportsExtension(QAbstractFileEngine::AtEndExtension)) {
         // Check if the file engine supports AtEndExtension, and if it does,
@@ -414,6 +601,18 @@ bool QFileDevice::seek(qint64 off)
         return false;
     }
     unsetError();
+
+#if QT_CONFIG(io_uring)
+    if (d->ioRing) {
+        // Restart read-ahead at the new position; data still in flight for
+        // the old one is dropped when it arrives. Pending writes may overlap
+        // the region read next, so they have to land first.
+        d->waitForAsyncWrites(QDeadlineTimer(QDeadlineTimer::Forever), true);
+        d->buffer.clear();
+        d->asyncReadAtEnd = false;
+        d->startAsyncRead();
+    }
+#endif
     return true;
 }
 
@@ -426,6 +625,12 @@ qint64 QFileDevice::readLineData(char *data, qint64 maxlen)
     if (!d->ensureFlushed())
         return -1;
 
+#if QT_CONFIG(io_uring)
+    // the engine would read synchronously from the descriptor's position
+    if (d->ioRing)
+        return QIODevice::readLineData(data, maxlen);
+#endif
+
     qint64 read;
     if (d->fileEngine->supportsExtension(QAbstractFileEngine::FastReadLineExtension)) {
         read = d->fileEngine->readLine(data, maxlen);
@@ -455,6 +660,18 @@ qint64 QFileDevice::readData(char *data, qint64 len)
     if (!d->ensureFlushed())
         return -1;
 
+#if QT_CONFIG(io_uring)
+    if (d->ioRing) {
+        // Only data that has already arrived in the buffer can be read, make
+        // sure more is on its way. Reading at the end restarts read-ahead, in
+        // case the file has grown.
+        Q_UNUSED(data);
+        d->asyncReadAtEnd = false;
+        d->startAsyncRead();
+        return 0;
+    }
+#endif
+
     const qint64 read = d->fileEngine->read(data, len);
     if (read < 0) {
         QFileDevice::FileError err = d->fileEngine->error();
@@ -536,6 +753,22 @@ qint64 QFileDevice::writeData(const char *data, qint64 len)
     Q_D(QFileDevice);
     unsetError();
     d->lastWasWrite = true;
+
+#if QT_CONFIG(io_uring)
+    if (d->ioRing) {
+        qint64 offset = d->devicePos;
+        for (qint64 written = 0; written < len; ) {
+            const qint64 chunkSize = qMin(len - written, qint64(AsyncMaxWriteSize));
+            if (!d->submitAsyncWrite(QByteArray(data + written, chunkSize), offset))
+                return written ? written : -1;
+            d->asyncPendingWriteBytes += chunkSize;
+            written += chunkSize;
+            offset += chunkSize;
+        }
+        return len;
+    }
+#endif
+
     bool buffered = !(d->openMode & Unbuffered);
 
     // Flush buffered data if this read will overflow.
@@ -604,6 +837,134 @@ qint64 QFileDevice::size() const
     return d->cachedSize;
 }
 
+/*!
+    \reimp
+    \since 6.2
+
+    In asynchronous mode, this also includes data that has been handed to
+    the operating system but not yet written to the file.
+*/
+qint64 QFileDevice::bytesToWrite() const
+{
+#if QT_CONFIG(io_uring)
+    Q_D(const QFileDevice);
+    return QIODevice::bytesToWrite() + d->asyncPendingWriteBytes;
+#else
+    return QIODevice::bytesToWrite();
+#endif
+}
+
+/*!
+    \since 6.2
+
+    Returns \c true if the file is read and written asynchronously;
+    otherwise returns \c false.
+
+    \sa setAsynchronous()
+*/
+bool QFileDevice::isAsynchronous() const
+{
+#if QT_CONFIG(io_uring)
+    Q_D(const QFileDevice);
+    return d->ioRing != nullptr;
+#else
+    return false;
+#endif
+}
+
+/*!
+    \since 6.2
+
+    If \a enable is true, the file is read and written asynchronously
+    whenever it is open; otherwise blocking I/O is used, which is the
+    default. The setting can be changed before or after the file is opened.
+
+    In asynchronous mode, read() only returns data that has already arrived;
+    readyRead() is emitted when more becomes available, and the file is read
+    ahead of the current position. write() returns immediately and
+    bytesWritten() is emitted once the data has reached the file. Both
+    signals require a running event loop in the thread that opened the file,
+    or calls to waitForReadyRead() and waitForBytesWritten().
+
+    Asynchronous I/O is only available for regular files on platforms that
+    support it (currently Linux with io_uring). Otherwise, and for
+    sequential files, the request is ignored and isAsynchronous() returns
+    \c false.
+
+    \sa isAsynchronous(), waitForReadyRead(), waitForBytesWritten()
+*/
+void QFileDevice::setAsynchronous(bool enable)
+{
+    Q_D(QFileDevice);
+    d->asyncRequested = enable;
+    if (!isOpen())
+        return;
+
+    if (enable) {
+        d->startAsyncIo();
+    } else {
+#if QT_CONFIG(io_uring)
+        if (!d->ioRing)
+            return;
+        d->stopAsyncIo();
+        // the engine takes over at the current device position
+        d->buffer.clear();
+        d->devicePos = d->pos;
+        d->fileEngine->seek(d->pos);
+#endif
+    }
+}
+
+/*!
+    \reimp
+    \since 6.2
+
+    In asynchronous mode, blocks until new data has been read ahead, an
+    error occurred, the end of the file is reached, or \a msecs
+    milliseconds have passed. Returns \c true if new data is available.
+
+    \sa setAsynchronous()
+*/
+bool QFileDevice::waitForReadyRead(int msecs)
+{
+#if QT_CONFIG(io_uring)
+    Q_D(QFileDevice);
+    if (d->ioRing) {
+        if (!d->asyncReadId) {
+            d->asyncReadAtEnd = false;
+            d->startAsyncRead();
+        }
+        if (!d->asyncReadId)
+            return false;
+        const qint64 before = d->buffer.size();
+        if (!d->ioRing->waitForCompleted(d->asyncReadId, QDeadlineTimer(msecs)))
+            return false;
+        return d->buffer.size() > before;
+    }
+#endif
+    return QIODevice::waitForReadyRead(msecs);
+}
+
+/*!
+    \reimp
+    \since 6.2
+
+    In asynchronous mode, blocks until at least one pending write has
+    completed, or \a msecs milliseconds have passed. Returns \c true if
+    data was written.
+
+    \sa setAsynchronous()
+*/
+bool QFileDevice::waitForBytesWritten(int msecs)
+{
+#if QT_CONFIG(io_uring)
+    Q_D(QFileDevice);
+    if (d->ioRing)
+        return d->waitForAsyncWrites(QDeadlineTimer(msecs), false);
+#endif
+    return QIODevice::waitForBytesWritten(msecs);
+}
+
 /*!
     Sets the file size (in bytes) \a sz. Returns \c true if the
     resize succeeds; false otherwise. If \a sz is larger than the file
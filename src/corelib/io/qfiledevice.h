@@ -113,6 +113,13 @@ public:
     bool flush();
 
     qint64 size() const override;
+    qint64 bytesToWrite() const override;
+
+    bool isAsynchronous() const;
+    void setAsynchronous(bool enable);
+
+    bool waitForReadyRead(int msecs) override;
+    bool waitForBytesWritten(int msecs) override;
 
     virtual bool resize(qint64 sz);
     virtual Permissions permissions() const;
@@ -53,12 +53,17 @@
 
 #include "private/qiodevice_p.h"
 
+#if QT_CONFIG(io_uring)
+#  include "QtCore/qdeadlinetimer.h"
+#endif
+
 #include <memory>
 
 QT_BEGIN_NAMESPACE
 
 class QAbstractFileEngine;
 class QFSFileEngine;
+class QIORing;
 
 class QFileDevicePrivate : public QIODevicePrivate
 {
@@ -77,6 +82,16 @@ protected:
     void setError(QFileDevice::FileError err, const QString &errorString);
     void setError(QFileDevice::FileError err, int errNum);
 
+    void startAsyncIo();
+    void stopAsyncIo();
+#if QT_CONFIG(io_uring)
+    void startAsyncRead();
+    void asyncReadFinished(const QByteArray &chunk, qint64 offset, qint64 result);
+    bool submitAsyncWrite(const QByteArray &chunk, qint64 offset);
+    void asyncWriteFinished(const QByteArray &chunk, qint64 offset, qint64 result);
+    bool waitForAsyncWrites(QDeadlineTimer deadline, bool all);
+#endif
+
     mutable std::unique_ptr<QAbstractFileEngine> fileEngine;
     mutable qint64 cachedSize;
 
@@ -84,6 +99,14 @@ protected:
     QFileDevice::FileError error;
 
     bool lastWasWrite;
+    bool asyncRequested = false;
+#if QT_CONFIG(io_uring)
+    bool asyncReadAtEnd = false;
+    QIORing *ioRing = nullptr; // set while asynchronous I/O is active
+    quint64 asyncReadId = 0;
+    QList<quint64> asyncWriteIds;
+    qint64 asyncPendingWriteBytes = 0;
+#endif
 };
 
 inline bool QFileDevicePrivate::ensureFlushed() const
@@ -0,0 +1,375 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qioring_p.h"
+
+#include <QtCore/qabstracteventdispatcher.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qsocketnotifier.h>
+#include <QtCore/qthreadstorage.h>
+#include <QtCore/qvarlengtharray.h>
+#include <QtCore/private/qcore_unix_p.h>
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    QIORing is a minimal wrapper around a Linux io_uring instance, talking to
+    the kernel through the raw system calls so that no extra library is
+    needed. There is at most one ring per thread; completions are reported
+    through an eventfd, which is watched by a QSocketNotifier and therefore
+    works with whichever event dispatcher the thread is running. Threads
+    without an event loop can still drive the ring through
+    waitForCompleted().
+
+    threadInstance() returns \nullptr if the kernel does not provide
+    io_uring, or lacks the IORING_OP_READ / IORING_OP_WRITE operations
+    (Linux < 5.6), or if the system calls are filtered out. Callers are
+    expected to fall back to blocking I/O in that case.
+*/
+
+enum { RingEntries = 64 };
+
+static QBasicAtomicInt ioRingUnavailable = Q_BASIC_ATOMIC_INITIALIZER(0);
+Q_GLOBAL_STATIC(QThreadStorage<QIORing *>, ioRings)
+
+static inline int io_uring_setup(unsigned entries, io_uring_params *params)
+{
+    return int(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+static inline int io_uring_enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    return int(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+static inline int io_uring_register(int fd, unsigned opcode, void *arg, unsigned nrArgs)
+{
+    return int(::syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+
+static inline unsigned loadAcquire(const unsigned *p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void storeRelease(unsigned *p, unsigned v)
+{
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+QIORing::QIORing() = default;
+
+QIORing::~QIORing()
+{
+    // Operations still in flight reference memory owned by their
+    // submitters, who are responsible for waiting for them.
+    notifier.reset();
+    if (sqes)
+        ::munmap(sqes, sqesSize);
+    if (cqRing && cqRing != sqRing)
+        ::munmap(cqRing, cqRingSize);
+    if (sqRing)
+        ::munmap(sqRing, sqRingSize);
+    if (ringFd != -1)
+        qt_safe_close(ringFd);
+    if (eventFd != -1)
+        qt_safe_close(eventFd);
+}
+
+/*!
+    \internal
+
+    Returns the io_uring instance of the calling thread, creating it on first
+    use, or \nullptr if io_uring cannot be used.
+*/
+QIORing *QIORing::threadInstance()
+{
+    if (ioRingUnavailable.loadRelaxed())
+        return nullptr;
+
+    QThreadStorage<QIORing *> *rings = ioRings();
+    if (!rings)
+        return nullptr;
+    if (rings->hasLocalData())
+        return rings->localData();
+
+    QIORing *ring = new QIORing;
+    if (!ring->init(RingEntries)) {
+        delete ring;
+        ring = nullptr;
+        if (errno == ENOSYS || errno == EPERM || errno == EINVAL || errno == EOPNOTSUPP)
+            ioRingUnavailable.storeRelaxed(1);
+    }
+    rings->setLocalData(ring);
+    return ring;
+}
+
+bool QIORing::init(unsigned entries)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ringFd = io_uring_setup(entries, &params);
+    if (ringFd == -1)
+        return false;
+
+    // We need IORING_OP_READ and IORING_OP_WRITE, which came with the probe
+    // interface (Linux 5.6)
+    const size_t probeSize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+    std::unique_ptr<char[]> probeData(new char[probeSize]);
+    memset(probeData.get(), 0, probeSize);
+    auto probe = reinterpret_cast<io_uring_probe *>(probeData.get());
+    if (io_uring_register(ringFd, IORING_REGISTER_PROBE, probe, 256) == -1)
+        return false;
+    const auto supported = [probe](int op) {
+        return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+    };
+    if (!supported(IORING_OP_READ) || !supported(IORING_OP_WRITE)) {
+        errno = EOPNOTSUPP;
+        return false;
+    }
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMap)
+        sqRingSize = cqRingSize = qMax(sqRingSize, cqRingSize);
+
+    sqRing = ::mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        sqRing = nullptr;
+        return false;
+    }
+    if (singleMap) {
+        cqRing = sqRing;
+    } else {
+        cqRing = ::mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            cqRing = nullptr;
+            return false;
+        }
+    }
+
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqesMap = ::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ringFd, IORING_OFF_SQES);
+    if (sqesMap == MAP_FAILED)
+        return false;
+    sqes = static_cast<io_uring_sqe *>(sqesMap);
+
+    char *sq = static_cast<char *>(sqRing);
+    sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sqEntries = params.sq_entries;
+
+    char *cq = static_cast<char *>(cqRing);
+    cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqEntries = params.cq_entries;
+
+    eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventFd == -1)
+        return false;
+    if (io_uring_register(ringFd, IORING_REGISTER_EVENTFD, &eventFd, 1) == -1)
+        return false;
+    return true;
+}
+
+void QIORing::ensureNotifier()
+{
+    // The thread may not (yet) have an event dispatcher, in which case
+    // completions are only processed from waitForCompleted().
+    if (notifier || !QAbstractEventDispatcher::instance())
+        return;
+    notifier.reset(new QSocketNotifier(eventFd, QSocketNotifier::Read));
+    QObject::connect(notifier.get(), &QSocketNotifier::activated, notifier.get(), [this] {
+        processCompletions();
+    });
+}
+
+quint64 QIORing::submit(quint8 opcode, int fd, quint64 address, quint32 size, qint64 offset,
+                        Completion completion)
+{
+    // Never have more operations in flight than the completion queue can
+    // hold, the kernel would have to drop (or buffer) completions otherwise.
+    while (quint64(pending.size()) >= cqEntries) {
+        if (!waitForEvents(QDeadlineTimer(QDeadlineTimer::Forever)))
+            return 0;
+        processCompletions();
+    }
+
+    const unsigned tail = *sqTail;
+    if (tail - loadAcquire(sqHead) >= sqEntries) {
+        // cannot happen as we submit every entry immediately
+        errno = EBUSY;
+        return 0;
+    }
+
+    const unsigned index = tail & sqMask;
+    io_uring_sqe *sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->off = quint64(offset);
+    sqe->addr = address;
+    sqe->len = size;
+
+    const quint64 id = nextId++;
+    sqe->user_data = id;
+
+    sqArray[index] = index;
+    storeRelease(sqTail, tail + 1);
+
+    int ret;
+    EINTR_LOOP(ret, io_uring_enter(ringFd, 1, 0, 0));
+    if (ret != 1) {
+        // the kernel did not consume the entry; take it back
+        storeRelease(sqTail, tail);
+        if (ret >= 0)
+            errno = EAGAIN;
+        return 0;
+    }
+
+    pending.insert(id, std::move(completion));
+    ensureNotifier();
+    return id;
+}
+
+/*!
+    \internal
+
+    Starts reading \a size bytes at \a offset from \a fd into \a data.
+    \a completion is called from the thread owning this ring once the
+    operation has finished. \a data must stay valid until then.
+
+    Returns an identifier for the operation, or 0 if it could not be
+    submitted, in which case errno is set.
+*/
+quint64 QIORing::read(int fd, void *data, quint32 size, qint64 offset, Completion completion)
+{
+    return submit(IORING_OP_READ, fd, quintptr(data), size, offset, std::move(completion));
+}
+
+/*!
+    \internal
+
+    Starts writing \a size bytes from \a data to \a fd at \a offset. See
+    read() for the ownership rules.
+*/
+quint64 QIORing::write(int fd, const void *data, quint32 size, qint64 offset, Completion completion)
+{
+    return submit(IORING_OP_WRITE, fd, quintptr(data), size, offset, std::move(completion));
+}
+
+bool QIORing::waitForEvents(QDeadlineTimer deadline)
+{
+    pollfd pfd = qt_make_pollfd(eventFd, POLLIN);
+    timespec ts;
+    const timespec *timeout = nullptr;
+    if (!deadline.isForever()) {
+        const qint64 nsecs = qMax(deadline.remainingTimeNSecs(), Q_INT64_C(0));
+        ts.tv_sec = nsecs / (1000 * 1000 * 1000);
+        ts.tv_nsec = nsecs % (1000 * 1000 * 1000);
+        timeout = &ts;
+    }
+    return qt_safe_poll(&pfd, 1, timeout) > 0;
+}
+
+/*!
+    \internal
+
+    Reaps all available completions and calls their handlers. Returns the
+    number of completed operations.
+*/
+int QIORing::processCompletions()
+{
+    eventfd_t value;
+    eventfd_read(eventFd, &value);
+
+    // Collect first: the handlers may submit new operations
+    QVarLengthArray<QPair<quint64, qint64>, RingEntries> completed;
+    unsigned head = *cqHead;
+    const unsigned tail = loadAcquire(cqTail);
+    for (; head != tail; ++head) {
+        const io_uring_cqe &cqe = cqes[head & cqMask];
+        completed.append(qMakePair(quint64(cqe.user_data), qint64(cqe.res)));
+    }
+    storeRelease(cqHead, head);
+
+    for (const auto &c : qAsConst(completed)) {
+        Completion completion = pending.take(c.first);
+        if (completion)
+            completion(c.second);
+    }
+    return int(completed.size());
+}
+
+/*!
+    \internal
+
+    Processes completions until the operation \a id has finished or
+    \a deadline expires. Returns \c true if the operation is no longer
+    pending.
+*/
+bool QIORing::waitForCompleted(quint64 id, QDeadlineTimer deadline)
+{
+    processCompletions();
+    while (pending.contains(id)) {
+        if (!waitForEvents(deadline))
+            return false;
+        processCompletions();
+    }
+    return true;
+}
+
+QT_END_NAMESPACE
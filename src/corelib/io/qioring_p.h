@@ -0,0 +1,128 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QIORING_P_H
+#define QIORING_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/private/qglobal_p.h>
+#include <QtCore/qdeadlinetimer.h>
+#include <QtCore/qhash.h>
+
+#include <functional>
+#include <memory>
+
+QT_REQUIRE_CONFIG(io_uring);
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+QT_BEGIN_NAMESPACE
+
+class QSocketNotifier;
+
+class Q_CORE_EXPORT QIORing
+{
+    Q_DISABLE_COPY_MOVE(QIORing)
+public:
+    // result is the number of bytes transferred, or -errno on failure
+    using Completion = std::function<void(qint64 result)>;
+
+    ~QIORing();
+
+    static QIORing *threadInstance();
+
+    quint64 read(int fd, void *data, quint32 size, qint64 offset, Completion completion);
+    quint64 write(int fd, const void *data, quint32 size, qint64 offset, Completion completion);
+
+    bool isPending(quint64 id) const { return pending.contains(id); }
+    qsizetype pendingCount() const { return pending.size(); }
+
+    bool waitForCompleted(quint64 id, QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever));
+    int processCompletions();
+
+private:
+    QIORing();
+    bool init(unsigned entries);
+    void ensureNotifier();
+    quint64 submit(quint8 opcode, int fd, quint64 address, quint32 size, qint64 offset,
+                   Completion completion);
+    bool waitForEvents(QDeadlineTimer deadline);
+
+    int ringFd = -1;
+    int eventFd = -1;
+
+    void *sqRing = nullptr;
+    void *cqRing = nullptr;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    io_uring_sqe *sqes = nullptr;
+    size_t sqesSize = 0;
+
+    unsigned *sqHead = nullptr;
+    unsigned *sqTail = nullptr;
+    unsigned *sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+
+    unsigned *cqHead = nullptr;
+    unsigned *cqTail = nullptr;
+    io_uring_cqe *cqes = nullptr;
+    unsigned cqMask = 0;
+    unsigned cqEntries = 0;
+
+    QHash<quint64, Completion> pending;
+    quint64 nextId = 1;
+
+    std::unique_ptr<QSocketNotifier> notifier;
+};
+
+QT_END_NAMESPACE
+
+#endif // QIORING_P_H
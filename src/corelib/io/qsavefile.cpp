@@ -238,6 +238,7 @@ bool QSaveFile::open(OpenMode mode)
         if (d->fileEngine->open(mode | QIODevice::Unbuffered)) {
             d->useTemporaryFile = false;
             QFileDevice::open(mode);
+            d->startAsyncIo();
             return true;
         }
         return false;
@@ -294,6 +295,7 @@ bool QSaveFile::open(OpenMode mode)
     QFileDevice::open(mode);
     if (existingFile.exists())
         setPermissions(existingFile.permissions());
+    d->startAsyncIo();
     return true;
 }
 
@@ -330,6 +332,9 @@ bool QSaveFile::commit()
         qWarning("QSaveFile::commit: File (%ls) is not open", qUtf16Printable(fileName()));
         return false;
     }
+    // asynchronous writes only report their errors once they complete
+    if (isAsynchronous() && !flush())
+        d->writeError = QFileDevice::WriteError;
     QFileDevice::close(); // calls flush()
 
     const auto fe = std::move(d->fileEngine);
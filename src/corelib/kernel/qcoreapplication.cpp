@@ -340,6 +340,8 @@ bool QCoreApplicationPrivate::is_app_closing = false;
 Q_CORE_EXPORT uint qGlobalPostedEventsCount()
 {
     QThreadData *currentThreadData = QThreadData::current();
+    const auto locker = qt_scoped_lock(currentThreadData->postEventList.mutex);
+    currentThreadData->takeIncomingPostedEvents();
     return currentThreadData->postEventList.size() - currentThreadData->postEventList.startOffset;
 }
 
@@ -488,6 +490,7 @@ void QCoreApplicationPrivate::cleanupThreadData()
 
         // need to clear the state of the mainData, just in case a new QCoreApplication comes along.
         const auto locker = qt_scoped_lock(thisThreadData->postEventList.mutex);
+        thisThreadData->takeIncomingPostedEvents();
         for (int i = 0; i < thisThreadData->postEventList.size(); ++i) {
             const QPostEvent &pe = thisThreadData->postEventList.at(i);
             if (pe.event) {
@@ -1035,6 +1038,9 @@ bool QCoreApplication::notifyInternal2(QObject *receiver, QEvent *event)
     QObjectPrivate *d = receiver->d_func();
     QThreadData *threadData = d->threadData;
     QScopedScopeLevelCounter scopeLevelCounter(threadData);
+#if QT_CONFIG(eventstatistics)
+    QEventStatisticsScope statisticsScope(threadData, receiver, event);
+#endif
     if (!selfRequired)
         return doNotify(receiver, event);
     return self->notify(receiver, event);
@@ -1488,6 +1494,51 @@ QCoreApplicationPrivate::QPostEventListLocker QCoreApplicationPrivate::lockThrea
     return locker;
 }
 
+/*!
+    \internal
+
+    Pushes \a event to the lock-free inbox of the thread \a receiver lives in.
+    The events in the inbox are merged into the sorted list of posted events,
+    by \a priority, the next time that list is looked at. Returns \c false if
+    the receiver is being moved to another thread or destroyed, in which case
+    the caller has to take the list's mutex.
+*/
+bool QCoreApplicationPrivate::tryPostEventLockFree(QObject *receiver, QEvent *event, int priority)
+{
+    auto &threadData = QObjectPrivate::get(receiver)->threadData;
+    QThreadData *data = threadData.loadAcquire();
+    if (!data)
+        return false;
+
+    // delete the event on exceptions to protect against memory leaks
+    QScopedPointer<QEvent> eventDeleter(event);
+    auto node = new QPostEventInbox::Node{ {}, QPostEvent(receiver, event, priority) };
+    eventDeleter.take();
+
+    QPostEventList &list = data->postEventList;
+    // moveToThread() blocks the inbox before it moves the posted events, so if
+    // the object still lives in data here, it will until endIncomingPost()
+    if (!list.beginIncomingPost()) {
+        delete node;
+        return false;
+    }
+    if (data != threadData.loadAcquire()) {
+        list.endIncomingPost();
+        delete node;
+        return false;
+    }
+
+    Q_TRACE(QCoreApplication_postEvent_event_posted, receiver, event, event->type());
+    event->m_posted = true;
+    list.incoming.push(node);
+
+    QAbstractEventDispatcher *dispatcher = data->eventDispatcher.loadAcquire();
+    if (dispatcher)
+        dispatcher->wakeUp();
+    list.endIncomingPost();
+    return true;
+}
+
 /*!
     \since 4.3
 
@@ -1523,6 +1574,13 @@ void QCoreApplication::postEvent(QObject *receiver, QEvent *event, int priority)
         return;
     }
 
+    // Queued slot invocations are never compressed, so they don't need to look
+    // at the list and can be handed over without taking its mutex.
+    if (event->type() == QEvent::MetaCall
+        && QCoreApplicationPrivate::tryPostEventLockFree(receiver, event, priority)) {
+        return;
+    }
+
     auto locker = QCoreApplicationPrivate::lockThreadPostEventList(receiver);
     if (!locker.threadData) {
         // posting during destruction? just delete the event to prevent a leak
@@ -1531,6 +1589,7 @@ void QCoreApplication::postEvent(QObject *receiver, QEvent *event, int priority)
     }
 
     QThreadData *data = locker.threadData;
+    data->takeIncomingPostedEvents();
 
     // if this is one of the compressible events, do compression
     if (receiver->d_func()->postedEvents
@@ -1677,6 +1736,7 @@ void QCoreApplicationPrivate::sendPostedEvents(QObject *receiver, int event_type
     ++data->postEventList.recursion;
 
     auto locker = qt_unique_lock(data->postEventList.mutex);
+    data->takeIncomingPostedEvents();
 
     // by default, we assume that the event dispatcher can go to sleep after
     // processing all events. if any new events are posted while we send
@@ -1690,6 +1750,15 @@ void QCoreApplicationPrivate::sendPostedEvents(QObject *receiver, int event_type
 
     data->canWait = true;
 
+#if QT_CONFIG(eventstatistics)
+    QEventStatistics *statistics = nullptr;
+    if (Q_UNLIKELY(QEventStatistics::isEnabled())) {
+        statistics = QEventStatistics::forThread(data);
+        if (!event_type && !receiver)
+            statistics->recordQueueDepth(data->postEventList.size() - data->postEventList.startOffset);
+    }
+#endif
+
     // okay. here is the tricky loop. be careful about optimizing
     // this, it looks the way it does for good reasons.
     int startOffset = data->postEventList.startOffset;
@@ -1784,6 +1853,10 @@ void QCoreApplicationPrivate::sendPostedEvents(QObject *receiver, int event_type
         pe.event->m_posted = false;
         QEvent *e = pe.event;
         QObject * r = pe.receiver;
+#if QT_CONFIG(eventstatistics)
+        if (statistics && pe.postTime)
+            statistics->recordQueueWait(e->type(), QEventStatistics::currentTime() - pe.postTime);
+#endif
 
         --r->d_func()->postedEvents;
         Q_ASSERT(r->d_func()->postedEvents >= 0);
@@ -1831,6 +1904,7 @@ void QCoreApplication::removePostedEvents(QObject *receiver, int eventType)
 {
     auto locker = QCoreApplicationPrivate::lockThreadPostEventList(receiver);
     QThreadData *data = locker.threadData;
+    data->takeIncomingPostedEvents();
 
     // the QObject destructor calls this function directly.  this can
     // happen while the event loop is in the middle of posting events,
@@ -1894,6 +1968,7 @@ void QCoreApplicationPrivate::removePostedEvent(QEvent * event)
     QThreadData *data = QThreadData::current();
 
     const auto locker = qt_scoped_lock(data->postEventList.mutex);
+    data->takeIncomingPostedEvents();
 
     if (data->postEventList.size() == 0) {
 #if defined(QT_DEBUG)
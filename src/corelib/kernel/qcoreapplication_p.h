@@ -156,6 +156,7 @@ public:
         void unlock() { locker.unlock(); }
     };
     static QPostEventListLocker lockThreadPostEventList(QObject *object);
+    static bool tryPostEventLockFree(QObject *receiver, QEvent *event, int priority);
 #endif // QT_NO_QOBJECT
 
     int &argc;
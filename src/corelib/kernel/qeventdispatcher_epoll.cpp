@@ -0,0 +1,579 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qplatformdefs.h"
+
+#include "qcoreapplication.h"
+#include "qsocketnotifier.h"
+#include "qthread.h"
+
+#include "qeventdispatcher_epoll_p.h"
+#include <private/qthread_p.h>
+#include <private/qcoreapplication_p.h>
+#include <private/qcore_unix_p.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <sys/timerfd.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    QEventDispatcherEpoll is a drop-in replacement for QEventDispatcherUNIX on
+    Linux. Instead of building a pollfd array from all socket notifiers on
+    every iteration, the set of watched descriptors lives in the kernel and
+    is only updated when a notifier is registered or unregistered, so the
+    cost of a wakeup is proportional to the number of ready descriptors.
+
+    Timers are still managed by QTimerInfoList; the timeout of the next timer
+    is programmed into a timerfd which is part of the epoll set. The thread
+    pipe (an eventfd where available) is used for wakeUp().
+
+    The dispatcher is selected by setting QT_EVENT_DISPATCHER_EPOLL=1 in the
+    environment, see QThreadPrivate::createEventDispatcher().
+*/
+
+static const char *socketType(QSocketNotifier::Type type)
+{
+    switch (type) {
+    case QSocketNotifier::Read:
+        return "Read";
+    case QSocketNotifier::Write:
+        return "Write";
+    case QSocketNotifier::Exception:
+        return "Exception";
+    }
+
+    Q_UNREACHABLE();
+}
+
+static inline uint32_t toEpollEvents(short events)
+{
+    uint32_t result = 0;
+    if (events & POLLIN)
+        result |= EPOLLIN;
+    if (events & POLLOUT)
+        result |= EPOLLOUT;
+    if (events & POLLPRI)
+        result |= EPOLLPRI;
+    return result;
+}
+
+static inline short toPollEvents(uint32_t events)
+{
+    short result = 0;
+    if (events & EPOLLIN)
+        result |= POLLIN;
+    if (events & EPOLLOUT)
+        result |= POLLOUT;
+    if (events & EPOLLPRI)
+        result |= POLLPRI;
+    if (events & EPOLLHUP)
+        result |= POLLHUP;
+    if (events & EPOLLERR)
+        result |= POLLERR;
+    return result;
+}
+
+static inline bool epollControl(int epollFd, int op, int fd, uint32_t events)
+{
+    epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = fd;
+    return ::epoll_ctl(epollFd, op, fd, &ev) == 0;
+}
+
+QEventDispatcherEpollPrivate::QEventDispatcherEpollPrivate()
+    : epollFd(-1), timerFd(-1), timerFdArmed(false)
+{
+    if (Q_UNLIKELY(threadPipe.init() == false))
+        qFatal("QEventDispatcherEpollPrivate(): Cannot continue without a thread pipe");
+
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (Q_UNLIKELY(epollFd == -1))
+        qFatal("QEventDispatcherEpollPrivate(): Cannot create epoll instance: %s", strerror(errno));
+
+    timerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (Q_UNLIKELY(timerFd == -1))
+        qFatal("QEventDispatcherEpollPrivate(): Cannot create timerfd: %s", strerror(errno));
+
+    if (Q_UNLIKELY(!epollControl(epollFd, EPOLL_CTL_ADD, threadPipe.fds[0], EPOLLIN)
+                   || !epollControl(epollFd, EPOLL_CTL_ADD, timerFd, EPOLLIN))) {
+        qFatal("QEventDispatcherEpollPrivate(): Cannot watch internal descriptors: %s",
+               strerror(errno));
+    }
+}
+
+QEventDispatcherEpollPrivate::~QEventDispatcherEpollPrivate()
+{
+    qt_safe_close(timerFd);
+    qt_safe_close(epollFd);
+
+    // cleanup timers
+    qDeleteAll(timerList);
+}
+
+void QEventDispatcherEpollPrivate::setSocketNotifierPending(QSocketNotifier *notifier)
+{
+    Q_ASSERT(notifier);
+
+    if (pendingNotifiers.contains(notifier))
+        return;
+
+    pendingNotifiers << notifier;
+}
+
+int QEventDispatcherEpollPrivate::activateTimers()
+{
+    return timerList.activateTimers();
+}
+
+/*
+    Brings the kernel interest set for \a fd in line with \a sn_set. \a isNew
+    tells whether \a fd had no notifiers before this change.
+
+    Descriptors that epoll cannot watch (EPERM for regular files and
+    directories, EBADF for invalid descriptors) are moved to
+    fallbackPollfds, so they keep the semantics poll() would give them.
+*/
+void QEventDispatcherEpollPrivate::updateInterest(int fd, const QSocketNotifierSetUNIX &sn_set,
+                                                  bool isNew)
+{
+    const short events = sn_set.events();
+
+    for (qsizetype i = 0; i < fallbackPollfds.size(); ++i) {
+        if (fallbackPollfds.at(i).fd != fd)
+            continue;
+        if (events)
+            fallbackPollfds[i].events = events;
+        else
+            fallbackPollfds.removeAt(i);
+        return;
+    }
+
+    if (!events) {
+        // the descriptor may already have been closed, which removes it
+        // from the epoll set implicitly; there is nothing to report then
+        epollControl(epollFd, EPOLL_CTL_DEL, fd, 0);
+        return;
+    }
+
+    int op = isNew ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    if (epollControl(epollFd, op, fd, toEpollEvents(events)))
+        return;
+
+    // The descriptor was closed and its number reused behind our back
+    // (ENOENT), or it was never removed from the set (EEXIST).
+    if (errno == ENOENT || errno == EEXIST) {
+        op = errno == ENOENT ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+        if (epollControl(epollFd, op, fd, toEpollEvents(events)))
+            return;
+    }
+
+    if (errno == EPERM || errno == EBADF) {
+        fallbackPollfds.append(qt_make_pollfd(fd, events));
+        return;
+    }
+
+    qErrnoWarning("QEventDispatcherEpoll: Cannot watch socket %d", fd);
+}
+
+void QEventDispatcherEpollPrivate::markPendingSocketNotifiers(int fd, short revents)
+{
+    if (revents == 0)
+        return;
+
+    auto it = socketNotifiers.find(fd);
+    if (it == socketNotifiers.end())
+        return;
+
+    const QSocketNotifierSetUNIX &sn_set = it.value();
+
+    static const struct {
+        QSocketNotifier::Type type;
+        short flags;
+    } notifiers[] = {
+        { QSocketNotifier::Read,      POLLIN  | POLLHUP | POLLERR },
+        { QSocketNotifier::Write,     POLLOUT | POLLHUP | POLLERR },
+        { QSocketNotifier::Exception, POLLPRI | POLLHUP | POLLERR }
+    };
+
+    for (const auto &n : notifiers) {
+        QSocketNotifier *notifier = sn_set.notifiers[n.type];
+
+        if (!notifier)
+            continue;
+
+        if (revents & POLLNVAL) {
+            qWarning("QSocketNotifier: Invalid socket %d with type %s, disabling...",
+                     fd, socketType(n.type));
+            notifier->setEnabled(false);
+            continue;
+        }
+
+        if (revents & n.flags)
+            setSocketNotifierPending(notifier);
+    }
+}
+
+int QEventDispatcherEpollPrivate::activateSocketNotifiers()
+{
+    if (pendingNotifiers.isEmpty())
+        return 0;
+
+    int n_activated = 0;
+    QEvent event(QEvent::SockAct);
+
+    while (!pendingNotifiers.isEmpty()) {
+        QSocketNotifier *notifier = pendingNotifiers.takeFirst();
+        QCoreApplication::sendEvent(notifier, &event);
+        ++n_activated;
+    }
+
+    return n_activated;
+}
+
+/*
+    Programs the timerfd to expire after \a timeout, or disarms it if
+    \a timeout is null. A zero timeout is never passed in, as it would
+    disarm the timer; the caller does not block in that case.
+*/
+void QEventDispatcherEpollPrivate::armTimerFd(const timespec *timeout)
+{
+    if (!timeout && !timerFdArmed)
+        return;
+
+    itimerspec spec = {};
+    if (timeout)
+        spec.it_value = *timeout;
+
+    if (Q_UNLIKELY(::timerfd_settime(timerFd, 0, &spec, nullptr) == -1))
+        qErrnoWarning("QEventDispatcherEpoll: Cannot arm timerfd");
+    timerFdArmed = timeout != nullptr;
+}
+
+QEventDispatcherEpoll::QEventDispatcherEpoll(QObject *parent)
+    : QAbstractEventDispatcher(*new QEventDispatcherEpollPrivate, parent)
+{ }
+
+QEventDispatcherEpoll::QEventDispatcherEpoll(QEventDispatcherEpollPrivate &dd, QObject *parent)
+    : QAbstractEventDispatcher(dd, parent)
+{ }
+
+QEventDispatcherEpoll::~QEventDispatcherEpoll()
+{ }
+
+/*!
+    \internal
+*/
+void QEventDispatcherEpoll::registerTimer(int timerId, qint64 interval, Qt::TimerType timerType, QObject *obj)
+{
+#ifndef QT_NO_DEBUG
+    if (timerId < 1 || interval < 0 || !obj) {
+        qWarning("QEventDispatcherEpoll::registerTimer: invalid arguments");
+        return;
+    } else if (obj->thread() != thread() || thread() != QThread::currentThread()) {
+        qWarning("QEventDispatcherEpoll::registerTimer: timers cannot be started from another thread");
+        return;
+    }
+#endif
+
+    Q_D(QEventDispatcherEpoll);
+    d->timerList.registerTimer(timerId, interval, timerType, obj);
+}
+
+/*!
+    \internal
+*/
+bool QEventDispatcherEpoll::unregisterTimer(int timerId)
+{
+#ifndef QT_NO_DEBUG
+    if (timerId < 1) {
+        qWarning("QEventDispatcherEpoll::unregisterTimer: invalid argument");
+        return false;
+    } else if (thread() != QThread::currentThread()) {
+        qWarning("QEventDispatcherEpoll::unregisterTimer: timers cannot be stopped from another thread");
+        return false;
+    }
+#endif
+
+    Q_D(QEventDispatcherEpoll);
+    return d->timerList.unregisterTimer(timerId);
+}
+
+/*!
+    \internal
+*/
+bool QEventDispatcherEpoll::unregisterTimers(QObject *object)
+{
+#ifndef QT_NO_DEBUG
+    if (!object) {
+        qWarning("QEventDispatcherEpoll::unregisterTimers: invalid argument");
+        return false;
+    } else if (object->thread() != thread() || thread() != QThread::currentThread()) {
+        qWarning("QEventDispatcherEpoll::unregisterTimers: timers cannot be stopped from another thread");
+        return false;
+    }
+#endif
+
+    Q_D(QEventDispatcherEpoll);
+    return d->timerList.unregisterTimers(object);
+}
+
+QList<QEventDispatcherEpoll::TimerInfo>
+QEventDispatcherEpoll::registeredTimers(QObject *object) const
+{
+    if (!object) {
+        qWarning("QEventDispatcherEpoll:registeredTimers: invalid argument");
+        return QList<TimerInfo>();
+    }
+
+    Q_D(const QEventDispatcherEpoll);
+    return d->timerList.registeredTimers(object);
+}
+
+void QEventDispatcherEpoll::registerSocketNotifier(QSocketNotifier *notifier)
+{
+    Q_ASSERT(notifier);
+    int sockfd = notifier->socket();
+    QSocketNotifier::Type type = notifier->type();
+#ifndef QT_NO_DEBUG
+    if (notifier->thread() != thread() || thread() != QThread::currentThread()) {
+        qWarning("QSocketNotifier: socket notifiers cannot be enabled from another thread");
+        return;
+    }
+#endif
+
+    Q_D(QEventDispatcherEpoll);
+    const auto existing = d->socketNotifiers.constFind(sockfd);
+    const bool isNew = existing == d->socketNotifiers.cend();
+    QSocketNotifierSetUNIX &sn_set = d->socketNotifiers[sockfd];
+
+    if (sn_set.notifiers[type] && sn_set.notifiers[type] != notifier)
+        qWarning("%s: Multiple socket notifiers for same socket %d and type %s",
+                 Q_FUNC_INFO, sockfd, socketType(type));
+
+    const short oldEvents = sn_set.events();
+    sn_set.notifiers[type] = notifier;
+
+    if (isNew || sn_set.events() != oldEvents)
+        d->updateInterest(sockfd, sn_set, isNew);
+}
+
+void QEventDispatcherEpoll::unregisterSocketNotifier(QSocketNotifier *notifier)
+{
+    Q_ASSERT(notifier);
+    int sockfd = notifier->socket();
+    QSocketNotifier::Type type = notifier->type();
+#ifndef QT_NO_DEBUG
+    if (notifier->thread() != thread() || thread() != QThread::currentThread()) {
+        qWarning("QSocketNotifier: socket notifier (fd %d) cannot be disabled from another thread.\n"
+                "(Notifier's thread is %s(%p), event dispatcher's thread is %s(%p), current thread is %s(%p))",
+                sockfd,
+                notifier->thread() ? notifier->thread()->metaObject()->className() : "QThread", notifier->thread(),
+                thread() ? thread()->metaObject()->className() : "QThread", thread(),
+                QThread::currentThread() ? QThread::currentThread()->metaObject()->className() : "QThread", QThread::currentThread());
+        return;
+    }
+#endif
+
+    Q_D(QEventDispatcherEpoll);
+
+    d->pendingNotifiers.removeOne(notifier);
+
+    auto i = d->socketNotifiers.find(sockfd);
+    if (i == d->socketNotifiers.end())
+        return;
+
+    QSocketNotifierSetUNIX &sn_set = i.value();
+
+    if (sn_set.notifiers[type] == nullptr)
+        return;
+
+    if (sn_set.notifiers[type] != notifier) {
+        qWarning("%s: Multiple socket notifiers for same socket %d and type %s",
+                 Q_FUNC_INFO, sockfd, socketType(type));
+        return;
+    }
+
+    sn_set.notifiers[type] = nullptr;
+    d->updateInterest(sockfd, sn_set, false);
+
+    if (sn_set.isEmpty())
+        d->socketNotifiers.erase(i);
+}
+
+bool QEventDispatcherEpoll::processEvents(QEventLoop::ProcessEventsFlags flags)
+{
+    Q_D(QEventDispatcherEpoll);
+    d->interrupt.storeRelaxed(0);
+
+    // we are awake, broadcast it
+    emit awake();
+
+    auto threadData = d->threadData.loadRelaxed();
+    QCoreApplicationPrivate::sendPostedEvents(nullptr, 0, threadData);
+
+    const bool include_timers = (flags & QEventLoop::X11ExcludeTimers) == 0;
+    const bool include_notifiers = (flags & QEventLoop::ExcludeSocketNotifiers) == 0;
+    const bool wait_for_events = flags & QEventLoop::WaitForMoreEvents;
+
+    const bool canWait = (threadData->canWaitLocked()
+                          && !d->interrupt.loadRelaxed()
+                          && wait_for_events);
+
+    if (canWait)
+        emit aboutToBlock();
+
+    if (d->interrupt.loadRelaxed())
+        return false;
+
+    timespec *tm = nullptr;
+    timespec wait_tm = { 0, 0 };
+
+    if (!canWait || (include_timers && d->timerList.timerWait(wait_tm)))
+        tm = &wait_tm;
+
+    int nevents = 0;
+
+    if (!include_notifiers) {
+        // The epoll set is level-triggered and would keep reporting ready
+        // sockets, so only wait for the thread pipe here, like
+        // QEventDispatcherUNIX does in this case.
+        pollfd pfd = d->threadPipe.prepare();
+        switch (qt_safe_poll(&pfd, 1, tm)) {
+        case -1:
+            perror("qt_safe_poll");
+            break;
+        case 0:
+            break;
+        default:
+            nevents += d->threadPipe.check(pfd);
+            break;
+        }
+
+        if (include_timers)
+            nevents += d->activateTimers();
+
+        return (nevents > 0);
+    }
+
+    if (!d->fallbackPollfds.isEmpty()) {
+        const timespec zero = { 0, 0 };
+        if (qt_safe_poll(d->fallbackPollfds.data(), d->fallbackPollfds.size(), &zero) > 0) {
+            // don't block, some descriptors are ready already
+            wait_tm = zero;
+            tm = &wait_tm;
+        }
+    }
+
+    int timeout = -1;
+    if (tm && tm->tv_sec == 0 && tm->tv_nsec == 0) {
+        timeout = 0;
+    } else {
+        d->armTimerFd(tm);
+    }
+
+    int count;
+    EINTR_LOOP(count, ::epoll_wait(d->epollFd, d->readyEvents,
+                                   QEventDispatcherEpollPrivate::MaxReadyEvents, timeout));
+    if (count == -1)
+        perror("epoll_wait");
+
+    for (int i = 0; i < count; ++i) {
+        const epoll_event &ev = d->readyEvents[i];
+        const int fd = ev.data.fd;
+        if (fd == d->threadPipe.fds[0]) {
+            pollfd pfd = d->threadPipe.prepare();
+            pfd.revents = toPollEvents(ev.events);
+            nevents += d->threadPipe.check(pfd);
+        } else if (fd == d->timerFd) {
+            quint64 expirations;
+            Q_UNUSED(qt_safe_read(d->timerFd, &expirations, sizeof(expirations)));
+            d->timerFdArmed = false;
+        } else {
+            d->markPendingSocketNotifiers(fd, toPollEvents(ev.events));
+        }
+    }
+
+    // iterate over a copy, activation may register or unregister notifiers
+    const QList<pollfd> fallbackPollfds = d->fallbackPollfds;
+    for (const pollfd &pfd : fallbackPollfds)
+        d->markPendingSocketNotifiers(pfd.fd, pfd.revents);
+
+    nevents += d->activateSocketNotifiers();
+
+    if (include_timers)
+        nevents += d->activateTimers();
+
+    // return true if we handled events, false otherwise
+    return (nevents > 0);
+}
+
+int QEventDispatcherEpoll::remainingTime(int timerId)
+{
+#ifndef QT_NO_DEBUG
+    if (timerId < 1) {
+        qWarning("QEventDispatcherEpoll::remainingTime: invalid argument");
+        return -1;
+    }
+#endif
+
+    Q_D(QEventDispatcherEpoll);
+    return d->timerList.timerRemainingTime(timerId);
+}
+
+void QEventDispatcherEpoll::wakeUp()
+{
+    Q_D(QEventDispatcherEpoll);
+    d->threadPipe.wakeUp();
+}
+
+void QEventDispatcherEpoll::interrupt()
+{
+    Q_D(QEventDispatcherEpoll);
+    d->interrupt.storeRelaxed(1);
+    wakeUp();
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qeventdispatcher_epoll_p.cpp"
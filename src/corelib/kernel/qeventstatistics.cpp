@@ -0,0 +1,399 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qeventstatistics_p.h"
+
+#include <qdatastream.h>
+#include <qdeadlinetimer.h>
+#include <qdebug.h>
+#include <qiodevice.h>
+#include <qmetaobject.h>
+#include <qmutex.h>
+
+#include <private/qthread_p.h>
+
+#include <qtcore_tracepoints_p.h>
+
+#include <cmath>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    Event loop statistics are compiled in with the eventstatistics feature
+    and recorded while the qt.core.eventstatistics logging category is
+    enabled for debug output, e.g. with
+    QT_LOGGING_RULES="qt.core.eventstatistics.debug=true".
+
+    Each thread keeps its own QEventStatistics, created the first time it
+    dispatches an event. It records how long each call to notify() takes
+    (including nested event loops and filters), how long posted events wait
+    in the queue, and how many events are pending whenever the thread sends
+    its posted events. The summary of a thread is logged to the category
+    when the thread finishes; logAll() and writeBinary() export the
+    statistics of all running threads at any time.
+*/
+
+Q_LOGGING_CATEGORY(lcEventStatistics, "qt.core.eventstatistics", QtWarningMsg)
+
+namespace {
+struct QEventStatisticsRegistry
+{
+    QMutex mutex;
+    QList<QEventStatistics *> statistics;
+};
+}
+
+Q_GLOBAL_STATIC(QEventStatisticsRegistry, registry)
+
+quint64 QEventLatencyHistogram::count() const noexcept
+{
+    quint64 result = 0;
+    for (const auto &bucket : buckets)
+        result += bucket.loadRelaxed();
+    return result;
+}
+
+/*
+    Returns the upper bound of the bucket containing the value below which
+    \a fraction of the recorded values fall.
+*/
+quint64 QEventLatencyHistogram::percentile(double fraction) const noexcept
+{
+    quint64 values[BucketCount];
+    quint64 total = 0;
+    for (int i = 0; i < BucketCount; ++i)
+        total += values[i] = buckets[i].loadRelaxed();
+    if (!total)
+        return 0;
+
+    const quint64 wanted = qMax<quint64>(1, quint64(std::ceil(fraction * total)));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += values[i];
+        if (seen >= wanted)
+            return bucketUpperBound(i);
+    }
+    return bucketUpperBound(BucketCount - 1);
+}
+
+void QEventDispatchRing::append(const QEventDispatchRecord &record) noexcept
+{
+    const quint64 index = head.loadRelaxed();
+    Entry &entry = entries[index % Size];
+    const quint64 lap = index / Size;
+
+    entry.sequence.storeRelaxed(2 * lap + 1);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.timestamp.storeRelaxed(record.timestamp);
+    entry.duration.storeRelaxed(record.duration);
+    entry.receiverClass.storeRelaxed(record.receiverClass);
+    entry.eventType.storeRelaxed(record.eventType);
+    entry.sequence.storeRelease(2 * lap + 2);
+
+    head.storeRelease(index + 1);
+}
+
+/*
+    Returns the recorded dispatches, oldest first.
+*/
+QList<QEventDispatchRecord> QEventDispatchRing::snapshot() const
+{
+    QList<QEventDispatchRecord> result;
+    const quint64 end = head.loadAcquire();
+    const quint64 begin = end > quint64(Size) ? end - Size : 0;
+    result.reserve(end - begin);
+
+    for (quint64 index = begin; index != end; ++index) {
+        const Entry &entry = entries[index % Size];
+        const quint64 expected = 2 * (index / Size) + 2;
+        if (entry.sequence.loadAcquire() != expected)
+            continue;
+        QEventDispatchRecord record;
+        record.timestamp = entry.timestamp.loadRelaxed();
+        record.duration = entry.duration.loadRelaxed();
+        record.receiverClass = entry.receiverClass.loadRelaxed();
+        record.eventType = entry.eventType.loadRelaxed();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry.sequence.loadRelaxed() != expected)
+            continue;   // overwritten while we were reading it
+        result.append(record);
+    }
+    return result;
+}
+
+QEventStatistics::QEventStatistics(QThreadData *data)
+    : threadId(quint64(quintptr(data->threadId.loadRelaxed())))
+{
+    if (QThread *thread = data->thread.loadAcquire())
+        threadName = thread->objectName();
+}
+
+QEventStatistics::~QEventStatistics()
+    = default;
+
+/*
+    Returns the monotonic time used for all timestamps, in nanoseconds.
+*/
+qint64 QEventStatistics::currentTime() noexcept
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+QEventStatistics *QEventStatistics::forThread(QThreadData *data)
+{
+    if (Q_LIKELY(data->eventStatistics))
+        return data->eventStatistics;
+
+    auto statistics = new QEventStatistics(data);
+    if (QEventStatisticsRegistry *r = registry()) {
+        QMutexLocker locker(&r->mutex);
+        r->statistics.append(statistics);
+    }
+    data->eventStatistics = statistics;
+    return statistics;
+}
+
+QEventStatistics *QEventStatistics::current()
+{
+    return forThread(QThreadData::current());
+}
+
+/*
+    Logs the statistics of the thread. Called by the thread itself when it
+    finishes; QThreadData may be gone by the time it is destroyed.
+*/
+void QEventStatistics::threadFinished(QThreadData *data)
+{
+    if (const QEventStatistics *statistics = data->eventStatistics)
+        statistics->log();
+}
+
+void QEventStatistics::release(QThreadData *data)
+{
+    QEventStatistics *statistics = data->eventStatistics;
+    if (!statistics)
+        return;
+    data->eventStatistics = nullptr;
+
+    if (!registry.isDestroyed()) {
+        QEventStatisticsRegistry *r = registry();
+        QMutexLocker locker(&r->mutex);
+        r->statistics.removeOne(statistics);
+    }
+    delete statistics;
+}
+
+void QEventStatistics::recordDispatch(const QMetaObject *receiverClass, int eventType,
+                                      qint64 start, qint64 end)
+{
+    const qint64 duration = end - start;
+    dispatchTime.record(quint64(duration));
+    recentDispatches.append({ start, duration, receiverClass, eventType });
+
+    ClassEntry *entry = &otherClasses;
+    const uint hash = uint((quintptr(receiverClass) >> 4) * 0x9e3779b9U);
+    for (int probe = 0; probe < ClassTableSize; ++probe) {
+        ClassEntry &candidate = classes[(hash + probe) % ClassTableSize];
+        const QMetaObject *mo = candidate.metaObject.loadRelaxed();
+        if (mo == receiverClass) {
+            entry = &candidate;
+            break;
+        }
+        if (!mo) {
+            candidate.metaObject.storeRelease(receiverClass);
+            entry = &candidate;
+            break;
+        }
+    }
+    entry->count.storeRelaxed(entry->count.loadRelaxed() + 1);
+    entry->nsecs.storeRelaxed(entry->nsecs.loadRelaxed() + duration);
+
+    Q_TRACE(QEventStatistics_dispatch, receiverClass->className(), eventType, duration);
+}
+
+void QEventStatistics::recordQueueWait(int eventType, qint64 nsecs)
+{
+    Q_UNUSED(eventType); // only traced
+    queueWait.record(quint64(qMax<qint64>(0, nsecs)));
+    Q_TRACE(QEventStatistics_queue_wait, eventType, nsecs);
+}
+
+void QEventStatistics::recordQueueDepth(qsizetype depth)
+{
+    queueDepth.record(quint64(depth));
+    Q_TRACE(QEventStatistics_queue_depth, int(depth));
+}
+
+/*
+    Returns the number of events and the time spent in notify() per class
+    of receiver. Events for classes that did not fit in the table are
+    accounted to a null meta object.
+*/
+QList<QEventStatistics::ReceiverClass> QEventStatistics::receiverClasses() const
+{
+    QList<ReceiverClass> result;
+    for (const ClassEntry &entry : classes) {
+        if (const QMetaObject *mo = entry.metaObject.loadAcquire())
+            result.append({ mo, entry.count.loadRelaxed(), entry.nsecs.loadRelaxed() });
+    }
+    if (const quint64 count = otherClasses.count.loadRelaxed())
+        result.append({ nullptr, count, otherClasses.nsecs.loadRelaxed() });
+    return result;
+}
+
+/*
+    Writes the statistics to the qt.core.eventstatistics category.
+*/
+void QEventStatistics::log() const
+{
+    if (lcEventStatistics().isDebugEnabled())
+        QMessageLogger(nullptr, 0, nullptr, lcEventStatistics().categoryName()).debug().noquote() << *this;
+}
+
+void QEventStatistics::logAll()
+{
+    QEventStatisticsRegistry *r = registry();
+    if (!r)
+        return;
+    QMutexLocker locker(&r->mutex);
+    for (const QEventStatistics *statistics : qAsConst(r->statistics))
+        statistics->log();
+}
+
+static void writeHistogram(QDataStream &stream, const QEventLatencyHistogram &histogram)
+{
+    stream << quint32(QEventLatencyHistogram::BucketCount);
+    for (int i = 0; i < QEventLatencyHistogram::BucketCount; ++i)
+        stream << histogram.bucketValue(i);
+    stream << histogram.sum();
+}
+
+static QByteArray className(const QMetaObject *mo)
+{
+    return QByteArray(mo ? mo->className() : "");
+}
+
+/*
+    Writes the statistics of all running threads to \a device, in the
+    following format (QDataStream, version Qt_6_0):
+
+    "QEVS", quint32 version (1), quint32 number of threads, and for each
+    thread: quint64 thread id, QString name, the dispatch time, queue wait
+    and queue depth histograms (quint32 bucket count, quint64 per bucket,
+    quint64 sum), quint32 number of receiver classes followed by (QByteArray
+    class name, quint64 count, quint64 nanoseconds), and quint32 number of
+    recent dispatches followed by (qint64 timestamp, qint64 duration,
+    qint32 event type, QByteArray class name).
+*/
+bool QEventStatistics::writeBinary(QIODevice *device)
+{
+    QDataStream stream(device);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream.writeRawData("QEVS", 4);
+    stream << quint32(1);
+
+    QEventStatisticsRegistry *r = registry();
+    if (!r) {
+        stream << quint32(0);
+        return stream.status() == QDataStream::Ok;
+    }
+
+    QMutexLocker locker(&r->mutex);
+    stream << quint32(r->statistics.size());
+    for (const QEventStatistics *statistics : qAsConst(r->statistics)) {
+        stream << statistics->threadId << statistics->threadName;
+        writeHistogram(stream, statistics->dispatchTime);
+        writeHistogram(stream, statistics->queueWait);
+        writeHistogram(stream, statistics->queueDepth);
+
+        const QList<ReceiverClass> classes = statistics->receiverClasses();
+        stream << quint32(classes.size());
+        for (const ReceiverClass &c : classes)
+            stream << className(c.metaObject) << c.count << c.nsecs;
+
+        const QList<QEventDispatchRecord> records = statistics->recentDispatches.snapshot();
+        stream << quint32(records.size());
+        for (const QEventDispatchRecord &record : records) {
+            stream << record.timestamp << record.duration << qint32(record.eventType)
+                   << className(record.receiverClass);
+        }
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+#ifndef QT_NO_DEBUG_STREAM
+QDebug operator<<(QDebug debug, const QEventLatencyHistogram &histogram)
+{
+    QDebugStateSaver saver(debug);
+    const quint64 count = histogram.count();
+    debug.nospace() << "count " << count;
+    if (count) {
+        debug << ", mean " << histogram.sum() / count
+              << ", p50 <= " << histogram.percentile(0.5)
+              << ", p90 <= " << histogram.percentile(0.9)
+              << ", p99 <= " << histogram.percentile(0.99)
+              << ", max <= " << histogram.percentile(1);
+    }
+    return debug;
+}
+
+QDebug operator<<(QDebug debug, const QEventStatistics &statistics)
+{
+    QDebugStateSaver saver(debug);
+    debug.nospace() << "Event statistics for thread 0x" << Qt::hex << statistics.threadId << Qt::dec;
+    if (!statistics.threadName.isEmpty())
+        debug << " (" << statistics.threadName << ')';
+    debug << "\n  dispatch time (ns): " << statistics.dispatchTime
+          << "\n  queue wait (ns): " << statistics.queueWait
+          << "\n  queue depth: " << statistics.queueDepth;
+
+    QList<QEventStatistics::ReceiverClass> classes = statistics.receiverClasses();
+    std::sort(classes.begin(), classes.end(),
+              [](const QEventStatistics::ReceiverClass &a, const QEventStatistics::ReceiverClass &b) {
+                  return a.nsecs > b.nsecs;
+              });
+    for (const QEventStatistics::ReceiverClass &c : qAsConst(classes)) {
+        debug << "\n  " << (c.metaObject ? c.metaObject->className() : "(other)")
+              << ": " << c.count << " events, " << c.nsecs << " ns";
+    }
+    return debug;
+}
+#endif
+
+QT_END_NAMESPACE
@@ -0,0 +1,223 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QEVENTSTATISTICS_P_H
+#define QEVENTSTATISTICS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/private/qglobal_p.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qcoreevent.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qobject.h>
+
+QT_REQUIRE_CONFIG(eventstatistics);
+
+QT_BEGIN_NAMESPACE
+
+class QDebug;
+class QIODevice;
+class QThreadData;
+
+Q_CORE_EXPORT Q_DECLARE_LOGGING_CATEGORY(lcEventStatistics)
+
+// Histogram with power-of-two buckets: bucket 0 counts zeroes, bucket n
+// counts values in [2^(n-1), 2^n). Only the owning thread records, so the
+// counters are updated without locked instructions; any thread may read.
+class Q_CORE_EXPORT QEventLatencyHistogram
+{
+public:
+    static constexpr int BucketCount = 48;
+
+    void record(quint64 value) noexcept
+    {
+        const int bucket = value ? qMin(64 - int(qCountLeadingZeroBits(value)), BucketCount - 1) : 0;
+        add(buckets[bucket], 1);
+        add(total, value);
+    }
+
+    quint64 bucketValue(int bucket) const noexcept { return buckets[bucket].loadRelaxed(); }
+    static quint64 bucketUpperBound(int bucket) noexcept
+    { return bucket ? (Q_UINT64_C(1) << bucket) - 1 : 0; }
+
+    quint64 count() const noexcept;
+    quint64 sum() const noexcept { return total.loadRelaxed(); }
+    quint64 percentile(double fraction) const noexcept;
+
+private:
+    static void add(QAtomicInteger<quint64> &counter, quint64 value) noexcept
+    { counter.storeRelaxed(counter.loadRelaxed() + value); }
+
+    QAtomicInteger<quint64> buckets[BucketCount] = {};
+    QAtomicInteger<quint64> total = 0;
+};
+
+struct QEventDispatchRecord
+{
+    qint64 timestamp;   // start of the dispatch, see QEventStatistics::currentTime()
+    qint64 duration;    // in nanoseconds
+    const QMetaObject *receiverClass;
+    int eventType;
+};
+Q_DECLARE_TYPEINFO(QEventDispatchRecord, Q_PRIMITIVE_TYPE);
+
+// Single-producer ring buffer of the most recent dispatches. The writer
+// never waits; a reader skips entries that are overwritten while it copies
+// them.
+class Q_CORE_EXPORT QEventDispatchRing
+{
+public:
+    static constexpr int Size = 1024;
+
+    void append(const QEventDispatchRecord &record) noexcept;
+    QList<QEventDispatchRecord> snapshot() const;
+
+private:
+    struct Entry {
+        // 2 * lap + 1 while being written, 2 * lap + 2 once complete
+        QAtomicInteger<quint64> sequence = 0;
+        QAtomicInteger<qint64> timestamp = 0;
+        QAtomicInteger<qint64> duration = 0;
+        QAtomicPointer<const QMetaObject> receiverClass = nullptr;
+        QAtomicInt eventType = 0;
+    };
+
+    Entry entries[Size];
+    QAtomicInteger<quint64> head = 0;
+};
+
+class Q_CORE_EXPORT QEventStatistics
+{
+    Q_DISABLE_COPY_MOVE(QEventStatistics)
+public:
+    struct ReceiverClass {
+        const QMetaObject *metaObject;
+        quint64 count;
+        quint64 nsecs;
+    };
+
+    static bool isEnabled() { return lcEventStatistics().isDebugEnabled(); }
+    static qint64 currentTime() noexcept;
+
+    // must be called from the thread that owns data
+    static QEventStatistics *forThread(QThreadData *data);
+    static QEventStatistics *current();
+    static void threadFinished(QThreadData *data);
+    static void release(QThreadData *data);
+
+    void recordDispatch(const QMetaObject *receiverClass, int eventType, qint64 start, qint64 end);
+    void recordQueueWait(int eventType, qint64 nsecs);
+    void recordQueueDepth(qsizetype depth);
+
+    QList<ReceiverClass> receiverClasses() const;
+
+    void log() const;
+    static void logAll();
+    static bool writeBinary(QIODevice *device);
+
+    QEventLatencyHistogram dispatchTime;    // time spent in notify(), in nanoseconds
+    QEventLatencyHistogram queueWait;       // time posted events spent in the queue
+    QEventLatencyHistogram queueDepth;      // pending events when sending posted events
+    QEventDispatchRing recentDispatches;
+
+private:
+    explicit QEventStatistics(QThreadData *data);
+    ~QEventStatistics();
+
+    // open addressing, only the owning thread inserts
+    static constexpr int ClassTableSize = 256;
+    struct ClassEntry {
+        QAtomicPointer<const QMetaObject> metaObject = nullptr;
+        QAtomicInteger<quint64> count = 0;
+        QAtomicInteger<quint64> nsecs = 0;
+    };
+    ClassEntry classes[ClassTableSize];
+    ClassEntry otherClasses;    // used once the table is full
+
+    quint64 threadId;
+    QString threadName;
+
+    friend QDebug operator<<(QDebug, const QEventStatistics &);
+};
+
+class QEventStatisticsScope
+{
+    Q_DISABLE_COPY_MOVE(QEventStatisticsScope)
+public:
+    QEventStatisticsScope(QThreadData *data, QObject *receiver, QEvent *event)
+    {
+        if (Q_UNLIKELY(QEventStatistics::isEnabled())) {
+            statistics = QEventStatistics::forThread(data);
+            receiverClass = receiver->metaObject();
+            eventType = event->type();
+            start = QEventStatistics::currentTime();
+        }
+    }
+    ~QEventStatisticsScope()
+    {
+        if (Q_UNLIKELY(statistics))
+            statistics->recordDispatch(receiverClass, eventType, start, QEventStatistics::currentTime());
+    }
+
+private:
+    QEventStatistics *statistics = nullptr;
+    const QMetaObject *receiverClass = nullptr;
+    int eventType = 0;
+    qint64 start = 0;
+};
+
+#ifndef QT_NO_DEBUG_STREAM
+Q_CORE_EXPORT QDebug operator<<(QDebug, const QEventLatencyHistogram &);
+Q_CORE_EXPORT QDebug operator<<(QDebug, const QEventStatistics &);
+#endif
+
+QT_END_NAMESPACE
+
+#endif // QEVENTSTATISTICS_P_H
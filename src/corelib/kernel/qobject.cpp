@@ -224,7 +224,7 @@ QObjectPrivate::~QObjectPrivate()
         }
     }
 
-    if (postedEvents)
+    if (postedEvents || !thisThreadData->postEventList.incoming.isEmpty())
         QCoreApplication::removePostedEvents(q_ptr, 0);
 
     thisThreadData->deref();
@@ -325,14 +325,15 @@ void QObjectPrivate::addConnection(int signal, Connection *c)
     cd->resizeSignalVector(signal + 1);
 
     ConnectionList &connectionList = cd->connectionsForSignal(signal);
+    // activate() can pick up c as soon as it is linked in, so set it up completely first
+    c->id = ++cd->currentConnectionId;
+    c->prevConnectionList = connectionList.last.loadRelaxed();
     if (connectionList.last.loadRelaxed()) {
         Q_ASSERT(connectionList.last.loadRelaxed()->receiver.loadRelaxed());
-        connectionList.last.loadRelaxed()->nextConnectionList.storeRelaxed(c);
+        connectionList.last.loadRelaxed()->nextConnectionList.storeRelease(c);
     } else {
-        connectionList.first.storeRelaxed(c);
+        connectionList.first.storeRelease(c);
     }
-    c->id = ++cd->currentConnectionId;
-    c->prevConnectionList = connectionList.last.loadRelaxed();
     connectionList.last.storeRelaxed(c);
 
     QObjectPrivate *rd = QObjectPrivate::get(c->receiver.loadRelaxed());
@@ -349,11 +350,9 @@ void QObjectPrivate::ConnectionData::removeConnection(QObjectPrivate::Connection
 {
     Q_ASSERT(c->receiver.loadRelaxed());
     ConnectionList &connections = signalVector.loadRelaxed()->at(c->signal_index);
+    // c->receiverThreadData is kept alive until c gets reclaimed, as a concurrent
+    // activate() might still be reading it
     c->receiver.storeRelaxed(nullptr);
-    QThreadData *td = c->receiverThreadData.loadRelaxed();
-    if (td)
-        td->deref();
-    c->receiverThreadData.storeRelaxed(nullptr);
 
 #ifndef QT_NO_DEBUG
     bool found = false;
@@ -389,8 +388,7 @@ void QObjectPrivate::ConnectionData::removeConnection(QObjectPrivate::Connection
 
     Q_ASSERT(c != orphaned.loadRelaxed());
     // add c to orphanedConnections
-    c->nextInOrphanList = orphaned.loadRelaxed();
-    orphaned.storeRelaxed(c);
+    addOrphans(c, c);
 
 #ifndef QT_NO_DEBUG
     found = false;
@@ -405,21 +403,44 @@ void QObjectPrivate::ConnectionData::removeConnection(QObjectPrivate::Connection
 
 }
 
-void QObjectPrivate::ConnectionData::cleanOrphanedConnectionsImpl(QObject *sender)
+void QObjectPrivate::ConnectionData::cleanOrphanedConnectionsImpl()
 {
-    ConnectionOrSignalVector *c = nullptr;
-    {
-        QBasicMutexLocker l(signalSlotLock(sender));
-        if (ref.loadAcquire() > 1)
+    for (;;) {
+        ConnectionOrSignalVector *c = orphaned.fetchAndStoreOrdered(nullptr);
+        if (!c)
             return;
 
-        // Since ref == 1, no activate() is in process since we locked the mutex. That implies,
-        // that nothing can reference the orphaned connection objects anymore and they can
-        // be safely deleted
-        c = orphaned.loadRelaxed();
-        orphaned.storeRelaxed(nullptr);
+        // Whatever is on the orphaned list has been unlinked before we took it, so only
+        // an activate() that started earlier can still be traversing it. Every one of
+        // those holds a reference, so with ref == 1 the entries can be safely deleted.
+        if (ref.loadAcquire() == 1) {
+            deleteOrphaned(c);
+            return;
+        }
+
+        // Still in use: put them back for the last running activate() to clean up. If
+        // that one finished in the meantime it might have missed them, so check again.
+        ConnectionOrSignalVector *last = c;
+        while (ConnectionOrSignalVector *next = ConnectionOrSignalVector::untagged(last)->nextInOrphanList)
+            last = next;
+        addOrphans(c, last);
+        if (ref.loadAcquire() > 1)
+            return;
     }
-    deleteOrphaned(c);
+}
+
+/*! \internal
+
+  Defers dropping the reference to \a td until the orphaned list gets reclaimed.
+  Used when a receiver connected to this object moves to another thread, as
+  activate() reads the thread data of receivers without holding any lock.
+*/
+void QObjectPrivate::ConnectionData::derefThreadDataLater(QThreadData *td)
+{
+    OrphanedThreadData *o = new OrphanedThreadData;
+    o->threadData = td;
+    ConnectionOrSignalVector *tagged = ConnectionOrSignalVector::fromOrphanedThreadData(o);
+    addOrphans(tagged, tagged);
 }
 
 void QObjectPrivate::ConnectionData::deleteOrphaned(QObjectPrivate::ConnectionOrSignalVector *o)
@@ -429,11 +450,19 @@ void QObjectPrivate::ConnectionData::deleteOrphaned(QObjectPrivate::ConnectionOr
         if (SignalVector *v = ConnectionOrSignalVector::asSignalVector(o)) {
             next = v->nextInOrphanList;
             free(v);
+        } else if (OrphanedThreadData *t = ConnectionOrSignalVector::asOrphanedThreadData(o)) {
+            next = t->nextInOrphanList;
+            t->threadData->deref();
+            delete t;
         } else {
             QObjectPrivate::Connection *c = static_cast<Connection *>(o);
             next = c->nextInOrphanList;
             Q_ASSERT(!c->receiver.loadRelaxed());
             Q_ASSERT(!c->prev);
+            if (QThreadData *td = c->receiverThreadData.loadRelaxed()) {
+                td->deref();
+                c->receiverThreadData.storeRelaxed(nullptr);
+            }
             c->freeSlotObject();
             c->deref();
         }
@@ -620,6 +649,164 @@ void QMetaCallEvent::placeMetaCall(QObject *object)
     }
 }
 
+/*!
+    \internal
+
+    Creates an empty batch for \a receiver. The caller registers it as the
+    receiver's pending batch and posts it.
+ */
+QMetaCallBatchEvent::QMetaCallBatchEvent(QObject *receiver)
+    : QAbstractMetaCallEvent(nullptr, -1),
+      receiver(receiver),
+      cursor(prealloc_),
+      end(prealloc_ + sizeof(prealloc_))
+{
+}
+
+/*!
+    \internal
+ */
+QMetaCallBatchEvent::~QMetaCallBatchEvent()
+{
+    detach();
+    for (Entry *e = first; e; e = e->next) {
+        for (int i = 0; i < e->nargs; ++i) {
+            if (e->types[i].isValid() && e->args[i])
+                e->types[i].destruct(e->args[i]);
+        }
+        if (e->slotObj)
+            e->slotObj->destroyIfLastRef();
+    }
+    while (blocks) {
+        Block *next = blocks->next;
+        free(blocks);
+        blocks = next;
+    }
+}
+
+/*!
+    \internal
+
+    Makes sure that no further emissions are added to this batch, and waits
+    for the ones being added right now.
+ */
+void QMetaCallBatchEvent::detach()
+{
+    if (detached)
+        return;
+    {
+        QBasicMutexLocker locker(signalSlotLock(receiver));
+        QObjectPrivate::ConnectionData *cd = QObjectPrivate::get(receiver)->connections.loadRelaxed();
+        if (cd && cd->pendingBatch == this)
+            cd->pendingBatch = nullptr;
+    }
+    QMutexLocker locker(&mutex);
+    detached = true;
+}
+
+/*!
+    \internal
+
+    Bump-allocates \a size bytes aligned to \a alignment from the arena. The
+    memory is released when the event is deleted.
+ */
+void *QMetaCallBatchEvent::allocate(size_t size, size_t alignment)
+{
+    auto align = [alignment](char *p) {
+        return reinterpret_cast<char *>((quintptr(p) + alignment - 1) & ~quintptr(alignment - 1));
+    };
+    char *p = align(cursor);
+    if (p + size > end) {
+        const size_t previous = blocks ? blocks->size : sizeof(prealloc_);
+        const size_t blockSize = qMax(previous * 2, sizeof(Block) + size + alignment);
+        Block *block = static_cast<Block *>(malloc(blockSize));
+        Q_CHECK_PTR(block);
+        block->next = blocks;
+        block->size = blockSize;
+        blocks = block;
+        cursor = reinterpret_cast<char *>(block + 1);
+        end = reinterpret_cast<char *>(block) + blockSize;
+        p = align(cursor);
+    }
+    cursor = p + size;
+    return p;
+}
+
+/*!
+    \internal
+
+    Appends an emission through \a c to the batch. Must be called with the
+    receiver's signalSlotLock held, as the connection is read. The arguments
+    are copied with copyArguments(), which doesn't need that lock anymore.
+ */
+QMetaCallBatchEvent::Entry *QMetaCallBatchEvent::addEntry(QObjectPrivate::Connection *c,
+                                                          QObject *sender, int signalId, int nargs)
+{
+    Entry *e = static_cast<Entry *>(allocate(sizeof(Entry), alignof(Entry)));
+    e->next = nullptr;
+    e->slotObj = c->isSlotObject ? c->slotObj : nullptr;
+    if (e->slotObj)
+        e->slotObj->ref();
+    e->callFunction = c->isSlotObject ? nullptr : c->callFunction;
+    e->sender = sender;
+    e->args = nullptr;
+    e->types = nullptr;
+    e->signalId = signalId;
+    e->nargs = 0;
+    e->method_offset = c->isSlotObject ? 0 : c->method_offset;
+    e->method_relative = c->isSlotObject ? ushort(-1) : c->method_relative;
+    if (nargs) {
+        e->args = static_cast<void **>(allocate(nargs * sizeof(void *), alignof(void *)));
+        e->types = static_cast<QMetaType *>(allocate(nargs * sizeof(QMetaType), alignof(QMetaType)));
+        std::fill_n(e->args, nargs, nullptr);
+        std::uninitialized_fill_n(e->types, nargs, QMetaType());
+        e->nargs = nargs;
+    }
+    *last = e;
+    last = &e->next;
+    return e;
+}
+
+/*!
+    \internal
+
+    Copies the arguments of an emission into \a entry; \a argumentTypes are
+    the types of \a argv, not including the return value.
+ */
+void QMetaCallBatchEvent::copyArguments(Entry *entry, const int *argumentTypes, void **argv)
+{
+    for (int n = 1; n < entry->nargs; ++n) {
+        const QMetaType type(argumentTypes[n - 1]);
+        void *storage = allocate(type.sizeOf(), type.alignOf());
+        entry->args[n] = type.construct(storage, argv[n]);
+        entry->types[n] = type;
+    }
+}
+
+/*!
+    \internal
+
+    Invokes the slots of all emissions in the batch, in order. Emissions
+    happening meanwhile go into a new batch.
+ */
+void QMetaCallBatchEvent::placeMetaCall(QObject *object)
+{
+    detach();
+    for (Entry *e = first; e; e = e->next) {
+        QObjectPrivate::Sender currentSender(object, e->sender, e->signalId);
+        if (e->slotObj) {
+            e->slotObj->call(object, e->args);
+        } else if (e->callFunction && e->method_offset <= object->metaObject()->methodOffset()) {
+            e->callFunction(object, QMetaObject::InvokeMetaMethod, e->method_relative, e->args);
+        } else {
+            QMetaObject::metacall(object, QMetaObject::InvokeMetaMethod,
+                                  e->method_offset + e->method_relative, e->args);
+        }
+        if (!currentSender.receiver) // a slot deleted the receiver
+            return;
+    }
+}
+
 /*!
     \class QSignalBlocker
     \brief Exception-safe wrapper around QObject::blockSignals().
@@ -1573,12 +1760,19 @@ void QObject::moveToThread(QThread *targetThread)
     QOrderedMutexLocker locker(&currentData->postEventList.mutex,
                                &targetData->postEventList.mutex);
 
+    // keep lock-free posters out of currentData's inbox until the object
+    // has moved, and merge what they have already posted
+    currentData->postEventList.blockIncomingPosts();
+    currentData->takeIncomingPostedEvents();
+    targetData->takeIncomingPostedEvents();
+
     // keep currentData alive (since we've got it locked)
     currentData->ref();
 
     // move the object
     d_func()->setThreadData_helper(currentData, targetData);
 
+    currentData->postEventList.unblockIncomingPosts();
     locker.unlock();
 
     // now currentData can commit suicide if it wants to
@@ -1635,9 +1829,10 @@ void QObjectPrivate::setThreadData_helper(QThreadData *currentData, QThreadData
                     Q_ASSERT(r == q);
                     targetData->ref();
                     QThreadData *old = c->receiverThreadData.loadRelaxed();
+                    c->receiverThreadData.storeRelease(targetData);
+                    // the sender might be emitting in another thread and still look at old
                     if (old)
-                        old->deref();
-                    c->receiverThreadData.storeRelaxed(targetData);
+                        c->sender->d_func()->connections.loadRelaxed()->derefThreadDataLater(old);
                 }
                 c = c->next;
             }
@@ -3339,6 +3534,8 @@ QObjectPrivate::Connection *QMetaObjectPrivate::connect(const QObject *sender,
 
     const bool isSingleShot = type & Qt::SingleShotConnection;
     type &= ~Qt::SingleShotConnection;
+    const bool isBatched = type & Qt::BatchedConnection;
+    type &= ~Qt::BatchedConnection;
 
     Q_ASSERT(type >= 0);
     Q_ASSERT(type <= 3);
@@ -3357,6 +3554,7 @@ QObjectPrivate::Connection *QMetaObjectPrivate::connect(const QObject *sender,
     c->argumentTypes.storeRelaxed(types);
     c->callFunction = callFunction;
     c->isSingleShot = isSingleShot;
+    c->isBatched = isBatched;
 
     QObjectPrivate::get(s)->addConnection(signal_index, c.get());
 
@@ -3477,7 +3675,7 @@ bool QMetaObjectPrivate::disconnect(const QObject *sender,
 
     locker.unlock();
     if (success) {
-        scd->cleanOrphanedConnections(s);
+        scd->cleanOrphanedConnections();
 
         QMetaMethod smethod = QMetaObjectPrivate::signal(smeta, signal_index);
         if (smethod.isValid())
@@ -3648,18 +3846,45 @@ static void queued_activate(QObject *sender, int signal, QObjectPrivate::Connect
     while (argumentTypes[nargs - 1])
         ++nargs;
 
-    QBasicMutexLocker locker(signalSlotLock(c->receiver.loadRelaxed()));
     QObject *receiver = c->receiver.loadRelaxed();
-    if (!receiver) {
-        // the connection has been disconnected before we got the lock
+    if (!receiver) // already disconnected
+        return;
+
+    // The receiver's lock is only needed to make sure it stays alive while we
+    // post to it. Everything else about c is kept valid by the reference
+    // activate() holds on the sender's connection data.
+    if (c->isBatched) {
+        if (c->isSingleShot && !QObjectPrivate::disconnect(c))
+            return;
+
+        QBasicMutexLocker locker(signalSlotLock(receiver));
+        if (!c->isSingleShot && !c->receiver.loadRelaxed()) {
+            // the connection has been disconnected before we got the lock
+            return;
+        }
+        QObjectPrivate::ConnectionData *cd = QObjectPrivate::get(receiver)->connections.loadRelaxed();
+        if (!cd) // the receiver is being destroyed
+            return;
+        QMetaCallBatchEvent *batch = cd->pendingBatch;
+        if (!batch) {
+            batch = new QMetaCallBatchEvent(receiver);
+            cd->pendingBatch = batch;
+            QCoreApplication::postEvent(receiver, batch);
+        }
+        // the batch can't be delivered or deleted before we're done with it
+        QMutexLocker batchLocker(&batch->mutex);
+        QMetaCallBatchEvent::Entry *entry = batch->addEntry(c, sender, signal, nargs);
+        locker.unlock();
+        batch->copyArguments(entry, argumentTypes, argv);
         return;
     }
-    if (c->isSlotObject)
-        c->slotObj->ref();
-    locker.unlock();
 
+    // Copy the arguments without holding the lock, their copy constructors
+    // might (dis)connect. The slot object gets referenced only once the lock
+    // has shown the connection to be alive, the receiver's destructor releases
+    // it right away.
     QMetaCallEvent *ev = c->isSlotObject ?
-        new QMetaCallEvent(c->slotObj, sender, signal, nargs) :
+        new QMetaCallEvent(static_cast<QtPrivate::QSlotObjectBase *>(nullptr), sender, signal, nargs) :
         new QMetaCallEvent(c->method_offset, c->method_relative, c->callFunction, sender, signal, nargs);
 
     void **args = ev->args();
@@ -3681,15 +3906,15 @@ static void queued_activate(QObject *sender, int signal, QObjectPrivate::Connect
         return;
     }
 
-    locker.relock();
-    if (c->isSlotObject)
-        c->slotObj->destroyIfLastRef();
+    QBasicMutexLocker locker(signalSlotLock(receiver));
     if (!c->isSingleShot && !c->receiver.loadRelaxed()) {
         // the connection has been disconnected while we were unlocked
         locker.unlock();
         delete ev;
         return;
     }
+    if (c->isSlotObject)
+        ev->setSlotObject(c->slotObj);
 
     QCoreApplication::postEvent(receiver, ev);
 }
@@ -3732,8 +3957,10 @@ void doActivate(QObject *sender, int signal_index, void **argv)
     bool senderDeleted = false;
     {
     Q_ASSERT(sp->connections.loadAcquire());
+    // Holding a reference on the connection data keeps everything reachable from it
+    // alive, no lock is needed to walk the connection lists. See ConnectionData.
     QObjectPrivate::ConnectionDataPointer connections(sp->connections.loadRelaxed());
-    QObjectPrivate::SignalVector *signalVector = connections->signalVector.loadRelaxed();
+    QObjectPrivate::SignalVector *signalVector = connections->signalVector.loadAcquire();
 
     const QObjectPrivate::ConnectionList *list;
     if (signal_index < signalVector->count())
@@ -3742,13 +3969,12 @@ void doActivate(QObject *sender, int signal_index, void **argv)
         list = &signalVector->at(-1);
 
     Qt::HANDLE currentThreadId = QThread::currentThreadId();
-    bool inSenderThread = currentThreadId == QObjectPrivate::get(sender)->threadData.loadRelaxed()->threadId.loadRelaxed();
 
     // We need to check against the highest connection id to ensure that signals added
     // during the signal emission are not emitted in this emission.
     uint highestConnectionId = connections->currentConnectionId.loadRelaxed();
     do {
-        QObjectPrivate::Connection *c = list->first.loadRelaxed();
+        QObjectPrivate::Connection *c = list->first.loadAcquire();
         if (!c)
             continue;
 
@@ -3757,18 +3983,10 @@ void doActivate(QObject *sender, int signal_index, void **argv)
             if (!receiver)
                 continue;
 
-            QThreadData *td = c->receiverThreadData.loadRelaxed();
-            if (!td)
-                continue;
-
-            bool receiverInSameThread;
-            if (inSenderThread) {
-                receiverInSameThread = currentThreadId == td->threadId.loadRelaxed();
-            } else {
-                // need to lock before reading the threadId, because moveToThread() could interfere
-                QMutexLocker lock(signalSlotLock(receiver));
-                receiverInSameThread = currentThreadId == td->threadId.loadRelaxed();
-            }
+            // moveToThread() defers releasing the previous thread data, so td stays
+            // valid even if the receiver is being moved concurrently
+            QThreadData *td = c->receiverThreadData.loadAcquire();
+            const bool receiverInSameThread = currentThreadId == td->threadId.loadRelaxed();
 
 
             // determine if this connection should be sent immediately or
@@ -3854,7 +4072,7 @@ void doActivate(QObject *sender, int signal_index, void **argv)
                 if (callbacks_enabled && signal_spy_set->slot_end_callback != nullptr)
                     signal_spy_set->slot_end_callback(receiver, method);
             }
-        } while ((c = c->nextConnectionList.loadRelaxed()) != nullptr && c->id <= highestConnectionId);
+        } while ((c = c->nextConnectionList.loadAcquire()) != nullptr && c->id <= highestConnectionId);
 
     } while (list != &signalVector->at(-1) &&
         //start over for all signals;
@@ -3864,7 +4082,7 @@ void doActivate(QObject *sender, int signal_index, void **argv)
             senderDeleted = true;
     }
     if (!senderDeleted) {
-        sp->connections.loadRelaxed()->cleanOrphanedConnections(sender);
+        sp->connections.loadRelaxed()->cleanOrphanedConnections();
 
         if (callbacks_enabled && signal_spy_set->signal_end_callback != nullptr)
             signal_spy_set->signal_end_callback(sender, signal_index);
@@ -4923,6 +5141,8 @@ QMetaObject::Connection QObjectPrivate::connectImpl(const QObject *sender, int s
 
     const bool isSingleShot = type & Qt::SingleShotConnection;
     type &= ~Qt::SingleShotConnection;
+    const bool isBatched = type & Qt::BatchedConnection;
+    type &= ~Qt::BatchedConnection;
 
     Q_ASSERT(type >= 0);
     Q_ASSERT(type <= 3);
@@ -4942,6 +5162,7 @@ QMetaObject::Connection QObjectPrivate::connectImpl(const QObject *sender, int s
         c->ownArgumentTypes = false;
     }
     c->isSingleShot = isSingleShot;
+    c->isBatched = isBatched;
 
     QObjectPrivate::get(s)->addConnection(signal_index, c.get());
     QMetaObject::Connection ret(c.release());
@@ -5165,7 +5386,7 @@ bool QObjectPrivate::disconnect(QObjectPrivate::Connection *c)
         connections->removeConnection(c);
     }
 
-    connections->cleanOrphanedConnections(c->sender);
+    connections->cleanOrphanedConnections();
 
     c->sender->disconnectNotify(QMetaObjectPrivate::signal(c->sender->metaObject(),
                                                            c->signal_index));
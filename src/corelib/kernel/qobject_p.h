@@ -55,6 +55,7 @@
 #include <QtCore/private/qglobal_p.h>
 #include "QtCore/qcoreevent.h"
 #include "QtCore/qlist.h"
+#include "QtCore/qmutex.h"
 #include "QtCore/qobject.h"
 #include "QtCore/qpointer.h"
 #include "QtCore/qreadwritelock.h"
@@ -67,6 +68,7 @@ QT_BEGIN_NAMESPACE
 class QVariant;
 class QThreadData;
 class QObjectConnectionListVector;
+class QMetaCallBatchEvent;
 namespace QtSharedPointer { struct ExternalRefCountData; }
 
 /* for Qt Test */
@@ -114,6 +116,7 @@ public:
     typedef void (*StaticMetaCallFunction)(QObject *, QMetaObject::Call, int, void **);
     struct Connection;
     struct SignalVector;
+    struct OrphanedThreadData;
 
     struct ConnectionOrSignalVector {
         union {
@@ -123,15 +126,37 @@ public:
             Connection *next;
         };
 
+        // entries of the orphan list are tagged in the low bits of the pointer
+        enum : quintptr { SignalVectorTag = 1, OrphanedThreadDataTag = 2, TagMask = 3 };
+
+        static ConnectionOrSignalVector *untagged(ConnectionOrSignalVector *c)
+        {
+            return reinterpret_cast<ConnectionOrSignalVector *>(reinterpret_cast<quintptr>(c) & ~TagMask);
+        }
         static SignalVector *asSignalVector(ConnectionOrSignalVector *c)
         {
-            if (reinterpret_cast<quintptr>(c) & 1)
-                return reinterpret_cast<SignalVector *>(reinterpret_cast<quintptr>(c) & ~quintptr(1u));
+            if ((reinterpret_cast<quintptr>(c) & TagMask) == SignalVectorTag)
+                return reinterpret_cast<SignalVector *>(reinterpret_cast<quintptr>(c) & ~TagMask);
             return nullptr;
         }
         static Connection *fromSignalVector(SignalVector *v) {
-            return reinterpret_cast<Connection *>(reinterpret_cast<quintptr>(v) | quintptr(1u));
+            return reinterpret_cast<Connection *>(reinterpret_cast<quintptr>(v) | SignalVectorTag);
         }
+        static OrphanedThreadData *asOrphanedThreadData(ConnectionOrSignalVector *c)
+        {
+            if ((reinterpret_cast<quintptr>(c) & TagMask) == OrphanedThreadDataTag)
+                return reinterpret_cast<OrphanedThreadData *>(reinterpret_cast<quintptr>(c) & ~TagMask);
+            return nullptr;
+        }
+        static ConnectionOrSignalVector *fromOrphanedThreadData(OrphanedThreadData *t) {
+            return reinterpret_cast<ConnectionOrSignalVector *>(reinterpret_cast<quintptr>(t) | OrphanedThreadDataTag);
+        }
+    };
+
+    // a reference to the thread data a connection pointed to before its
+    // receiver was moved, which activate() might still be reading
+    struct OrphanedThreadData : public ConnectionOrSignalVector {
+        QThreadData *threadData;
     };
 
     struct Connection : public ConnectionOrSignalVector
@@ -159,7 +184,8 @@ public:
         ushort isSlotObject : 1;
         ushort ownArgumentTypes : 1;
         ushort isSingleShot : 1;
-        Connection() : ref_(2), ownArgumentTypes(true) {
+        ushort isBatched : 1;
+        Connection() : ref_(2), ownArgumentTypes(true), isBatched(false) {
             //ref_ is 2 for the use in the internal lists, and for the use in QMetaObject::Connection
         }
         ~Connection();
@@ -239,7 +265,11 @@ public:
         QMetaObject::indexOfSignal). allsignals contains a list of special connections that will get invoked on
         any signal emission. This is done by connecting to signal index -1.
 
-        This vector is protected by the object mutex (signalSlotLock())
+        This vector is protected by the object mutex (signalSlotLock()) against concurrent
+        modification. activate() reads it without taking any lock: nothing it can reach is
+        freed while it holds a reference on the ConnectionData. Removed connections, replaced
+        signal vectors and stale receiver thread data are pushed onto the orphaned list
+        instead, which is reclaimed once no activation is in progress anymore.
 
         Each Connection is also part of a 'senders' linked list. This one contains all connections connected
         to a slot in this object. The mutex of the receiver must be locked when touching the pointers of this
@@ -253,7 +283,9 @@ public:
         QAtomicPointer<SignalVector> signalVector;
         Connection *senders = nullptr;
         Sender *currentSender = nullptr;   // object currently activating the object
-        QAtomicPointer<Connection> orphaned;
+        QAtomicPointer<ConnectionOrSignalVector> orphaned;
+        // batch of queued emissions not yet delivered to this object, guarded by its signalSlotLock
+        QMetaCallBatchEvent *pendingBatch = nullptr;
 
         ~ConnectionData()
         {
@@ -266,12 +298,22 @@ public:
         // must be called on the senders connection data
         // assumes the senders and receivers lock are held
         void removeConnection(Connection *c);
-        void cleanOrphanedConnections(QObject *sender)
+        void cleanOrphanedConnections()
         {
-            if (orphaned.loadRelaxed() && ref.loadAcquire() == 1)
-                cleanOrphanedConnectionsImpl(sender);
+            if (orphaned.loadAcquire() && ref.loadAcquire() == 1)
+                cleanOrphanedConnectionsImpl();
         }
-        void cleanOrphanedConnectionsImpl(QObject *sender);
+        void cleanOrphanedConnectionsImpl();
+
+        // lock-free, pushes the (tagged) entries first to last onto the orphaned list
+        void addOrphans(ConnectionOrSignalVector *first, ConnectionOrSignalVector *last)
+        {
+            ConnectionOrSignalVector *head = orphaned.loadRelaxed();
+            do {
+                ConnectionOrSignalVector::untagged(last)->nextInOrphanList = head;
+            } while (!orphaned.testAndSetOrdered(head, first, head));
+        }
+        void derefThreadDataLater(QThreadData *td);
 
         ConnectionList &connectionsForSignal(int signal)
         {
@@ -295,10 +337,10 @@ public:
             newVector->next = nullptr;
             newVector->allocated = size;
 
-            signalVector.storeRelaxed(newVector);
+            signalVector.storeRelease(newVector);
             if (vector) {
-                vector->nextInOrphanList = orphaned.loadRelaxed();
-                orphaned.storeRelaxed(ConnectionOrSignalVector::fromSignalVector(vector));
+                ConnectionOrSignalVector *o = ConnectionOrSignalVector::fromSignalVector(vector);
+                addOrphans(o, o);
             }
         }
         int signalVectorCount() const
@@ -559,6 +601,13 @@ public:
     inline void ** args() { return d.args_; }
     inline const QMetaType *types() const { return reinterpret_cast<QMetaType *>(d.args_ + d.nargs_); }
     inline QMetaType *types() { return reinterpret_cast<QMetaType *>(d.args_ + d.nargs_); }
+    // for queued events created with a null slot object
+    inline void setSlotObject(QtPrivate::QSlotObjectBase *slotObj)
+    {
+        Q_ASSERT(!d.slotObj_ && d.method_relative_ == ushort(-1));
+        slotObj->ref();
+        d.slotObj_ = slotObj;
+    }
 
     virtual void placeMetaCall(QObject *object) override;
 
@@ -577,6 +626,58 @@ private:
     alignas(void *) char prealloc_[3 * sizeof(void *) + 3 * sizeof(QMetaType)];
 };
 
+// Collects the emissions of Qt::BatchedConnection connections to a receiver
+// until the next pass of its event loop. The entries and their arguments are
+// allocated from an arena owned by the event.
+class QMetaCallBatchEvent : public QAbstractMetaCallEvent
+{
+public:
+    struct Entry
+    {
+        Entry *next;
+        QtPrivate::QSlotObjectBase *slotObj;
+        QObjectPrivate::StaticMetaCallFunction callFunction;
+        QObject *sender;
+        void **args;
+        QMetaType *types;
+        int signalId;
+        int nargs;
+        ushort method_offset;
+        ushort method_relative;
+    };
+
+    explicit QMetaCallBatchEvent(QObject *receiver);
+    ~QMetaCallBatchEvent() override;
+
+    // both require mutex to be locked
+    Entry *addEntry(QObjectPrivate::Connection *c, QObject *sender, int signalId, int nargs);
+    void copyArguments(Entry *entry, const int *argumentTypes, void **argv);
+
+    void placeMetaCall(QObject *object) override;
+
+    // held while an emission is being added
+    QMutex mutex;
+
+private:
+    void detach();
+    void *allocate(size_t size, size_t alignment);
+
+    struct Block
+    {
+        Block *next;
+        size_t size;
+    };
+
+    QObject *receiver;
+    Entry *first = nullptr;
+    Entry **last = &first;
+    Block *blocks = nullptr;
+    char *cursor;
+    char *end;
+    bool detached = false;
+    alignas(std::max_align_t) char prealloc_[512];
+};
+
 class QBoolBlocker
 {
     Q_DISABLE_COPY_MOVE(QBoolBlocker)
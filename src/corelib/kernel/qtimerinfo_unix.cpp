@@ -53,6 +53,9 @@
 
 #include <sys/times.h>
 
+#include <algorithm>
+#include <limits>
+
 QT_BEGIN_NAMESPACE
 
 Q_CORE_EXPORT bool qt_disable_lowpriority_timers=false;
@@ -62,6 +65,16 @@ Q_CORE_EXPORT bool qt_disable_lowpriority_timers=false;
  * timerBitVec array is used for keeping track of timer identifiers.
  */
 
+static inline qint64 timespecToMsecs(const timespec &ts)
+{
+    return qint64(ts.tv_sec) * 1000 + ts.tv_nsec / (1000 * 1000);
+}
+
+static inline quint64 rotateRight(quint64 v, uint n)
+{
+    return n ? (v >> n) | (v << (64 - n)) : v;
+}
+
 QTimerInfoList::QTimerInfoList()
 {
 #if (_POSIX_MONOTONIC_CLOCK-0 <= 0) && !defined(Q_OS_MAC)
@@ -84,6 +97,8 @@ QTimerInfoList::QTimerInfoList()
 #endif
 
     firstTimerInfo = nullptr;
+    updateCurrentTime();
+    resetWheel();
 }
 
 timespec QTimerInfoList::updateCurrentTime()
@@ -146,10 +161,12 @@ bool QTimerInfoList::timeChanged(timespec *delta)
 */
 void QTimerInfoList::timerRepair(const timespec &diff)
 {
-    // repair all timers
-    for (int i = 0; i < size(); ++i) {
-        QTimerInfo *t = at(i);
+    // repair all timers and sort them into a wheel starting at the new time
+    const QList<QTimerInfo *> timers = timersById.values();
+    resetWheel();
+    for (QTimerInfo *t : timers) {
         t->timeout = t->timeout + diff;
+        timerInsert(t);
     }
 }
 
@@ -171,17 +188,223 @@ void QTimerInfoList::repairTimersIfNeeded()
 #endif
 
 /*
-  insert timer info into list
+  empty the wheel and the list of due timers, and restart the wheel at the
+  current time
+*/
+void QTimerInfoList::resetWheel()
+{
+    std::fill(std::begin(wheel), std::end(wheel), nullptr);
+    std::fill(std::begin(occupiedSlots), std::end(occupiedSlots), 0);
+    dueTimers.clear();
+    wheelTime = timespecToMsecs(currentTime);
+}
+
+/*
+  insert timer info into the wheel, or into the list of due timers if the
+  wheel has already passed its timeout
 */
 void QTimerInfoList::timerInsert(QTimerInfo *ti)
 {
-    int index = size();
+    if (timespecToMsecs(ti->timeout) > wheelTime) {
+        wheelInsert(ti);
+        return;
+    }
+
+    ti->slot = -1;
+    qsizetype index = dueTimers.size();
     while (index--) {
-        const QTimerInfo * const t = at(index);
+        const QTimerInfo * const t = dueTimers.at(index);
         if (!(ti->timeout < t->timeout))
             break;
     }
-    insert(index+1, ti);
+    dueTimers.insert(index + 1, ti);
+}
+
+/*
+  remove timer info from whichever structure holds it
+*/
+void QTimerInfoList::timerRemove(QTimerInfo *t)
+{
+    if (t->slot < 0)
+        dueTimers.removeOne(t);
+    else
+        wheelRemove(t);
+}
+
+/*
+  insert timer info into the lowest level of the wheel whose range covers
+  the timeout; the timeout must be after wheelTime
+*/
+void QTimerInfoList::wheelInsert(QTimerInfo *t)
+{
+    const qint64 expiry = timespecToMsecs(t->timeout);
+    Q_ASSERT(expiry > wheelTime);
+
+    int level = 0;
+    qint64 index;
+    for (;;) {
+        const int shift = level * WheelBits;
+        index = expiry >> shift;
+        if (index - (wheelTime >> shift) < WheelSize)
+            break;
+        if (level == WheelLevels - 1) {
+            // too far in the future: park it in the last slot of the top
+            // level, it will be re-inserted when the wheel gets there
+            index = (wheelTime >> shift) + WheelSize - 1;
+            break;
+        }
+        ++level;
+    }
+
+    const int bit = int(index & (WheelSize - 1));
+    t->slot = level * WheelSize + bit;
+    QTimerInfo *&head = wheel[t->slot];
+    if (head) {
+        // append, so that timers with the same timeout fire in order
+        t->next = head;
+        t->prev = head->prev;
+        head->prev->next = t;
+        head->prev = t;
+    } else {
+        t->next = t->prev = t;
+        head = t;
+        occupiedSlots[level] |= Q_UINT64_C(1) << bit;
+    }
+}
+
+void QTimerInfoList::wheelRemove(QTimerInfo *t)
+{
+    Q_ASSERT(t->slot >= 0);
+    QTimerInfo *&head = wheel[t->slot];
+    if (t->next == t) {
+        head = nullptr;
+        occupiedSlots[t->slot / WheelSize] &= ~(Q_UINT64_C(1) << (t->slot % WheelSize));
+    } else {
+        t->prev->next = t->next;
+        t->next->prev = t->prev;
+        if (head == t)
+            head = t->next;
+    }
+    t->slot = -1;
+}
+
+/*
+  Returns the time in milliseconds when the wheel needs to do some work: a
+  level 0 slot is due at its timeout, a slot of a higher level when the
+  wheel reaches its start and the timers have to be moved a level down.
+*/
+qint64 QTimerInfoList::nextWheelEvent() const
+{
+    qint64 next = std::numeric_limits<qint64>::max();
+    for (int level = 0; level < WheelLevels; ++level) {
+        if (!occupiedSlots[level])
+            continue;
+        const int shift = level * WheelBits;
+        const qint64 current = wheelTime >> shift;
+        const uint distance = qCountTrailingZeroBits(rotateRight(occupiedSlots[level],
+                                                                 uint(current & (WheelSize - 1))));
+        Q_ASSERT(distance > 0);
+        next = qMin(next, (current + distance) << shift);
+    }
+    return next;
+}
+
+/*
+  Moves the wheel forward to \a time, cascading the timers of each slot
+  that is reached and moving those that expire into the list of due timers.
+*/
+void QTimerInfoList::advanceWheel(qint64 time)
+{
+    QList<QTimerInfo *> expired;
+    while (time > wheelTime) {
+        const qint64 next = nextWheelEvent();
+        if (next > time) {
+            wheelTime = time;
+            break;
+        }
+        wheelTime = next;
+
+        // higher levels first, their timers may be due now as well
+        for (int level = WheelLevels - 1; level >= 0; --level) {
+            const int bit = int((wheelTime >> (level * WheelBits)) & (WheelSize - 1));
+            QTimerInfo *t = wheel[level * WheelSize + bit];
+            if (!t)
+                continue;
+            wheel[level * WheelSize + bit] = nullptr;
+            occupiedSlots[level] &= ~(Q_UINT64_C(1) << bit);
+
+            t->prev->next = nullptr;
+            while (t) {
+                QTimerInfo *following = t->next;
+                if (timespecToMsecs(t->timeout) > wheelTime) {
+                    wheelInsert(t);
+                } else {
+                    t->slot = -1;
+                    expired.append(t);
+                }
+                t = following;
+            }
+        }
+
+        // everything that expired now is later than what was already due
+        if (!expired.isEmpty()) {
+            std::stable_sort(expired.begin(), expired.end(),
+                             [](const QTimerInfo *a, const QTimerInfo *b) {
+                                 return a->timeout < b->timeout;
+                             });
+            dueTimers.append(expired);
+            expired.clear();
+        }
+    }
+}
+
+/*
+  Returns the earliest timer in the wheel that is not being activated, or
+  null if there is none. All timers of a slot expire before those of the
+  following slots of the same level, so only the first slot with such a
+  timer needs to be looked at in each level.
+*/
+QTimerInfo *QTimerInfoList::earliestWheelTimer()
+{
+    QTimerInfo *earliest = nullptr;
+    for (int level = 0; level < WheelLevels; ++level) {
+        const int shift = level * WheelBits;
+        const qint64 current = wheelTime >> shift;
+        const uint currentBit = uint(current & (WheelSize - 1));
+        quint64 pending = rotateRight(occupiedSlots[level], currentBit);
+        while (pending) {
+            const uint distance = qCountTrailingZeroBits(pending);
+            if (earliest && timespecToMsecs(earliest->timeout) < ((current + distance) << shift))
+                break;
+
+            QTimerInfo *first = nullptr;
+            QTimerInfo * const head = wheel[level * WheelSize + ((currentBit + distance) & (WheelSize - 1))];
+            QTimerInfo *t = head;
+            do {
+                if (!t->activateRef && (!first || t->timeout < first->timeout))
+                    first = t;
+                t = t->next;
+            } while (t != head);
+
+            if (first) {
+                if (!earliest || first->timeout < earliest->timeout)
+                    earliest = first;
+                break;
+            }
+            pending &= pending - 1;
+        }
+    }
+    return earliest;
+}
+
+/*
+  Returns \c true if a timer has expired and activateTimers() has work to do.
+*/
+bool QTimerInfoList::hasExpiredTimers()
+{
+    updateCurrentTime();
+    advanceWheel(timespecToMsecs(currentTime));
+    return !dueTimers.isEmpty() && !(currentTime < dueTimers.constFirst()->timeout);
 }
 
 inline timespec &operator+=(timespec &t1, int ms)
@@ -383,15 +606,18 @@ bool QTimerInfoList::timerWait(timespec &tm)
 {
     timespec currentTime = updateCurrentTime();
     repairTimersIfNeeded();
+    advanceWheel(timespecToMsecs(currentTime));
 
     // Find first waiting timer not already active
     QTimerInfo *t = nullptr;
-    for (QTimerInfoList::const_iterator it = constBegin(); it != constEnd(); ++it) {
-        if (!(*it)->activateRef) {
-            t = *it;
+    for (QTimerInfo *due : qAsConst(dueTimers)) {
+        if (!due->activateRef) {
+            t = due;
             break;
         }
     }
+    if (!t)
+        t = earliestWheelTimer();
 
     if (!t)
       return false;
@@ -419,16 +645,13 @@ int QTimerInfoList::timerRemainingTime(int timerId)
     repairTimersIfNeeded();
     timespec tm = {0, 0};
 
-    for (int i = 0; i < count(); ++i) {
-        QTimerInfo *t = at(i);
-        if (t->id == timerId) {
-            if (currentTime < t->timeout) {
-                // time to wait
-                tm = roundToMillisecond(t->timeout - currentTime);
-                return tm.tv_sec*1000 + tm.tv_nsec/1000/1000;
-            } else {
-                return 0;
-            }
+    if (const QTimerInfo *t = timersById.value(timerId)) {
+        if (currentTime < t->timeout) {
+            // time to wait
+            tm = roundToMillisecond(t->timeout - currentTime);
+            return tm.tv_sec*1000 + tm.tv_nsec/1000/1000;
+        } else {
+            return 0;
         }
     }
 
@@ -489,6 +712,8 @@ void QTimerInfoList::registerTimer(int timerId, qint64 interval, Qt::TimerType t
             ++t->timeout.tv_sec;
     }
 
+    timersById.insert(timerId, t);
+    timersByObject.insert(object, t);
     timerInsert(t);
 
 #ifdef QTIMERINFO_DEBUG
@@ -504,40 +729,36 @@ void QTimerInfoList::registerTimer(int timerId, qint64 interval, Qt::TimerType t
 bool QTimerInfoList::unregisterTimer(int timerId)
 {
     // set timer inactive
-    for (int i = 0; i < count(); ++i) {
-        QTimerInfo *t = at(i);
-        if (t->id == timerId) {
-            // found it
-            removeAt(i);
-            if (t == firstTimerInfo)
-                firstTimerInfo = nullptr;
-            if (t->activateRef)
-                *(t->activateRef) = nullptr;
-            delete t;
-            return true;
-        }
+    QTimerInfo *t = timersById.take(timerId);
+    if (!t) {
+        // id not found
+        return false;
     }
-    // id not found
-    return false;
+
+    timersByObject.remove(t->obj, t);
+    timerRemove(t);
+    if (t == firstTimerInfo)
+        firstTimerInfo = nullptr;
+    if (t->activateRef)
+        *(t->activateRef) = nullptr;
+    delete t;
+    return true;
 }
 
 bool QTimerInfoList::unregisterTimers(QObject *object)
 {
     if (isEmpty())
         return false;
-    for (int i = 0; i < count(); ++i) {
-        QTimerInfo *t = at(i);
-        if (t->obj == object) {
-            // object found
-            removeAt(i);
-            if (t == firstTimerInfo)
-                firstTimerInfo = nullptr;
-            if (t->activateRef)
-                *(t->activateRef) = nullptr;
-            delete t;
-            // move back one so that we don't skip the new current item
-            --i;
-        }
+    const QList<QTimerInfo *> timers = timersByObject.values(object);
+    timersByObject.remove(object);
+    for (QTimerInfo *t : timers) {
+        timersById.remove(t->id);
+        timerRemove(t);
+        if (t == firstTimerInfo)
+            firstTimerInfo = nullptr;
+        if (t->activateRef)
+            *(t->activateRef) = nullptr;
+        delete t;
     }
     return true;
 }
@@ -545,15 +766,14 @@ bool QTimerInfoList::unregisterTimers(QObject *object)
 QList<QAbstractEventDispatcher::TimerInfo> QTimerInfoList::registeredTimers(QObject *object) const
 {
     QList<QAbstractEventDispatcher::TimerInfo> list;
-    for (int i = 0; i < count(); ++i) {
-        const QTimerInfo * const t = at(i);
-        if (t->obj == object) {
-            list << QAbstractEventDispatcher::TimerInfo(t->id,
-                                                        (t->timerType == Qt::VeryCoarseTimer
-                                                         ? t->interval * 1000
-                                                         : t->interval),
-                                                        t->timerType);
-        }
+    const auto range = timersByObject.equal_range(object);
+    for (auto it = range.first; it != range.second; ++it) {
+        const QTimerInfo * const t = *it;
+        list << QAbstractEventDispatcher::TimerInfo(t->id,
+                                                    (t->timerType == Qt::VeryCoarseTimer
+                                                     ? t->interval * 1000
+                                                     : t->interval),
+                                                    t->timerType);
     }
     return list;
 }
@@ -572,21 +792,21 @@ int QTimerInfoList::activateTimers()
     timespec currentTime = updateCurrentTime();
     // qDebug() << "Thread" << QThread::currentThreadId() << "woken up at" << currentTime;
     repairTimersIfNeeded();
-
+    advanceWheel(timespecToMsecs(currentTime));
 
     // Find out how many timer have expired
-    for (QTimerInfoList::const_iterator it = constBegin(); it != constEnd(); ++it) {
-        if (currentTime < (*it)->timeout)
+    for (const QTimerInfo *t : qAsConst(dueTimers)) {
+        if (currentTime < t->timeout)
             break;
         maxCount++;
     }
 
     //fire the timers.
     while (maxCount--) {
-        if (isEmpty())
+        if (dueTimers.isEmpty())
             break;
 
-        QTimerInfo *currentTimerInfo = constFirst();
+        QTimerInfo *currentTimerInfo = dueTimers.constFirst();
         if (currentTime < currentTimerInfo->timeout)
             break; // no timer has expired
 
@@ -601,7 +821,7 @@ int QTimerInfoList::activateTimers()
         }
 
         // remove from list
-        removeFirst();
+        dueTimers.removeFirst();
 
 #ifdef QTIMERINFO_DEBUG
         float diff;
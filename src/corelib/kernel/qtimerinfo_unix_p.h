@@ -56,6 +56,7 @@
 // #define QTIMERINFO_DEBUG
 
 #include "qabstracteventdispatcher.h"
+#include "qhash.h"
 
 #include <sys/time.h> // struct timeval
 
@@ -70,6 +71,11 @@ struct QTimerInfo {
     QObject *obj;     // - object to receive event
     QTimerInfo **activateRef; // - ref from activateTimers
 
+    // links in the timer wheel slot, or -1 if in the list of due timers
+    QTimerInfo *next;
+    QTimerInfo *prev;
+    int slot;
+
 #ifdef QTIMERINFO_DEBUG
     timeval expected; // when timer is expected to fire
     float cumulativeError;
@@ -77,7 +83,7 @@ struct QTimerInfo {
 #endif
 };
 
-class Q_CORE_EXPORT QTimerInfoList : public QList<QTimerInfo*>
+class Q_CORE_EXPORT QTimerInfoList
 {
 #if ((_POSIX_MONOTONIC_CLOCK-0 <= 0) && !defined(Q_OS_MAC)) || defined(QT_BOOTSTRAPPED)
     timespec previousTime;
@@ -92,6 +98,33 @@ class Q_CORE_EXPORT QTimerInfoList : public QList<QTimerInfo*>
     // state variables used by activateTimers()
     QTimerInfo *firstTimerInfo;
 
+    // Hierarchical timing wheel: level N has WheelSize slots of
+    // WheelSize^N milliseconds each. A timer is kept in the lowest level
+    // whose range covers its timeout, and moves down a level ("cascades")
+    // when the wheel reaches the start of its slot.
+    enum {
+        WheelBits = 6,
+        WheelSize = 1 << WheelBits,
+        WheelLevels = 7
+    };
+    QTimerInfo *wheel[WheelLevels * WheelSize];
+    quint64 occupiedSlots[WheelLevels];
+    // in milliseconds; all timers expiring up to then are in dueTimers
+    qint64 wheelTime;
+    // timers expiring at or before wheelTime, sorted by timeout
+    QList<QTimerInfo *> dueTimers;
+
+    QHash<int, QTimerInfo *> timersById;
+    QMultiHash<QObject *, QTimerInfo *> timersByObject;
+
+    void wheelInsert(QTimerInfo *t);
+    void wheelRemove(QTimerInfo *t);
+    qint64 nextWheelEvent() const;
+    void advanceWheel(qint64 time);
+    void resetWheel();
+    QTimerInfo *earliestWheelTimer();
+    void timerRemove(QTimerInfo *t);
+
 public:
     QTimerInfoList();
 
@@ -103,6 +136,7 @@ public:
 
     bool timerWait(timespec &);
     void timerInsert(QTimerInfo *);
+    bool hasExpiredTimers();
 
     int timerRemainingTime(int timerId);
 
@@ -112,6 +146,14 @@ public:
     QList<QAbstractEventDispatcher::TimerInfo> registeredTimers(QObject *object) const;
 
     int activateTimers();
+
+    bool isEmpty() const { return timersById.isEmpty(); }
+    qsizetype size() const { return timersById.size(); }
+
+    // iterates over all registered timers, in no particular order
+    using const_iterator = QHash<int, QTimerInfo *>::const_iterator;
+    const_iterator begin() const { return timersById.cbegin(); }
+    const_iterator end() const { return timersById.cend(); }
 };
 
 QT_END_NAMESPACE
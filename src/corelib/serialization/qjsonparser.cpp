@@ -47,6 +47,8 @@
 #include "private/qstringconverter_p.h"
 #include "private/qcborvalue_p.h"
 #include "private/qnumeric_p.h"
+#include "private/qsimd_p.h"
+#include <qalgorithms.h>
 
 //#define PARSER_DEBUG
 #ifdef PARSER_DEBUG
@@ -329,9 +331,25 @@ QCborValue Parser::parse(QJsonParseError *error)
     qDebug(">>>>> parser begin");
 #endif
     eatBOM();
-    char token = nextToken();
 
     QCborValue data;
+    const char *start = json;
+    if (parseIndexed(&data)) {
+        if (error) {
+            error->offset = 0;
+            error->error = QJsonParseError::NoError;
+        }
+        return data;
+    }
+
+    // The indexed parser does not track errors. Start over with the
+    // byte-by-byte parser, which reports the error and its offset.
+    container.reset();
+    nestingLevel = 0;
+    lastError = QJsonParseError::NoError;
+    json = start;
+
+    char token = nextToken();
 
     DEBUG << Qt::hex << (uint)token;
     if (token == BeginArray) {
@@ -713,6 +731,19 @@ bool Parser::parseNumber()
         return false;
     }
 
+    // Short integers without fraction or exponent are converted directly,
+    // they cannot overflow: 18 digits are less than 2^63.
+    const char *digits = start + (*start == '-');
+    if (json > digits && json - digits <= 18
+            && std::all_of(digits, json, [](char c) { return c >= '0' && c <= '9'; })) {
+        qint64 n = 0;
+        for (const char *p = digits; p < json; ++p)
+            n = n * 10 + (*p - '0');
+        container->append(QCborValue(digits == start ? n : -n));
+        END;
+        return true;
+    }
+
     const QByteArray number = QByteArray::fromRawData(start, json - start);
     DEBUG << "numberstring" << number;
 
@@ -919,4 +950,350 @@ bool Parser::parseString()
     return true;
 }
 
+/*
+    Indexed parsing
+
+    The functions below parse the same grammar as the ones above, but
+    instead of looking at every byte of the input they walk a structural
+    index: the positions of all quotes that delimit strings, of the six
+    structural characters outside of strings and of the first byte of every
+    other run of non-whitespace outside of strings (literals and numbers).
+    The index is built 64 bytes at a time, in chunks, so it never needs more
+    than a few kilobytes of memory.
+
+    Strings, literals and numbers are still decoded by the functions above;
+    the index only lets us skip whitespace and find the end of strings
+    without a byte-by-byte loop. The result is the same as what the
+    byte-by-byte parser produces. On any error the indexed parser simply
+    gives up and parse() starts over with the byte-by-byte parser, which
+    then reports the error.
+*/
+
+namespace {
+enum { IndexChunkSize = 16384 };
+
+struct BlockMasks
+{
+    quint64 quote;
+    quint64 backslash;
+    quint64 whitespace;
+    quint64 structural;
+};
+}
+
+static inline BlockMasks classifyBlock(const char *p)
+{
+    BlockMasks m = {};
+#ifdef __SSE2__
+    const __m128i quote = _mm_set1_epi8(Quote);
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(Space);
+    const __m128i tab = _mm_set1_epi8(Tab);
+    const __m128i lineFeed = _mm_set1_epi8(LineFeed);
+    const __m128i ret = _mm_set1_epi8(Return);
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i beginObject = _mm_set1_epi8(BeginObject);    // also '[' with the 0x20 bit set
+    const __m128i endObject = _mm_set1_epi8(EndObject);        // also ']' with the 0x20 bit set
+    const __m128i nameSeparator = _mm_set1_epi8(NameSeparator);
+    const __m128i valueSeparator = _mm_set1_epi8(ValueSeparator);
+
+    for (int i = 0; i < 64; i += 16) {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        const __m128i folded = _mm_or_si128(data, caseBit);
+        __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(data, space), _mm_cmpeq_epi8(data, tab));
+        ws = _mm_or_si128(ws, _mm_cmpeq_epi8(data, lineFeed));
+        ws = _mm_or_si128(ws, _mm_cmpeq_epi8(data, ret));
+        __m128i op = _mm_or_si128(_mm_cmpeq_epi8(folded, beginObject),
+                                  _mm_cmpeq_epi8(folded, endObject));
+        op = _mm_or_si128(op, _mm_cmpeq_epi8(data, nameSeparator));
+        op = _mm_or_si128(op, _mm_cmpeq_epi8(data, valueSeparator));
+
+        m.quote |= quint64(quint16(_mm_movemask_epi8(_mm_cmpeq_epi8(data, quote)))) << i;
+        m.backslash |= quint64(quint16(_mm_movemask_epi8(_mm_cmpeq_epi8(data, backslash)))) << i;
+        m.whitespace |= quint64(quint16(_mm_movemask_epi8(ws))) << i;
+        m.structural |= quint64(quint16(_mm_movemask_epi8(op))) << i;
+    }
+#else
+    for (int i = 0; i < 64; ++i) {
+        const quint64 bit = Q_UINT64_C(1) << i;
+        switch (p[i]) {
+        case Quote:
+            m.quote |= bit;
+            break;
+        case '\\':
+            m.backslash |= bit;
+            break;
+        case Space:
+        case Tab:
+        case LineFeed:
+        case Return:
+            m.whitespace |= bit;
+            break;
+        case BeginArray:
+        case BeginObject:
+        case EndArray:
+        case EndObject:
+        case NameSeparator:
+        case ValueSeparator:
+            m.structural |= bit;
+            break;
+        }
+    }
+#endif
+    return m;
+}
+
+// Sets every bit from an odd-numbered set bit of \a x up to, but not
+// including, the next one: the inside of the strings, given their quotes.
+static inline quint64 prefixXor(quint64 x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+bool Parser::fillIndex()
+{
+    if (!index)
+        index.reset(new quint32[qMin<qsizetype>(IndexChunkSize, end - head + 64)]);
+
+    quint32 *out = index.get();
+    while (out == index.get() && indexed < end) {
+        const char *chunkEnd = indexed + qMin<qsizetype>(IndexChunkSize, end - indexed);
+        while (indexed < chunkEnd) {
+            const char *block = indexed;
+            char padded[64];
+            if (end - indexed < 64) {
+                memset(padded, Space, sizeof(padded));
+                memcpy(padded, indexed, end - indexed);
+                block = padded;
+            }
+            const BlockMasks m = classifyBlock(block);
+
+            // a backslash escapes the next character, unless it is escaped itself
+            quint64 escaped = prevEscaped ? 1 : 0;
+            quint64 backslash = m.backslash & ~escaped;
+            prevEscaped = false;
+            while (backslash) {
+                const uint i = qCountTrailingZeroBits(backslash);
+                if (i == 63) {
+                    prevEscaped = true;
+                    break;
+                }
+                escaped |= Q_UINT64_C(2) << i;
+                backslash &= ~(Q_UINT64_C(3) << i);
+            }
+
+            const quint64 quote = m.quote & ~escaped;
+            const quint64 inString = prefixXor(quote) ^ prevInString;
+            prevInString = quint64(qint64(inString) >> 63);
+
+            const quint64 scalar = ~(m.whitespace | m.structural | quote | inString);
+            const quint64 scalarStart = scalar & ~((scalar << 1) | (prevScalar ? 1 : 0));
+            prevScalar = scalar >> 63;
+
+            quint64 bits = ((m.structural | scalarStart) & ~inString) | quote;
+            const quint32 base = quint32(indexed - head);
+            while (bits) {
+                *out++ = base + qCountTrailingZeroBits(bits);
+                bits &= bits - 1;
+            }
+            indexed += 64;
+        }
+        if (indexed > end)
+            indexed = end;
+    }
+
+    indexPos = index.get();
+    indexEnd = out;
+    return indexPos != indexEnd;
+}
+
+inline qsizetype Parser::nextStructural()
+{
+    if (indexPos == indexEnd && !fillIndex())
+        return -1;
+    return *indexPos++;
+}
+
+inline qsizetype Parser::peekStructural()
+{
+    if (indexPos == indexEnd && !fillIndex())
+        return end - head;
+    return *indexPos;
+}
+
+bool Parser::parseIndexed(QCborValue *data)
+{
+    indexed = json;
+    const qsizetype pos = nextStructural();
+    if (pos < 0)
+        return false;
+
+    container = new QCborContainerPrivate;
+    if (head[pos] == BeginArray) {
+        if (!indexedArray())
+            return false;
+        *data = QCborContainerPrivate::makeValue(QCborValue::Array, -1, container.take(),
+                                                 QCborContainerPrivate::MoveContainer);
+    } else if (head[pos] == BeginObject) {
+        if (!indexedObject())
+            return false;
+        *data = QCborContainerPrivate::makeValue(QCborValue::Map, -1, container.take(),
+                                                 QCborContainerPrivate::MoveContainer);
+    } else {
+        return false;
+    }
+
+    return nextStructural() < 0;
+}
+
+bool Parser::indexedObject()
+{
+    if (++nestingLevel > nestingLimit)
+        return false;
+
+    qsizetype pos = nextStructural();
+    while (pos >= 0 && head[pos] == Quote) {
+        if (!container)
+            container = new QCborContainerPrivate;
+        if (!indexedString(pos))
+            return false;
+        pos = nextStructural();
+        if (pos < 0 || head[pos] != NameSeparator)
+            return false;
+        pos = nextStructural();
+        if (pos < 0 || !indexedValue(pos))
+            return false;
+        pos = nextStructural();
+        if (pos < 0 || head[pos] != ValueSeparator)
+            break;
+        pos = nextStructural();
+        if (pos >= 0 && head[pos] == EndObject)
+            return false;
+    }
+    if (pos < 0 || head[pos] != EndObject)
+        return false;
+
+    --nestingLevel;
+
+    if (container)
+        sortContainer(container.data());
+    return true;
+}
+
+bool Parser::indexedArray()
+{
+    if (++nestingLevel > nestingLimit)
+        return false;
+
+    qsizetype pos = nextStructural();
+    if (pos < 0)
+        return false;
+    if (head[pos] != EndArray) {
+        while (true) {
+            if (!container)
+                container = new QCborContainerPrivate;
+            if (!indexedValue(pos))
+                return false;
+            pos = nextStructural();
+            if (pos < 0)
+                return false;
+            if (head[pos] == EndArray)
+                break;
+            if (head[pos] != ValueSeparator)
+                return false;
+            pos = nextStructural();
+            if (pos < 0)
+                return false;
+        }
+    }
+
+    --nestingLevel;
+    return true;
+}
+
+bool Parser::indexedValue(qsizetype pos)
+{
+    switch (head[pos]) {
+    case Quote:
+        return indexedString(pos);
+    case BeginArray: {
+        StashedContainer stashedContainer(&container, QCborValue::Array);
+        return indexedArray();
+    }
+    case BeginObject: {
+        StashedContainer stashedContainer(&container, QCborValue::Map);
+        return indexedObject();
+    }
+    case ValueSeparator:
+    case NameSeparator:
+    case EndObject:
+    case EndArray:
+        return false;
+    default:
+        break;
+    }
+
+    // a literal or a number: only whitespace may follow it
+    json = head + pos;
+    if (!parseValue())
+        return false;
+    for (const char *next = head + peekStructural(); json < next; ++json) {
+        if (*json != Space && *json != Tab && *json != LineFeed && *json != Return)
+            return false;
+    }
+    return true;
+}
+
+// Returns the first backslash or non-ASCII byte in [p, e), or e.
+static inline const char *findEscapeOrNonAscii(const char *p, const char *e)
+{
+#ifdef __SSE2__
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for ( ; e - p >= 16; p += 16) {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const int mask = _mm_movemask_epi8(_mm_or_si128(data, _mm_cmpeq_epi8(data, backslash)));
+        if (mask)
+            return p + qCountTrailingZeroBits(uint(mask));
+    }
+#endif
+    for ( ; p < e; ++p) {
+        if (*p == '\\' || uchar(*p) >= 0x80)
+            return p;
+    }
+    return e;
+}
+
+bool Parser::indexedString(qsizetype pos)
+{
+    // the next entry is the closing quote
+    const qsizetype closing = nextStructural();
+    if (closing < 0)
+        return false;
+    Q_ASSERT(head[closing] == Quote);
+
+    const char *begin = head + pos + 1;
+    const char *last = head + closing;
+    const char *special = findEscapeOrNonAscii(begin, last);
+    if (special == last) {
+        container->appendAsciiString(begin, last - begin);
+        return true;
+    }
+    if (*special != '\\' && !memchr(special, '\\', last - special)) {
+        if (!QUtf8::isValidUtf8(QByteArrayView(special, last - special)).isValidUtf8)
+            return false;
+        container->appendUtf8String(begin, last - begin);
+        return true;
+    }
+
+    // escape sequences, these are converted to UTF-16
+    json = begin;
+    return parseString() && json == last + 1;
+}
+
 QT_END_NAMESPACE
@@ -55,6 +55,8 @@
 #include <QtCore/private/qcborvalue_p.h>
 #include <QtCore/qjsondocument.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
 namespace QJsonPrivate {
@@ -77,6 +79,17 @@ private:
     bool parseString();
     bool parseValue();
     bool parseNumber();
+
+    // fast path driven by a structural index of the input
+    bool parseIndexed(QCborValue *data);
+    bool indexedObject();
+    bool indexedArray();
+    bool indexedValue(qsizetype pos);
+    bool indexedString(qsizetype pos);
+    bool fillIndex();
+    inline qsizetype nextStructural();
+    inline qsizetype peekStructural();
+
     const char *head;
     const char *json;
     const char *end;
@@ -84,6 +97,14 @@ private:
     int nestingLevel;
     QJsonParseError::ParseError lastError;
     QExplicitlySharedDataPointer<QCborContainerPrivate> container;
+
+    std::unique_ptr<quint32[]> index;
+    quint32 *indexPos = nullptr;
+    quint32 *indexEnd = nullptr;
+    const char *indexed = nullptr;
+    quint64 prevInString = 0;
+    bool prevEscaped = false;
+    bool prevScalar = false;
 };
 
 }
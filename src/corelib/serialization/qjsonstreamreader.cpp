@@ -0,0 +1,1180 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qjsonstreamreader.h"
+
+#include <qiodevice.h>
+#include <qjsonarray.h>
+#include <qjsonobject.h>
+#include <qvarlengtharray.h>
+#include <private/qnumeric_p.h>
+#include <private/qstringconverter_p.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QJsonStreamReader
+    \inmodule QtCore
+    \ingroup json
+    \reentrant
+    \since 6.2
+
+    \brief The QJsonStreamReader class is a pull parser for JSON documents,
+    reading from a QByteArray or a QIODevice.
+
+    QJsonDocument::fromJson() builds the whole document in memory before any
+    of it can be used. QJsonStreamReader instead reports the document as a
+    stream of tokens, in the style of QXmlStreamReader and
+    QCborStreamReader: the application calls readNext() to get the next
+    token and deals with it before moving on. Only the data needed for the
+    current token is kept in memory, so documents of any size can be
+    processed with a bounded amount of memory.
+
+    \snippet code/src_corelib_serialization_qjsonstreamreader.cpp 0
+
+    The reader accepts the same documents as QJsonDocument::fromJson(): the
+    top-level value must be an object or an array, and the errors are
+    reported with the same QJsonParseError::ParseError codes.
+
+    \section1 Reading strings without copying
+
+    The text of the current token is available with text(), as a
+    QUtf8StringView. For the strings and names that contain no escape
+    sequence, which is the common case, the view points into the input
+    buffer and nothing is copied or allocated. Otherwise, the view points to
+    an internal buffer holding the unescaped text. Either way, the view is
+    only valid until the next call to a non-const function of the reader;
+    use toString() or copy the data to keep it.
+
+    \section1 Skipping and reading whole values
+
+    skipCurrentValue() skips the object or array that starts at the current
+    token without reporting its contents. This is much faster than reading
+    the tokens one by one, and does not need the skipped value to fit in
+    memory. The skipped data is only checked for balanced brackets and
+    complete strings.
+
+    readValue() reads the value starting at the current token as a
+    QJsonValue. This can be used to process a large array one element at a
+    time, with the convenience of QJsonObject.
+
+    \section1 Incremental parsing
+
+    When reading from a device that doesn't have all the data yet, like a
+    network socket, or when the data is given with addData(), readNext()
+    returns Incomplete when it runs out of data in the middle of the
+    document. The token is not consumed: call readNext() again once more
+    data is available. A device is considered to have all of its data when
+    it is not sequential and it is at its end, or when it is not readable
+    any more, for instance after being closed.
+
+    \sa QJsonDocument, QXmlStreamReader, QCborStreamReader
+*/
+
+/*!
+    \enum QJsonStreamReader::TokenType
+
+    This enum specifies the type of token that the reader just read.
+
+    \value NoToken      The reader has not read anything yet.
+    \value Invalid      An error occurred; see error() and errorString().
+    \value Incomplete   The reader needs more data to read the next token.
+    \value StartObject  The start of an object.
+    \value EndObject    The end of an object.
+    \value StartArray   The start of an array.
+    \value EndArray     The end of an array.
+    \value Name         The name of an object member, available with
+                        text() and toString(). The value follows.
+    \value String       A string, available with text() and toString().
+    \value Number       A number, available with toDouble() and
+                        toInteger(); text() returns it as written.
+    \value Bool         \c true or \c false, available with toBool().
+    \value Null         \c null.
+    \value EndDocument  The end of the document.
+*/
+
+static const int nestingLimit = 1024;
+static const qsizetype MinimumReadSize = 64 * 1024;
+
+class QJsonStreamReaderPrivate
+{
+public:
+    using TokenType = QJsonStreamReader::TokenType;
+
+    enum State : quint8 {
+        ExpectDocument,
+        ExpectFirstName,        // after '{'
+        ExpectName,             // after ',' in an object
+        ExpectNameSeparator,
+        ExpectFirstValue,       // after '['
+        ExpectValue,            // after ',' in an array, or after ':'
+        ExpectSeparator,        // after a value in a container
+        ExpectEndOfDocument,
+        Finished,
+        Failed
+    };
+
+    void reset()
+    {
+        buffer.clear();
+        pos = 0;
+        discarded = 0;
+        readSize = MinimumReadSize;
+        endOfInput = false;
+        containers.clear();
+        state = ExpectDocument;
+        token = QJsonStreamReader::NoToken;
+        error = QJsonParseError::NoError;
+        tokenStart = tokenEnd = 0;
+        scanned = 0;
+        hasEscapes = false;
+        unescaped.clear();
+        skipValuePending = false;
+        skipping = false;
+        skipInString = false;
+    }
+
+    TokenType readNext();
+    TokenType fail(QJsonParseError::ParseError e)
+    {
+        error = e;
+        state = Failed;
+        return QJsonStreamReader::Invalid;
+    }
+    TokenType endOfData(QJsonParseError::ParseError e)
+    { return isFinal() ? fail(e) : QJsonStreamReader::Incomplete; }
+    QJsonParseError::ParseError unterminatedContainer() const
+    {
+        return containers.last() == '{' ? QJsonParseError::UnterminatedObject
+                                        : QJsonParseError::UnterminatedArray;
+    }
+
+    bool isFinal() const;
+    void compact();
+    bool fill();
+    bool ensure(qsizetype n);
+    int peek();
+
+    TokenType startContainer(char bracket);
+    TokenType endContainer();
+    TokenType readValue(int c);
+    TokenType readString(TokenType type);
+    TokenType readLiteral(const char *literal, qsizetype length, TokenType type);
+    TokenType readNumber();
+    TokenType skip();
+
+    void setToken(qsizetype start, qsizetype end)
+    {
+        tokenStart = start;
+        tokenEnd = end;
+    }
+    const char *tokenData() const { return buffer.constData() + tokenStart; }
+    qsizetype tokenSize() const { return tokenEnd - tokenStart; }
+
+    QIODevice *device = nullptr;
+    QByteArray buffer;
+    qsizetype pos = 0;              // the first byte not consumed
+    qint64 discarded = 0;           // bytes removed from the front of the buffer
+    qsizetype readSize = MinimumReadSize;
+    bool endOfInput = false;        // no data will be added to the buffer
+
+    QVarLengthArray<char, 64> containers;   // '{' or '['
+    State state = ExpectDocument;
+    TokenType token = QJsonStreamReader::NoToken;
+    QJsonParseError::ParseError error = QJsonParseError::NoError;
+
+    // the current token; for strings, the text between the quotes
+    qsizetype tokenStart = 0;
+    qsizetype tokenEnd = 0;
+    qsizetype scanned = 0;          // how much of an incomplete string was checked
+    bool hasEscapes = false;
+    QByteArray unescaped;
+    bool isInteger = false;
+    bool boolValue = false;
+    qint64 integerValue = 0;
+    double doubleValue = 0;
+
+    // skipCurrentValue() in progress
+    bool skipValuePending = false;  // the value after a Name
+    bool skipping = false;
+    bool skipInString = false;
+    qsizetype skipDepth = 0;
+};
+
+bool QJsonStreamReaderPrivate::isFinal() const
+{
+    if (endOfInput)
+        return true;
+    if (!device)
+        return false;
+    return !device->isReadable() || (!device->isSequential() && device->atEnd());
+}
+
+/*!
+    \internal
+
+    Reads more data from the device, after discarding the data consumed
+    already. The amount read grows with the size of the pending token, so
+    that scanning a large token again after each read stays linear.
+    Returns \c false if no data could be read.
+*/
+bool QJsonStreamReaderPrivate::fill()
+{
+    if (!device || endOfInput || !device->isReadable())
+        return false;
+
+    compact();
+    const qsizetype size = buffer.size();
+    readSize = qMax(MinimumReadSize, size);
+    buffer.resize(size + readSize);
+    const qint64 n = device->read(buffer.data() + size, readSize);
+    buffer.resize(size + qMax(n, qint64(0)));
+    return n > 0;
+}
+
+// Discards the data consumed already.
+void QJsonStreamReaderPrivate::compact()
+{
+    if (!pos)
+        return;
+    const qsizetype size = buffer.size() - pos;
+    discarded += pos;
+    if (size)
+        memmove(buffer.data(), buffer.constData() + pos, size);
+    buffer.resize(size);
+    tokenStart -= pos;
+    tokenEnd -= pos;
+    pos = 0;
+}
+
+bool QJsonStreamReaderPrivate::ensure(qsizetype n)
+{
+    while (buffer.size() - pos < n) {
+        if (!fill())
+            return false;
+    }
+    return true;
+}
+
+// Skips whitespace and returns the next byte, or -1 if there is no more
+// data for now.
+int QJsonStreamReaderPrivate::peek()
+{
+    for (;;) {
+        const char *p = buffer.constData() + pos;
+        const char *end = buffer.constData() + buffer.size();
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+            ++p;
+        pos = p - buffer.constData();
+        if (p < end)
+            return uchar(*p);
+        if (!fill())
+            return -1;
+    }
+}
+
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::startContainer(char bracket)
+{
+    if (containers.size() >= nestingLimit)
+        return fail(QJsonParseError::DeepNesting);
+    containers.append(bracket);
+    setToken(pos, pos + 1);
+    ++pos;
+    if (bracket == '{') {
+        state = ExpectFirstName;
+        return QJsonStreamReader::StartObject;
+    }
+    state = ExpectFirstValue;
+    return QJsonStreamReader::StartArray;
+}
+
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::endContainer()
+{
+    const char bracket = containers.last();
+    containers.removeLast();
+    setToken(pos, pos + 1);
+    ++pos;
+    state = containers.isEmpty() ? ExpectEndOfDocument : ExpectSeparator;
+    return bracket == '{' ? QJsonStreamReader::EndObject : QJsonStreamReader::EndArray;
+}
+
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::readNext()
+{
+    if (skipping)
+        return skip();
+
+    for (;;) {
+        switch (state) {
+        case Failed:
+            return QJsonStreamReader::Invalid;
+        case Finished:
+            return QJsonStreamReader::EndDocument;
+
+        case ExpectDocument: {
+            // UTF-8 byte order mark
+            if (!ensure(1))
+                return endOfData(QJsonParseError::IllegalValue);
+            if (uchar(buffer.at(pos)) == 0xef) {
+                if (!ensure(3))
+                    return endOfData(QJsonParseError::IllegalValue);
+                if (uchar(buffer.at(pos + 1)) == 0xbb && uchar(buffer.at(pos + 2)) == 0xbf)
+                    pos += 3;
+            }
+            const int c = peek();
+            if (c < 0)
+                return endOfData(QJsonParseError::IllegalValue);
+            if (c != '{' && c != '[')
+                return fail(QJsonParseError::IllegalValue);
+            return startContainer(char(c));
+        }
+
+        case ExpectFirstName:
+        case ExpectName: {
+            const int c = peek();
+            if (c < 0)
+                return endOfData(QJsonParseError::UnterminatedObject);
+            if (c == '"') {
+                const TokenType type = readString(QJsonStreamReader::Name);
+                if (type == QJsonStreamReader::Name)
+                    state = ExpectNameSeparator;
+                return type;
+            }
+            if (c == '}') {
+                if (state == ExpectFirstName)
+                    return endContainer();
+                return fail(QJsonParseError::MissingObject);
+            }
+            return fail(QJsonParseError::UnterminatedObject);
+        }
+
+        case ExpectNameSeparator: {
+            const int c = peek();
+            if (c < 0)
+                return endOfData(QJsonParseError::MissingNameSeparator);
+            if (c != ':')
+                return fail(QJsonParseError::MissingNameSeparator);
+            ++pos;
+            state = ExpectValue;
+            break;
+        }
+
+        case ExpectFirstValue:
+        case ExpectValue: {
+            const int c = peek();
+            if (c < 0)
+                return endOfData(unterminatedContainer());
+            if (c == ']' && state == ExpectFirstValue)
+                return endContainer();
+            return readValue(c);
+        }
+
+        case ExpectSeparator: {
+            const int c = peek();
+            if (c < 0)
+                return endOfData(unterminatedContainer());
+            const bool inObject = containers.last() == '{';
+            if (c == ',') {
+                ++pos;
+                state = inObject ? ExpectName : ExpectValue;
+                break;
+            }
+            if (c == (inObject ? '}' : ']'))
+                return endContainer();
+            return fail(inObject ? QJsonParseError::UnterminatedObject
+                                 : QJsonParseError::MissingValueSeparator);
+        }
+
+        case ExpectEndOfDocument:
+            // only whitespace may follow; don't wait for more data to check
+            if (peek() >= 0)
+                return fail(QJsonParseError::GarbageAtEnd);
+            state = Finished;
+            setToken(pos, pos);
+            return QJsonStreamReader::EndDocument;
+        }
+    }
+}
+
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::readValue(int c)
+{
+    TokenType type;
+    switch (c) {
+    case '{':
+    case '[':
+        return startContainer(char(c));
+    case '"':
+        type = readString(QJsonStreamReader::String);
+        break;
+    case 't':
+        type = readLiteral("true", 4, QJsonStreamReader::Bool);
+        break;
+    case 'f':
+        type = readLiteral("false", 5, QJsonStreamReader::Bool);
+        break;
+    case 'n':
+        type = readLiteral("null", 4, QJsonStreamReader::Null);
+        break;
+    case ',':
+        // a missing value, after a colon
+        return fail(QJsonParseError::IllegalValue);
+    case ']':
+    case '}':
+        return fail(QJsonParseError::MissingObject);
+    default:
+        type = readNumber();
+        break;
+    }
+    if (type != QJsonStreamReader::Invalid && type != QJsonStreamReader::Incomplete)
+        state = ExpectSeparator;
+    return type;
+}
+
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::readLiteral(const char *literal,
+                                                                   qsizetype length,
+                                                                   TokenType type)
+{
+    if (!ensure(length))
+        return endOfData(QJsonParseError::IllegalValue);
+    if (memcmp(buffer.constData() + pos, literal, length) != 0)
+        return fail(QJsonParseError::IllegalValue);
+    boolValue = literal[0] == 't';
+    setToken(pos, pos + length);
+    pos += length;
+    return type;
+}
+
+static bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/*
+    number = [ minus ] int [ frac ] [ exp ]
+
+    The grammar is checked as leniently as by QJsonPrivate::Parser, so that
+    both accept the same documents.
+*/
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::readNumber()
+{
+    for (;;) {
+        const char *start = buffer.constData() + pos;
+        const char *end = buffer.constData() + buffer.size();
+        const char *p = start;
+        bool isInt = true;
+
+        if (p < end && *p == '-')
+            ++p;
+        if (p < end && *p == '0') {
+            ++p;
+        } else {
+            while (p < end && isDigit(*p))
+                ++p;
+        }
+        if (p < end && *p == '.') {
+            ++p;
+            while (p < end && isDigit(*p)) {
+                isInt = isInt && *p == '0';
+                ++p;
+            }
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            isInt = false;
+            ++p;
+            if (p < end && (*p == '-' || *p == '+'))
+                ++p;
+            while (p < end && isDigit(*p))
+                ++p;
+        }
+
+        if (p == end) {
+            // the number may go on
+            if (fill())
+                continue;
+            return endOfData(QJsonParseError::TerminationByNumber);
+        }
+
+        const QByteArray number = QByteArray::fromRawData(start, p - start);
+        bool ok = false;
+        if (isInt) {
+            integerValue = number.toLongLong(&ok);
+            isInteger = ok;
+        }
+        if (!ok) {
+            doubleValue = number.toDouble(&ok);
+            if (!ok)
+                return fail(QJsonParseError::IllegalNumber);
+            isInteger = convertDoubleTo(doubleValue, &integerValue);
+        }
+        if (isInteger)
+            doubleValue = double(integerValue);
+        setToken(pos, pos + (p - start));
+        pos += p - start;
+        return QJsonStreamReader::Number;
+    }
+}
+
+static inline bool isHexDigit(char c)
+{
+    return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static inline uint hexValue(const char *p)
+{
+    uint result = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char c = p[i];
+        result <<= 4;
+        if (isDigit(c))
+            result |= c - '0';
+        else
+            result |= (c | 0x20) - 'a' + 10;
+    }
+    return result;
+}
+
+/*!
+    \internal
+
+    Decodes the escape sequence at \a p, which was validated already, and
+    returns the UTF-16 code unit or the character it stands for.
+*/
+static uint decodeEscape(const char *&p)
+{
+    ++p;
+    const char escaped = *p++;
+    switch (escaped) {
+    case 'b':
+        return 0x8;
+    case 'f':
+        return 0xc;
+    case 'n':
+        return 0xa;
+    case 'r':
+        return 0xd;
+    case 't':
+        return 0x9;
+    case 'u': {
+        const uint u = hexValue(p);
+        p += 4;
+        return u;
+    }
+    default:
+        // like QJsonDocument, take anything else literally
+        return uchar(escaped);
+    }
+}
+
+static void appendUtf8(QByteArray &out, char32_t u)
+{
+    char buf[4];
+    char *dst = buf;
+    if (u < 0x80) {
+        *dst++ = char(u);
+    } else if (u < 0x800) {
+        *dst++ = char(0xc0 | (u >> 6));
+        *dst++ = char(0x80 | (u & 0x3f));
+    } else if (u < 0x10000) {
+        *dst++ = char(0xe0 | (u >> 12));
+        *dst++ = char(0x80 | ((u >> 6) & 0x3f));
+        *dst++ = char(0x80 | (u & 0x3f));
+    } else {
+        *dst++ = char(0xf0 | (u >> 18));
+        *dst++ = char(0x80 | ((u >> 12) & 0x3f));
+        *dst++ = char(0x80 | ((u >> 6) & 0x3f));
+        *dst++ = char(0x80 | (u & 0x3f));
+    }
+    out.append(buf, dst - buf);
+}
+
+/*!
+    \internal
+
+    Reads the string starting at the quote at the current position. The
+    part of the string checked already is remembered when more data is
+    needed, so that a long string arriving in small pieces is only scanned
+    once.
+*/
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::readString(TokenType type)
+{
+    if (!scanned)
+        hasEscapes = false;
+
+    for (;;) {
+        const char *begin = buffer.constData() + pos + 1;
+        const char *end = buffer.constData() + buffer.size();
+        const char *p = begin + scanned;
+        bool needMore = false;
+        while (p < end) {
+            const uchar c = uchar(*p);
+            if (c == '"')
+                break;
+            if (c == '\\') {
+                if (end - p < 2) {
+                    needMore = true;
+                    break;
+                }
+                if (p[1] == 'u') {
+                    if (end - p < 6) {
+                        needMore = true;
+                        break;
+                    }
+                    if (!isHexDigit(p[2]) || !isHexDigit(p[3]) || !isHexDigit(p[4])
+                            || !isHexDigit(p[5])) {
+                        pos = p - buffer.constData();
+                        return fail(QJsonParseError::IllegalEscapeSequence);
+                    }
+                    p += 6;
+                } else {
+                    p += 2;
+                }
+                hasEscapes = true;
+                continue;
+            }
+            if (c < 0x80) {
+                ++p;
+                continue;
+            }
+            uint ch;
+            uint *dst = &ch;
+            const uchar *src = reinterpret_cast<const uchar *>(p) + 1;
+            const qsizetype res = QUtf8Functions::fromUtf8<QUtf8BaseTraits>(
+                        c, dst, src, reinterpret_cast<const uchar *>(end));
+            if (res == QUtf8BaseTraits::EndOfString) {
+                needMore = true;
+                break;
+            }
+            if (res < 0) {
+                pos = p - buffer.constData();
+                return fail(QJsonParseError::IllegalUTF8String);
+            }
+            p = reinterpret_cast<const char *>(src);
+        }
+
+        if (!needMore && p < end) {
+            setToken(pos + 1, p - buffer.constData());
+            pos = tokenEnd + 1;
+            scanned = 0;
+            break;
+        }
+
+        scanned = p - begin;
+        if (!fill()) {
+            if (isFinal()) {
+                scanned = 0;
+                return fail(QJsonParseError::UnterminatedString);
+            }
+            return QJsonStreamReader::Incomplete;
+        }
+    }
+
+    if (hasEscapes) {
+        // decode to UTF-8; unpaired surrogates can't be represented
+        unescaped.resize(0);
+        const char *p = tokenData();
+        const char *end = p + tokenSize();
+        while (p < end) {
+            if (*p != '\\') {
+                const char *run = p;
+                while (p < end && *p != '\\')
+                    ++p;
+                unescaped.append(run, p - run);
+                continue;
+            }
+            char32_t u = decodeEscape(p);
+            if (QChar::isHighSurrogate(u)) {
+                if (end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                    const char *q = p;
+                    const uint low = decodeEscape(q);
+                    if (QChar::isLowSurrogate(low)) {
+                        u = QChar::surrogateToUcs4(char16_t(u), char16_t(low));
+                        p = q;
+                    }
+                }
+            }
+            if (QChar::isSurrogate(u))
+                u = QChar::ReplacementCharacter;
+            appendUtf8(unescaped, u);
+        }
+    }
+    return type;
+}
+
+/*!
+    \internal
+
+    Skips the data until the end of the container being skipped, without
+    keeping it in the buffer.
+*/
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::skip()
+{
+    for (;;) {
+        const char *data = buffer.constData();
+        const char *p = data + pos;
+        const char *end = data + buffer.size();
+        while (p < end) {
+            const char c = *p++;
+            if (skipInString) {
+                if (c == '"') {
+                    skipInString = false;
+                } else if (c == '\\') {
+                    if (p == end) {
+                        --p;
+                        break;
+                    }
+                    ++p;
+                }
+                continue;
+            }
+            switch (c) {
+            case '"':
+                skipInString = true;
+                break;
+            case '{':
+            case '[':
+                if (containers.size() >= nestingLimit) {
+                    pos = p - data - 1;
+                    skipping = false;
+                    return fail(QJsonParseError::DeepNesting);
+                }
+                containers.append(c);
+                break;
+            case '}':
+            case ']':
+                pos = p - data - 1;
+                if (containers.last() != (c == '}' ? '{' : '[')) {
+                    skipping = false;
+                    return fail(c == '}' ? QJsonParseError::MissingValueSeparator
+                                         : QJsonParseError::UnterminatedObject);
+                }
+                if (containers.size() == skipDepth) {
+                    skipping = false;
+                    return endContainer();
+                }
+                containers.removeLast();
+                ++pos;
+                break;
+            default:
+                break;
+            }
+        }
+        pos = p - data;
+        if (!fill()) {
+            if (isFinal()) {
+                skipping = false;
+                return fail(unterminatedContainer());
+            }
+            return QJsonStreamReader::Incomplete;
+        }
+    }
+}
+
+/*!
+    Constructs a reader with no data. Set a device with setDevice(), or add
+    data with addData().
+*/
+QJsonStreamReader::QJsonStreamReader()
+    : d(new QJsonStreamReaderPrivate)
+{
+}
+
+/*!
+    Constructs a reader that reads the JSON document in \a data. The data
+    is not copied.
+*/
+QJsonStreamReader::QJsonStreamReader(const QByteArray &data)
+    : QJsonStreamReader()
+{
+    d->buffer = data;
+    d->endOfInput = true;
+}
+
+/*!
+    Constructs a reader that reads from \a device. The device must be open
+    for reading, and must stay valid while the reader uses it.
+*/
+QJsonStreamReader::QJsonStreamReader(QIODevice *device)
+    : QJsonStreamReader()
+{
+    d->device = device;
+}
+
+/*!
+    Destroys the reader.
+*/
+QJsonStreamReader::~QJsonStreamReader()
+{
+}
+
+/*!
+    Makes the reader read from \a device, from the start of a new document.
+
+    \sa device(), clear()
+*/
+void QJsonStreamReader::setDevice(QIODevice *device)
+{
+    d->reset();
+    d->device = device;
+}
+
+/*!
+    Returns the device the reader reads from, or \nullptr if there is none.
+
+    \sa setDevice()
+*/
+QIODevice *QJsonStreamReader::device() const
+{
+    return d->device;
+}
+
+/*!
+    Adds \a data for the reader to read. This function does nothing if the
+    reader has a device.
+
+    The views returned by text() before this call become invalid.
+
+    \sa readNext(), clear()
+*/
+void QJsonStreamReader::addData(const QByteArray &data)
+{
+    if (d->device) {
+        qWarning("QJsonStreamReader: addData() with device()");
+        return;
+    }
+    if (d->endOfInput) {
+        qWarning("QJsonStreamReader: addData() after the complete data was set");
+        return;
+    }
+    if (d->pos == d->buffer.size()) {
+        // nothing pending: share the new data instead of copying it
+        d->discarded += d->buffer.size();
+        d->tokenStart = d->tokenEnd = 0;
+        d->pos = 0;
+        d->buffer = data;
+    } else {
+        d->compact();
+        d->buffer.append(data);
+    }
+}
+
+/*!
+    Removes any data and device from the reader, and resets it to its
+    initial state.
+*/
+void QJsonStreamReader::clear()
+{
+    d->reset();
+    d->device = nullptr;
+}
+
+/*!
+    Reads the next token and returns its type.
+
+    Returns Incomplete if more data is needed to read the token; the reader
+    stays where it was and the token can be read once data was added.
+    Returns Invalid if the document is not valid JSON, and keeps returning
+    it. Returns EndDocument at the end of the document.
+
+    \sa tokenType()
+*/
+QJsonStreamReader::TokenType QJsonStreamReader::readNext()
+{
+    d->skipValuePending = false;
+    return d->token = d->readNext();
+}
+
+/*!
+    Returns the type of the current token.
+
+    \sa readNext()
+*/
+QJsonStreamReader::TokenType QJsonStreamReader::tokenType() const
+{
+    return d->token;
+}
+
+/*!
+    Returns \c true if the reader reached the end of the document or an
+    error.
+*/
+bool QJsonStreamReader::atEnd() const
+{
+    return d->state == QJsonStreamReaderPrivate::Finished
+            || d->state == QJsonStreamReaderPrivate::Failed;
+}
+
+/*!
+    Returns the number of objects and arrays that contain the current
+    position. It is 1 after reading the StartObject or StartArray token of
+    the document.
+*/
+int QJsonStreamReader::depth() const
+{
+    return int(d->containers.size());
+}
+
+/*!
+    Returns the offset in bytes of the current position in the input. In
+    case of error, this is where the error was found.
+*/
+qint64 QJsonStreamReader::offset() const
+{
+    return d->discarded + d->pos;
+}
+
+/*!
+    Returns the text of the current token, as UTF-8.
+
+    For a Name or a String, this is the unescaped string. Unpaired UTF-16
+    surrogates, which some escape sequences produce but UTF-8 cannot
+    represent, are replaced by U+FFFD; toString() keeps them. For a Number,
+    this is the number as written in the document. For the other tokens,
+    this is the text read, if any.
+
+    The view is valid until the next call to a non-const function of the
+    reader.
+
+    \sa toString()
+*/
+QUtf8StringView QJsonStreamReader::text() const
+{
+    if (d->token == Invalid || d->token == Incomplete || d->token == NoToken)
+        return QUtf8StringView();
+    if ((d->token == Name || d->token == String) && d->hasEscapes)
+        return QUtf8StringView(d->unescaped.constData(), d->unescaped.size());
+    return QUtf8StringView(d->tokenData(), d->tokenSize());
+}
+
+/*!
+    Returns the text of the current token as a string.
+
+    For a Name or a String, the escape sequences are decoded exactly like
+    QJsonDocument::fromJson() does.
+
+    \sa text()
+*/
+QString QJsonStreamReader::toString() const
+{
+    if ((d->token != Name && d->token != String) || !d->hasEscapes)
+        return text().toString();
+
+    QString result;
+    result.reserve(d->tokenSize());
+    const char *p = d->tokenData();
+    const char *end = p + d->tokenSize();
+    while (p < end) {
+        if (*p != '\\') {
+            const char *run = p;
+            while (p < end && *p != '\\')
+                ++p;
+            result += QString::fromUtf8(run, p - run);
+            continue;
+        }
+        result += QChar(char16_t(decodeEscape(p)));
+    }
+    return result;
+}
+
+/*!
+    Returns the value of the current token if it is a Number, or 0.
+
+    \sa toInteger()
+*/
+double QJsonStreamReader::toDouble() const
+{
+    return d->token == Number ? d->doubleValue : 0;
+}
+
+/*!
+    Returns the value of the current token if it is a Number with an
+    integral value that fits in a qint64. Returns \a defaultValue otherwise.
+
+    \sa toDouble()
+*/
+qint64 QJsonStreamReader::toInteger(qint64 defaultValue) const
+{
+    return d->token == Number && d->isInteger ? d->integerValue : defaultValue;
+}
+
+/*!
+    Returns the value of the current token if it is a Bool, or \c false.
+*/
+bool QJsonStreamReader::toBool() const
+{
+    return d->token == Bool && d->boolValue;
+}
+
+/*!
+    Reads the value starting at the current token and returns it.
+
+    For StartObject and StartArray, this reads the whole object or array,
+    and leaves the reader on the matching EndObject or EndArray token. For
+    a Name, this returns the name as a string. For the other tokens, this
+    returns the value of the token, or QJsonValue::Undefined if the token
+    is not a value.
+
+    If an error occurs, or if the data ends in the middle of the value,
+    this function returns QJsonValue::Undefined and the part of the value
+    already read is lost. Make sure that the whole value is available when
+    reading from a device receiving data asynchronously.
+
+    \sa skipCurrentValue()
+*/
+QJsonValue QJsonStreamReader::readValue()
+{
+    switch (d->token) {
+    case Name:
+    case String:
+        return toString();
+    case Number:
+        return d->isInteger ? QJsonValue(d->integerValue) : QJsonValue(d->doubleValue);
+    case Bool:
+        return d->boolValue;
+    case Null:
+        return QJsonValue::Null;
+    case StartObject: {
+        QJsonObject object;
+        while (readNext() == Name) {
+            const QString name = toString();
+            readNext();
+            const QJsonValue value = readValue();
+            if (value.isUndefined())
+                return QJsonValue::Undefined;
+            object.insert(name, value);
+        }
+        if (d->token != EndObject)
+            return QJsonValue::Undefined;
+        return object;
+    }
+    case StartArray: {
+        QJsonArray array;
+        for (;;) {
+            readNext();
+            if (d->token == EndArray)
+                break;
+            const QJsonValue value = readValue();
+            if (value.isUndefined())
+                return QJsonValue::Undefined;
+            array.append(value);
+        }
+        return array;
+    }
+    default:
+        break;
+    }
+    return QJsonValue::Undefined;
+}
+
+/*!
+    Skips the value starting at the current token.
+
+    For StartObject and StartArray, this skips the contents of the object
+    or array and leaves the reader on the matching EndObject or EndArray
+    token. For a Name, this skips the value of that member. For the other
+    tokens, this does nothing.
+
+    Returns \c true if the value was skipped. Returns \c false in case of
+    error, or if more data is needed, in which case tokenType() is
+    Incomplete: call this function again once more data is available to go
+    on skipping.
+
+    \sa readValue()
+*/
+bool QJsonStreamReader::skipCurrentValue()
+{
+    if (d->skipping) {
+        // resume after Incomplete
+        d->token = d->readNext();
+        return d->token == EndObject || d->token == EndArray;
+    }
+    if (d->token == Name)
+        d->skipValuePending = true;
+    if (d->skipValuePending) {
+        d->token = d->readNext();
+        if (d->token == Incomplete)
+            return false;
+        d->skipValuePending = false;
+    }
+    if (d->token != StartObject && d->token != StartArray)
+        return d->token != Invalid;
+
+    d->skipping = true;
+    d->skipInString = false;
+    d->skipDepth = d->containers.size();
+    d->token = d->readNext();
+    return d->token == EndObject || d->token == EndArray;
+}
+
+/*!
+    Returns \c true if an error occurred.
+
+    \sa error(), errorString()
+*/
+bool QJsonStreamReader::hasError() const
+{
+    return d->error != QJsonParseError::NoError;
+}
+
+/*!
+    Returns the error that occurred, or QJsonParseError::NoError. offset()
+    returns where the error was found.
+
+    \sa errorString(), hasError()
+*/
+QJsonParseError::ParseError QJsonStreamReader::error() const
+{
+    return d->error;
+}
+
+/*!
+    Returns a description of the error that occurred, or of the absence of
+    error.
+
+    \sa error()
+*/
+QString QJsonStreamReader::errorString() const
+{
+    QJsonParseError e;
+    e.error = d->error;
+    e.offset = int(offset());
+    return e.errorString();
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qjsonstreamreader.cpp"
@@ -45,6 +45,7 @@
 #include "private/qstringconverter_p.h"
 #include <private/qnumeric_p.h>
 #include <private/qcborvalue_p.h>
+#include <private/qlocale_tools_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -58,61 +59,71 @@ static inline uchar hexdig(uint u)
     return (u < 0xa ? '0' + u : 'a' + u - 0xa);
 }
 
-static QByteArray escapedString(const QString &s)
+// Makes sure there are at least \a needed bytes after \a cursor in \a ba.
+static inline uchar *reserveSpace(QByteArray &ba, uchar *cursor, qsizetype needed)
 {
-    // give it a minimum size to ensure the resize() below always adds enough space
-    QByteArray ba(qMax(s.length(), 16), Qt::Uninitialized);
+    const qsizetype pos = cursor - reinterpret_cast<const uchar *>(ba.constData());
+    if (ba.size() - pos < needed)
+        ba.resize(pos + needed + 256); // the capacity grows geometrically
+    return reinterpret_cast<uchar *>(ba.data()) + pos;
+}
+
+// Escapes an ASCII character that may not appear in a JSON string as is.
+// Returns false if \a u needs no escaping.
+static inline bool escapeAscii(uint u, uchar *&cursor)
+{
+    if (u >= 0x20 && u != 0x22 && u != 0x5c)
+        return false;
+
+    *cursor++ = '\\';
+    switch (u) {
+    case 0x22:
+        *cursor++ = '"';
+        break;
+    case 0x5c:
+        *cursor++ = '\\';
+        break;
+    case 0x8:
+        *cursor++ = 'b';
+        break;
+    case 0xc:
+        *cursor++ = 'f';
+        break;
+    case 0xa:
+        *cursor++ = 'n';
+        break;
+    case 0xd:
+        *cursor++ = 'r';
+        break;
+    case 0x9:
+        *cursor++ = 't';
+        break;
+    default:
+        *cursor++ = 'u';
+        *cursor++ = '0';
+        *cursor++ = '0';
+        *cursor++ = hexdig(u>>4);
+        *cursor++ = hexdig(u & 0xf);
+    }
+    return true;
+}
 
-    uchar *cursor = reinterpret_cast<uchar *>(const_cast<char *>(ba.constData()));
-    const uchar *ba_end = cursor + ba.length();
-    const ushort *src = reinterpret_cast<const ushort *>(s.constBegin());
-    const ushort *const end = reinterpret_cast<const ushort *>(s.constEnd());
+static void escapeUtf16(QByteArray &json, QStringView s)
+{
+    const qsizetype pos = json.size();
+    // give it some extra space to ensure the reserveSpace() below rarely has to grow it
+    json.resize(pos + s.size() + 16);
+    uchar *cursor = reinterpret_cast<uchar *>(json.data()) + pos;
+    const ushort *src = reinterpret_cast<const ushort *>(s.utf16());
+    const ushort *const end = src + s.size();
 
     while (src != end) {
-        if (cursor >= ba_end - 6) {
-            // ensure we have enough space
-            int pos = cursor - (const uchar *)ba.constData();
-            ba.resize(ba.size()*2);
-            cursor = (uchar *)ba.data() + pos;
-            ba_end = (const uchar *)ba.constData() + ba.length();
-        }
+        cursor = reserveSpace(json, cursor, 6);
 
         uint u = *src++;
         if (u < 0x80) {
-            if (u < 0x20 || u == 0x22 || u == 0x5c) {
-                *cursor++ = '\\';
-                switch (u) {
-                case 0x22:
-                    *cursor++ = '"';
-                    break;
-                case 0x5c:
-                    *cursor++ = '\\';
-                    break;
-                case 0x8:
-                    *cursor++ = 'b';
-                    break;
-                case 0xc:
-                    *cursor++ = 'f';
-                    break;
-                case 0xa:
-                    *cursor++ = 'n';
-                    break;
-                case 0xd:
-                    *cursor++ = 'r';
-                    break;
-                case 0x9:
-                    *cursor++ = 't';
-                    break;
-                default:
-                    *cursor++ = 'u';
-                    *cursor++ = '0';
-                    *cursor++ = '0';
-                    *cursor++ = hexdig(u>>4);
-                    *cursor++ = hexdig(u & 0xf);
-               }
-            } else {
+            if (!escapeAscii(u, cursor))
                 *cursor++ = (uchar)u;
-            }
         } else if (QUtf8Functions::toUtf8<QUtf8BaseTraits>(u, cursor, src, end) < 0) {
             // failed to get valid utf8 use JSON escape sequence
             *cursor++ = '\\';
@@ -124,14 +135,180 @@ static QByteArray escapedString(const QString &s)
         }
     }
 
-    ba.resize(cursor - (const uchar *)ba.constData());
-    return ba;
+    json.resize(cursor - reinterpret_cast<const uchar *>(json.constData()));
+}
+
+// Latin-1 and valid UTF-8 only need their ASCII control characters, quotes
+// and backslashes escaped; runs of other characters are copied as they are.
+template <bool Latin1>
+static void escapeBytes(QByteArray &json, const uchar *src, const uchar *end)
+{
+    const qsizetype pos = json.size();
+    json.resize(pos + (end - src) + 16);
+    uchar *cursor = reinterpret_cast<uchar *>(json.data()) + pos;
+
+    while (src != end) {
+        const uchar *run = src;
+        while (src != end && *src >= 0x20 && *src != 0x22 && *src != 0x5c && (!Latin1 || *src < 0x80))
+            ++src;
+        if (src != run) {
+            cursor = reserveSpace(json, cursor, src - run);
+            memcpy(cursor, run, src - run);
+            cursor += src - run;
+        }
+        if (src == end)
+            break;
+
+        cursor = reserveSpace(json, cursor, 6);
+        const uint u = *src++;
+        if (!escapeAscii(u, cursor)) {
+            Q_ASSERT(Latin1 && u >= 0x80);
+            *cursor++ = 0xc0 | uchar(u >> 6);
+            *cursor++ = 0x80 | uchar(u & 0x3f);
+        }
+    }
+
+    json.resize(cursor - reinterpret_cast<const uchar *>(json.constData()));
+}
+
+static void escapeString(QByteArray &json, QStringView s)
+{
+    escapeUtf16(json, s);
+}
+
+static void escapeString(QByteArray &json, QLatin1String s)
+{
+    const auto *src = reinterpret_cast<const uchar *>(s.data());
+    escapeBytes<true>(json, src, src + s.size());
+}
+
+static void escapeString(QByteArray &json, QUtf8StringView s)
+{
+    if (QUtf8::isValidUtf8(QByteArrayView(s.data(), s.size())).isValidUtf8) {
+        const auto *src = reinterpret_cast<const uchar *>(s.data());
+        escapeBytes<false>(json, src, src + s.size());
+    } else {
+        escapeUtf16(json, QString::fromUtf8(s.data(), s.size()));
+    }
+}
+
+void Writer::appendEscaped(QByteArray &json, QAnyStringView s)
+{
+    s.visit([&json](auto s) { escapeString(json, s); });
+}
+
+QAnyStringView Writer::stringAt(const QCborContainerPrivate *c, qsizetype idx)
+{
+    const QtCbor::Element &e = c->elements.at(idx);
+    const QtCbor::ByteData *b = c->byteData(e);
+    if (!b)
+        return QLatin1String("");
+    if (e.flags & QtCbor::Element::StringIsUtf16)
+        return b->asStringView();
+    if (e.flags & QtCbor::Element::StringIsAscii)
+        return b->asLatin1();
+    return QUtf8StringView(b->byte(), b->len);
+}
+
+/*
+    Formats \a d like QByteArray::number(d, 'g', QLocale::FloatingPointShortest)
+    does, without the detour through QString and the locale: the shortest
+    representation that reads back as the same value, in decimal or in
+    exponent form, whichever is shorter.
+*/
+void Writer::appendDouble(QByteArray &json, double d)
+{
+    if (!qIsFinite(d)) {
+        json += "null"; // +INF || -INF || NaN (see RFC4627#section2.4)
+        return;
+    }
+
+    char digits[std::numeric_limits<double>::max_digits10 + 1];
+    bool negative = false;
+    int length = 0;
+    int decpt = 0;
+    qt_doubleToAscii(d, QLocaleData::DFSignificantDigits, QLocale::FloatingPointShortest,
+                     digits, sizeof(digits), negative, length, decpt);
+
+    char buf[std::numeric_limits<double>::max_digits10 + 16];
+    char *out = buf;
+    if (negative && d != 0)
+        *out++ = '-';
+
+    // The exponent form adds 'e', the sign and (at least) two digits; the
+    // decimal form drops the separator when there's nothing after it, it
+    // pads with zeros when the digits don't reach the decimal separator.
+    int bias = 4;
+    if (length <= decpt && length > 1)
+        ++bias;
+    else if (length == 1 && decpt <= 0)
+        --bias;
+    const bool useDecimal = decpt <= 0 ? 1 - decpt <= bias : decpt <= length + bias;
+
+    if (!useDecimal) {
+        *out++ = digits[0];
+        if (length > 1) {
+            *out++ = '.';
+            memcpy(out, digits + 1, length - 1);
+            out += length - 1;
+        }
+        *out++ = 'e';
+        int exponent = decpt - 1;
+        *out++ = exponent < 0 ? '-' : '+';
+        exponent = qAbs(exponent);
+        if (exponent >= 100)
+            *out++ = '0' + exponent / 100;
+        *out++ = '0' + exponent / 10 % 10;
+        *out++ = '0' + exponent % 10;
+    } else if (decpt <= 0) {
+        *out++ = '0';
+        *out++ = '.';
+        memset(out, '0', -decpt);
+        out += -decpt;
+        memcpy(out, digits, length);
+        out += length;
+    } else if (decpt < length) {
+        memcpy(out, digits, decpt);
+        out += decpt;
+        *out++ = '.';
+        memcpy(out, digits + decpt, length - decpt);
+        out += length - decpt;
+    } else {
+        memcpy(out, digits, length);
+        out += length;
+        memset(out, '0', decpt - length);
+        out += decpt - length;
+    }
+
+    json.append(buf, out - buf);
+}
+
+void Writer::appendInteger(QByteArray &json, qint64 i)
+{
+    char buf[24];
+    char *out = buf + sizeof(buf);
+    quint64 n = i < 0 ? 0 - quint64(i) : quint64(i);
+    do {
+        *--out = '0' + n % 10;
+        n /= 10;
+    } while (n);
+    if (i < 0)
+        *--out = '-';
+    json.append(out, buf + sizeof(buf) - out);
+}
+
+static void stringToJson(QAnyStringView s, QByteArray &json)
+{
+    json += '"';
+    Writer::appendEscaped(json, s);
+    json += '"';
 }
 
-static void valueToJson(const QCborValue &v, QByteArray &json, int indent, bool compact)
+static void valueToJson(const QCborContainerPrivate *c, qsizetype idx, QByteArray &json,
+                        int indent, bool compact)
 {
-    QCborValue::Type type = v.type();
-    switch (type) {
+    const QtCbor::Element &e = c->elements.at(idx);
+    switch (e.type) {
     case QCborValue::True:
         json += "true";
         break;
@@ -139,32 +316,25 @@ static void valueToJson(const QCborValue &v, QByteArray &json, int indent, bool
         json += "false";
         break;
     case QCborValue::Integer:
-        json += QByteArray::number(v.toInteger());
+        Writer::appendInteger(json, e.value);
         break;
-    case QCborValue::Double: {
-        const double d = v.toDouble();
-        if (qIsFinite(d))
-            json += QByteArray::number(d, 'g', QLocale::FloatingPointShortest);
-        else
-            json += "null"; // +INF || -INF || NaN (see RFC4627#section2.4)
+    case QCborValue::Double:
+        Writer::appendDouble(json, e.fpvalue());
         break;
-    }
     case QCborValue::String:
-        json += '"';
-        json += escapedString(v.toString());
-        json += '"';
+        stringToJson(Writer::stringAt(c, idx), json);
         break;
     case QCborValue::Array:
         json += compact ? "[" : "[\n";
-        arrayContentToJson(
-                QJsonPrivate::Value::container(v), json, indent + (compact ? 0 : 1), compact);
+        arrayContentToJson(e.flags & QtCbor::Element::IsContainer ? e.container : nullptr,
+                           json, indent + (compact ? 0 : 1), compact);
         json += QByteArray(4*indent, ' ');
         json += ']';
         break;
     case QCborValue::Map:
         json += compact ? "{" : "{\n";
-        objectContentToJson(
-                QJsonPrivate::Value::container(v), json, indent + (compact ? 0 : 1), compact);
+        objectContentToJson(e.flags & QtCbor::Element::IsContainer ? e.container : nullptr,
+                            json, indent + (compact ? 0 : 1), compact);
         json += QByteArray(4*indent, ' ');
         json += '}';
         break;
@@ -184,7 +354,7 @@ static void arrayContentToJson(const QCborContainerPrivate *a, QByteArray &json,
     qsizetype i = 0;
     while (true) {
         json += indentString;
-        valueToJson(a->valueAt(i), json, indent, compact);
+        valueToJson(a, i, json, indent, compact);
 
         if (++i == a->elements.size()) {
             if (!compact)
@@ -206,12 +376,13 @@ static void objectContentToJson(const QCborContainerPrivate *o, QByteArray &json
 
     qsizetype i = 0;
     while (true) {
-        QCborValue e = o->valueAt(i);
         json += indentString;
-        json += '"';
-        json += escapedString(o->valueAt(i).toString());
-        json += compact ? "\":" : "\": ";
-        valueToJson(o->valueAt(i + 1), json, indent, compact);
+        if (o->elements.at(i).type == QCborValue::String)
+            stringToJson(Writer::stringAt(o, i), json);
+        else
+            stringToJson(o->valueAt(i).toString(), json);
+        json += compact ? ":" : ": ";
+        valueToJson(o, i + 1, json, indent, compact);
 
         if ((i += 2) == o->elements.size()) {
             if (!compact)
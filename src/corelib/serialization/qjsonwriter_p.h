@@ -53,6 +53,7 @@
 
 #include <QtCore/private/qglobal_p.h>
 #include <qjsonvalue.h>
+#include <qstring.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -64,6 +65,11 @@ class Writer
 public:
     static void objectToJson(const QCborContainerPrivate *o, QByteArray &json, int indent, bool compact = false);
     static void arrayToJson(const QCborContainerPrivate *a, QByteArray &json, int indent, bool compact = false);
+
+    static QAnyStringView stringAt(const QCborContainerPrivate *c, qsizetype idx);
+    static void appendEscaped(QByteArray &json, QAnyStringView s);
+    static void appendDouble(QByteArray &json, double d);
+    static void appendInteger(QByteArray &json, qint64 i);
 };
 
 }
@@ -284,7 +284,7 @@ int qstricmp(const char *str1, const char *str2)
         return int(Incomplete);
     };
 
-#if defined(__SSE4_1__) && !(defined(__SANITIZE_ADDRESS__) || __has_feature(address_sanitizer))
+#if defined(__SSE2__) && !(defined(__SANITIZE_ADDRESS__) || __has_feature(address_sanitizer))
     enum { PageSize = 4096, PageMask = PageSize - 1 };
     const __m128i zero = _mm_setzero_si128();
     forever {
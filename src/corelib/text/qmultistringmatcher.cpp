@@ -0,0 +1,908 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qmultistringmatcher.h"
+
+#include <QtCore/qvarlengtharray.h>
+#include <private/qsimd_p.h>
+
+#include <algorithm>
+#include <array>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    Both matchers compile their patterns into an Aho-Corasick automaton,
+    turned into a DFA so that scanning costs one table lookup per code unit,
+    whatever the number of patterns.
+
+    The input alphabet is reduced to the code units that appear in the
+    (case folded) patterns: each gets a class number, all other code units
+    share class 0. The class of a code unit is found through a two-level
+    table with one page of 256 entries per high byte in use. For case
+    insensitive matching, the table also maps every code unit to the class
+    of its case folded form, so that the text never needs to be folded
+    while scanning.
+
+    As long as the automaton is in its initial state, no partial match is
+    in progress and the text can be skipped quickly up to the next position
+    where a pattern may start. This is done with SSSE3 by looking up the
+    nibbles of two consecutive code units in small tables (the "shufti" and
+    "Teddy" techniques): the states reached after one code unit are spread
+    over 8 buckets, and a candidate position is one where both units may
+    belong to the same bucket. Candidates are then verified by the automaton.
+    The prefilter is not used when the patterns would make most positions
+    candidates, and backs off when it keeps stopping early on a given text.
+*/
+
+class QMultiPatternMatcherPrivate : public QSharedData
+{
+public:
+    enum Encoding {
+        Latin1,
+        Utf16
+    };
+
+    QMultiPatternMatcherPrivate(Encoding encoding, Qt::CaseSensitivity cs)
+        : encoding(encoding), cs(cs)
+    {}
+
+    void compile(const QList<QString> &foldedPatterns);
+
+    quint16 classOf(char16_t unit) const
+    { return classTable[qsizetype(pageIndex[unit >> 8]) * 256 + (unit & 0xff)]; }
+
+    template <typename Char, typename Callback>
+    void scan(const Char *str, qsizetype from, qsizetype &end, Callback callback) const;
+    template <typename Char>
+    qsizetype indexIn(const Char *str, qsizetype size, qsizetype from,
+                      qsizetype *patternIndex) const;
+    template <typename Match, typename Char>
+    QList<Match> matchesIn(const Char *str, qsizetype size, qsizetype from) const;
+
+    const Encoding encoding;
+    const Qt::CaseSensitivity cs;
+    QStringList stringPatterns;
+    QByteArrayList byteArrayPatterns;
+
+    // automaton
+    QList<quint16> classTable;
+    quint8 pageIndex[256] = {};
+    qsizetype classCount = 1;
+    QList<qint32> delta;        // state * classCount + class -> state
+    QList<qint32> matchState;   // the state itself or its closest suffix with patterns, or -1
+    QList<qint32> firstPattern; // per state: the first pattern ending there, or -1
+    QList<qint32> outputLink;   // per state: the closest proper suffix with patterns, or -1
+    QList<qint32> nextPattern;  // per pattern: the next identical pattern, or -1
+    QList<qsizetype> patternLengths;
+    qsizetype maxPatternLength = 0;
+    bool foldSurrogatePairs = false;
+
+    // prefilter: nibble tables for the first and second code unit
+    bool usePrefilter = false;
+    alignas(16) uchar firstLow[16] = {};
+    alignas(16) uchar firstHigh[16] = {};
+    alignas(16) uchar secondLow[16] = {};
+    alignas(16) uchar secondHigh[16] = {};
+};
+
+QT_DEFINE_QESDP_SPECIALIZATION_DTOR(QMultiPatternMatcherPrivate)
+
+static inline char16_t latin1Fold(char16_t ch)
+{
+    const char32_t folded = QChar::toCaseFolded(char32_t(ch));
+    return folded <= 0xff ? char16_t(folded) : ch;
+}
+
+// Simple case folding keeps code points in the same plane, so the folded
+// string has the same length in code units as the original one.
+static QString utf16Fold(QStringView str)
+{
+    QString result(str.size(), Qt::Uninitialized);
+    char16_t *out = reinterpret_cast<char16_t *>(result.data());
+    const char16_t *in = str.utf16();
+    for (qsizetype i = 0; i < str.size(); ++i) {
+        if (QChar::isHighSurrogate(in[i]) && i + 1 < str.size() && QChar::isLowSurrogate(in[i + 1])) {
+            const char32_t folded = QChar::toCaseFolded(QChar::surrogateToUcs4(in[i], in[i + 1]));
+            *out++ = QChar::highSurrogate(folded);
+            *out++ = QChar::lowSurrogate(folded);
+            ++i;
+        } else {
+            *out++ = char16_t(QChar::toCaseFolded(char32_t(in[i])));
+        }
+    }
+    return result;
+}
+
+/*!
+    \internal
+
+    Builds the automaton for \a foldedPatterns, which are the patterns already
+    case folded (if needed) and, for the byte array matcher, widened to
+    UTF-16. Empty patterns are ignored.
+*/
+void QMultiPatternMatcherPrivate::compile(const QList<QString> &foldedPatterns)
+{
+    // the alphabet; page 0 of the class table is all zeroes
+    classTable.fill(0, 256);
+    auto setClass = [this](char16_t unit, quint16 cls) {
+        quint8 &page = pageIndex[unit >> 8];
+        if (!page) {
+            page = quint8(classTable.size() / 256);
+            classTable.resize(classTable.size() + 256);
+        }
+        classTable[qsizetype(page) * 256 + (unit & 0xff)] = cls;
+    };
+
+    qsizetype totalLength = 0;
+    for (const QString &pattern : foldedPatterns) {
+        totalLength += pattern.size();
+        for (QChar ch : pattern) {
+            if (!classOf(ch.unicode()))
+                setClass(ch.unicode(), quint16(classCount++));
+            if (cs == Qt::CaseInsensitive && ch.isSurrogate())
+                foldSurrogatePairs = true;
+        }
+    }
+
+    // Case folding is idempotent, so the code units appearing in the
+    // patterns are never remapped here.
+    if (cs == Qt::CaseInsensitive) {
+        const char32_t last = encoding == Latin1 ? 0xff : 0xffff;
+        for (char32_t unit = 0; unit <= last; ++unit) {
+            if (QChar::isSurrogate(unit))
+                continue;
+            const char16_t folded = encoding == Latin1 ? latin1Fold(char16_t(unit))
+                                                       : char16_t(QChar::toCaseFolded(unit));
+            if (folded == unit)
+                continue;
+            if (const quint16 cls = classOf(folded))
+                setClass(char16_t(unit), cls);
+        }
+    }
+
+    // the trie; rows hold the goto function (-1 for none) until completed
+    const qsizetype nc = classCount;
+    delta.fill(-1, (totalLength + 1) * nc);
+    firstPattern.fill(-1, totalLength + 1);
+    QList<qsizetype> depth(totalLength + 1, 0);
+    nextPattern.fill(-1, foldedPatterns.size());
+    patternLengths.resize(foldedPatterns.size());
+    qint32 stateCount = 1;
+
+    // insert in reverse, so that identical patterns are chained in order
+    for (qsizetype i = foldedPatterns.size() - 1; i >= 0; --i) {
+        const QString &pattern = foldedPatterns.at(i);
+        patternLengths[i] = pattern.size();
+        if (pattern.isEmpty())
+            continue;
+        maxPatternLength = qMax(maxPatternLength, pattern.size());
+        qint32 state = 0;
+        for (QChar ch : pattern) {
+            qint32 &next = delta[state * nc + classOf(ch.unicode())];
+            if (next < 0) {
+                next = stateCount++;
+                depth[next] = depth[state] + 1;
+            }
+            state = next;
+        }
+        nextPattern[i] = firstPattern[state];
+        firstPattern[state] = qint32(i);
+    }
+
+    delta.resize(stateCount * nc);
+    firstPattern.resize(stateCount);
+    outputLink.fill(-1, stateCount);
+    matchState.fill(-1, stateCount);
+
+    // failure links, breadth first; a state's row is completed with the
+    // transitions of its failure state, whose row is already complete
+    QList<qint32> failure(stateCount, 0);
+    QList<qint32> queue;
+    queue.reserve(stateCount);
+    for (qsizetype c = 0; c < nc; ++c) {
+        qint32 &next = delta[c];
+        if (next < 0)
+            next = 0;
+        else
+            queue.append(next);
+    }
+    for (qsizetype head = 0; head < queue.size(); ++head) {
+        const qint32 state = queue.at(head);
+        const qint32 *failureRow = delta.constData() + failure.at(state) * nc;
+        qint32 *row = delta.data() + state * nc;
+        for (qsizetype c = 0; c < nc; ++c) {
+            if (row[c] < 0) {
+                row[c] = failureRow[c];
+                continue;
+            }
+            const qint32 child = row[c];
+            const qint32 f = failureRow[c];
+            failure[child] = f;
+            outputLink[child] = firstPattern.at(f) >= 0 ? f : outputLink.at(f);
+            queue.append(child);
+        }
+    }
+    for (qint32 state = 0; state < stateCount; ++state)
+        matchState[state] = firstPattern.at(state) >= 0 ? state : outputLink.at(state);
+
+    // The prefilter works on bytes: UTF-16 code units are saturated to
+    // 0xff, so that byte stands for all of the units from U+00FF up.
+    auto forEachUnit = [this](auto function) {
+        const char16_t lastPage = encoding == Latin1 ? 0 : 0xff;
+        for (char16_t page = 0; page <= lastPage; ++page) {
+            if (!pageIndex[page])
+                continue;
+            for (char16_t low = 0; low < 256; ++low) {
+                const char16_t unit = char16_t(page << 8 | low);
+                if (const quint16 cls = classOf(unit))
+                    function(qMin(unit, char16_t(0xff)), cls);
+            }
+        }
+    };
+    QVarLengthArray<qint8, 64> bucketOfState(stateCount);
+    std::fill(bucketOfState.begin(), bucketOfState.end(), -1);
+    int bucketCount = 0;
+    forEachUnit([&](uchar byte, quint16 cls) {
+        const qint32 state = delta.at(cls);
+        if (!state)
+            return;
+        if (bucketOfState[state] < 0)
+            bucketOfState[state] = qint8(bucketCount++ % 8);
+        const uchar bit = uchar(1 << bucketOfState[state]);
+        firstLow[byte & 0xf] |= bit;
+        firstHigh[byte >> 4] |= bit;
+    });
+    for (qint32 state = 1; state < stateCount; ++state) {
+        if (bucketOfState[state] < 0)
+            continue;
+        const uchar bit = uchar(1 << bucketOfState[state]);
+        if (firstPattern.at(state) >= 0) {
+            // a single unit pattern: any second unit will do
+            for (uchar &b : secondLow)
+                b |= bit;
+            for (uchar &b : secondHigh)
+                b |= bit;
+            continue;
+        }
+        forEachUnit([&](uchar byte, quint16 cls) {
+            if (depth.at(delta.at(state * nc + cls)) == 2) {
+                secondLow[byte & 0xf] |= bit;
+                secondHigh[byte >> 4] |= bit;
+            }
+        });
+    }
+    // Not worth it if most pairs of the code units used by the patterns
+    // would be candidates: text similar to the patterns would hardly be
+    // skipped.
+    std::array<bool, 256> alphabet = {};
+    forEachUnit([&](uchar byte, quint16) { alphabet[byte] = true; });
+    qsizetype pairs = 0;
+    qsizetype candidates = 0;
+    for (int b1 = 0; b1 < 256; ++b1) {
+        if (!alphabet[b1])
+            continue;
+        const uchar first = firstLow[b1 & 0xf] & firstHigh[b1 >> 4];
+        for (int b2 = 0; b2 < 256; ++b2) {
+            if (!alphabet[b2])
+                continue;
+            ++pairs;
+            if (first & secondLow[b2 & 0xf] & secondHigh[b2 >> 4])
+                ++candidates;
+        }
+    }
+    usePrefilter = bucketCount && candidates * 4 <= pairs;
+}
+
+#if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+QT_FUNCTION_TARGET(SSSE3)
+static inline __m128i prefilterCandidates(__m128i first, __m128i second,
+                                          const QMultiPatternMatcherPrivate *d)
+{
+    const __m128i nibbleMask = _mm_set1_epi8(0xf);
+    const __m128i firstLow = _mm_load_si128(reinterpret_cast<const __m128i *>(d->firstLow));
+    const __m128i firstHigh = _mm_load_si128(reinterpret_cast<const __m128i *>(d->firstHigh));
+    const __m128i secondLow = _mm_load_si128(reinterpret_cast<const __m128i *>(d->secondLow));
+    const __m128i secondHigh = _mm_load_si128(reinterpret_cast<const __m128i *>(d->secondHigh));
+
+    __m128i m1 = _mm_and_si128(_mm_shuffle_epi8(firstLow, _mm_and_si128(first, nibbleMask)),
+                               _mm_shuffle_epi8(firstHigh, _mm_and_si128(_mm_srli_epi16(first, 4), nibbleMask)));
+    __m128i m2 = _mm_and_si128(_mm_shuffle_epi8(secondLow, _mm_and_si128(second, nibbleMask)),
+                               _mm_shuffle_epi8(secondHigh, _mm_and_si128(_mm_srli_epi16(second, 4), nibbleMask)));
+    return _mm_cmpeq_epi8(_mm_and_si128(m1, m2), _mm_setzero_si128());
+}
+
+// Returns the first position from \a i where a pattern may start, or the
+// position where the remaining data became too short to check.
+QT_FUNCTION_TARGET(SSSE3)
+static qsizetype prefilter_ssse3(const uchar *str, qsizetype i, qsizetype end,
+                                 const QMultiPatternMatcherPrivate *d)
+{
+    for ( ; i + 17 <= end; i += 16) {
+        const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i));
+        const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i + 1));
+        const uint mask = ~uint(_mm_movemask_epi8(prefilterCandidates(first, second, d))) & 0xffff;
+        if (mask)
+            return i + qCountTrailingZeroBits(mask);
+    }
+    return i;
+}
+
+QT_FUNCTION_TARGET(SSSE3)
+static qsizetype prefilter_ssse3(const char16_t *str, qsizetype i, qsizetype end,
+                                 const QMultiPatternMatcherPrivate *d)
+{
+    // min(unit, 0xff) for each unit, then narrowed to bytes
+    const __m128i maxByte = _mm_set1_epi16(0xff);
+    auto load = [&](const char16_t *p) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 8));
+        return _mm_packus_epi16(_mm_sub_epi16(lo, _mm_subs_epu16(lo, maxByte)),
+                                _mm_sub_epi16(hi, _mm_subs_epu16(hi, maxByte)));
+    };
+    for ( ; i + 17 <= end; i += 16) {
+        const __m128i first = load(str + i);
+        const __m128i second = load(str + i + 1);
+        const uint mask = ~uint(_mm_movemask_epi8(prefilterCandidates(first, second, d))) & 0xffff;
+        if (mask)
+            return i + qCountTrailingZeroBits(mask);
+    }
+    return i;
+}
+#endif
+
+/*!
+    \internal
+
+    Runs the automaton over \a str from \a from up to \a end, calling
+    \a callback with the start, the length and the index of each pattern
+    found, ordered by their end position and then from the longest. The
+    scan stops when the callback returns \c false; the callback may also
+    lower \a end.
+*/
+template <typename Char, typename Callback>
+void QMultiPatternMatcherPrivate::scan(const Char *str, qsizetype from, qsizetype &end,
+                                       Callback callback) const
+{
+    const qint32 *const table = delta.constData();
+    const qint32 *const matches = matchState.constData();
+    const qsizetype nc = classCount;
+
+#if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+    const bool prefilter = usePrefilter && qCpuHasFeature(SSSE3);
+    // when the prefilter finds candidates too close to each other, leave it
+    // alone for a while, backing off further each time
+    qsizetype prefilterFrom = from;
+    qsizetype prefilterBackoff = 0;
+#endif
+
+    qint32 state = 0;
+    for (qsizetype i = from; i < end; ) {
+#if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+        if (state == 0 && prefilter && i >= prefilterFrom && i + 17 <= end) {
+            const qsizetype next = prefilter_ssse3(str, i, end, this);
+            if (next - i < 16) {
+                prefilterBackoff = qMin(2 * prefilterBackoff + 16, qsizetype(4096));
+                prefilterFrom = next + prefilterBackoff;
+            } else {
+                prefilterBackoff = 0;
+            }
+            i = next;
+        }
+#endif
+        state = table[state * nc + classOf(str[i])];
+        ++i;
+        if (Q_UNLIKELY(matches[state] >= 0)) {
+            for (qint32 s = matches[state]; s >= 0; s = outputLink.at(s)) {
+                for (qint32 p = firstPattern.at(s); p >= 0; p = nextPattern.at(p)) {
+                    const qsizetype length = patternLengths.at(p);
+                    if (!callback(i - length, length, qsizetype(p)))
+                        return;
+                }
+            }
+        }
+    }
+}
+
+template <typename Char>
+qsizetype QMultiPatternMatcherPrivate::indexIn(const Char *str, qsizetype size, qsizetype from,
+                                               qsizetype *patternIndex) const
+{
+    qsizetype bestPosition = -1;
+    qsizetype bestLength = 0;
+    qsizetype bestPattern = -1;
+    qsizetype end = size;
+    // Matches are found in order of their end, so keep going as long as a
+    // match starting before the best one so far, or a longer match starting
+    // at the same position, can still be found.
+    scan(str, from, end, [&](qsizetype position, qsizetype length, qsizetype pattern) {
+        if (bestPosition < 0 || position < bestPosition
+                || (position == bestPosition && length > bestLength)) {
+            bestPosition = position;
+            bestLength = length;
+            bestPattern = pattern;
+            end = qMin(size, bestPosition + maxPatternLength);
+        }
+        return true;
+    });
+    if (patternIndex)
+        *patternIndex = bestPattern;
+    return bestPosition;
+}
+
+template <typename Match, typename Char>
+QList<Match> QMultiPatternMatcherPrivate::matchesIn(const Char *str, qsizetype size,
+                                                    qsizetype from) const
+{
+    QList<Match> result;
+    qsizetype end = size;
+    scan(str, from, end, [&](qsizetype position, qsizetype length, qsizetype pattern) {
+        result.append({ position, length, pattern });
+        return true;
+    });
+    return result;
+}
+
+/*!
+    \class QMultiStringMatcher
+    \inmodule QtCore
+    \since 6.2
+    \brief The QMultiStringMatcher class holds a set of strings that can be
+    searched for at once in a Unicode string.
+
+    \ingroup tools
+    \ingroup shared
+    \ingroup string-processing
+
+    Searching a text for several strings with QStringMatcher or
+    QString::indexOf() takes one pass over the text per string.
+    QMultiStringMatcher compiles all the patterns into a single automaton
+    (following the Aho-Corasick algorithm), which finds the occurrences of
+    all of them in one pass. The time taken by a search grows with the
+    length of the text, but not with the number of patterns. This makes
+    the class suitable for filtering large amounts of text against many
+    keywords.
+
+    Create the matcher with the list of patterns, then call indexIn() to
+    find the first occurrence of any of them, or matchesIn() to find all
+    the occurrences.
+
+    \snippet code/src_corelib_text_qmultistringmatcher.cpp 0
+
+    Matching can be case insensitive, in which case the patterns and the
+    text are compared after case folding (see QChar::toCaseFolded()).
+
+    Compiling the patterns takes time and memory proportional to their
+    total length and to the number of distinct characters in them, so a
+    matcher is best created once and reused. Copies of a matcher share the
+    compiled patterns.
+
+    Empty patterns never match.
+
+    \sa QStringMatcher, QMultiByteArrayMatcher, QRegularExpression
+*/
+
+/*!
+    \class QMultiByteArrayMatcher
+    \inmodule QtCore
+    \since 6.2
+    \brief The QMultiByteArrayMatcher class holds a set of byte arrays that
+    can be searched for at once in a byte array.
+
+    \ingroup tools
+    \ingroup shared
+    \ingroup string-processing
+
+    This class is the byte array equivalent of QMultiStringMatcher: it
+    compiles a list of patterns so that the occurrences of all of them can
+    be found in one pass over the data.
+
+    Case insensitive matching treats the data and the patterns as Latin-1.
+
+    \sa QByteArrayMatcher, QMultiStringMatcher
+*/
+
+/*!
+    \class QMultiStringMatcher::Match
+    \inmodule QtCore
+    \since 6.2
+    \brief Describes an occurrence of a pattern found by QMultiStringMatcher.
+
+    \sa QMultiStringMatcher::matchesIn()
+*/
+
+/*!
+    \variable QMultiStringMatcher::Match::position
+
+    The position of the first character of the occurrence.
+*/
+
+/*!
+    \variable QMultiStringMatcher::Match::length
+
+    The length of the occurrence, which is the length of the pattern.
+*/
+
+/*!
+    \variable QMultiStringMatcher::Match::patternIndex
+
+    The index of the pattern found in the list of patterns.
+*/
+
+/*!
+    \class QMultiByteArrayMatcher::Match
+    \inmodule QtCore
+    \since 6.2
+    \brief Describes an occurrence of a pattern found by QMultiByteArrayMatcher.
+
+    See QMultiStringMatcher::Match for the description of the members.
+
+    \sa QMultiByteArrayMatcher::matchesIn()
+*/
+
+static QMultiPatternMatcherPrivate *compiledStringMatcher(const QStringList &patterns,
+                                                          Qt::CaseSensitivity cs)
+{
+    auto d = new QMultiPatternMatcherPrivate(QMultiPatternMatcherPrivate::Utf16, cs);
+    d->stringPatterns = patterns;
+    if (cs == Qt::CaseSensitive) {
+        d->compile(patterns);
+    } else {
+        QList<QString> folded;
+        folded.reserve(patterns.size());
+        for (const QString &pattern : patterns)
+            folded.append(utf16Fold(pattern));
+        d->compile(folded);
+    }
+    return d;
+}
+
+static QMultiPatternMatcherPrivate *compiledByteArrayMatcher(const QByteArrayList &patterns,
+                                                             Qt::CaseSensitivity cs)
+{
+    auto d = new QMultiPatternMatcherPrivate(QMultiPatternMatcherPrivate::Latin1, cs);
+    d->byteArrayPatterns = patterns;
+    QList<QString> widened;
+    widened.reserve(patterns.size());
+    for (const QByteArray &pattern : patterns) {
+        QString str = QString::fromLatin1(pattern);
+        if (cs == Qt::CaseInsensitive) {
+            for (QChar &ch : str)
+                ch = QChar(latin1Fold(ch.unicode()));
+        }
+        widened.append(str);
+    }
+    d->compile(widened);
+    return d;
+}
+
+/*!
+    Constructs an empty matcher that won't match anything. Call
+    setPatterns() to give it patterns to match.
+*/
+QMultiStringMatcher::QMultiStringMatcher() noexcept
+    = default;
+
+/*!
+    Constructs a matcher that will search for the strings in \a patterns,
+    with case sensitivity \a cs.
+*/
+QMultiStringMatcher::QMultiStringMatcher(const QStringList &patterns, Qt::CaseSensitivity cs)
+    : d(compiledStringMatcher(patterns, cs))
+{
+}
+
+/*!
+    \fn QMultiStringMatcher::QMultiStringMatcher(QMultiStringMatcher &&other)
+
+    Move-constructs a matcher from \a other.
+*/
+
+/*!
+    Constructs a copy of \a other. The compiled patterns are shared.
+*/
+QMultiStringMatcher::QMultiStringMatcher(const QMultiStringMatcher &other)
+    = default;
+
+/*!
+    Destroys the matcher.
+*/
+QMultiStringMatcher::~QMultiStringMatcher()
+    = default;
+
+/*!
+    Assigns \a other to this matcher and returns a reference to this
+    matcher.
+*/
+QMultiStringMatcher &QMultiStringMatcher::operator=(const QMultiStringMatcher &other)
+    = default;
+
+/*!
+    \fn QMultiStringMatcher &QMultiStringMatcher::operator=(QMultiStringMatcher &&other)
+
+    Move-assigns \a other to this matcher.
+*/
+
+/*!
+    \fn void QMultiStringMatcher::swap(QMultiStringMatcher &other)
+
+    Swaps this matcher with \a other. This operation is very fast and never
+    fails.
+*/
+
+/*!
+    Sets the strings that this matcher will search for to \a patterns, and
+    compiles them.
+
+    \sa patterns(), setCaseSensitivity()
+*/
+void QMultiStringMatcher::setPatterns(const QStringList &patterns)
+{
+    d.reset(compiledStringMatcher(patterns, caseSensitivity()));
+}
+
+/*!
+    Returns the strings that this matcher searches for.
+
+    \sa setPatterns()
+*/
+QStringList QMultiStringMatcher::patterns() const
+{
+    return d ? d->stringPatterns : QStringList();
+}
+
+/*!
+    Sets the case sensitivity of this matcher to \a cs, and compiles the
+    patterns again if it changed.
+
+    \sa caseSensitivity()
+*/
+void QMultiStringMatcher::setCaseSensitivity(Qt::CaseSensitivity cs)
+{
+    if (cs != caseSensitivity())
+        d.reset(compiledStringMatcher(patterns(), cs));
+}
+
+/*!
+    Returns the case sensitivity of this matcher.
+
+    \sa setCaseSensitivity()
+*/
+Qt::CaseSensitivity QMultiStringMatcher::caseSensitivity() const
+{
+    return d ? d->cs : Qt::CaseSensitive;
+}
+
+/*!
+    Searches the string \a str from position \a from (default 0, i.e. from
+    the first character) for any of the patterns. Returns the position of
+    the first occurrence, or -1 if none of the patterns was found.
+
+    If several patterns occur at that position, the longest one is
+    reported. If \a patternIndex is not \nullptr, it is set to the index of
+    that pattern in patterns(), or to -1 if there is no match.
+
+    \sa matchesIn()
+*/
+qsizetype QMultiStringMatcher::indexIn(QStringView str, qsizetype from,
+                                       qsizetype *patternIndex) const
+{
+    if (from < 0)
+        from = 0;
+    if (!d || from >= str.size()) {
+        if (patternIndex)
+            *patternIndex = -1;
+        return -1;
+    }
+    QString folded;
+    if (Q_UNLIKELY(d->foldSurrogatePairs)) {
+        folded = utf16Fold(str);
+        str = folded;
+    }
+    return d->indexIn(str.utf16(), str.size(), from, patternIndex);
+}
+
+/*!
+    Searches the string \a str from position \a from (default 0, i.e. from
+    the first character) for all the occurrences of the patterns, in one
+    pass. Returns the list of occurrences, ordered by their end position;
+    occurrences ending at the same position are ordered from the longest.
+    Overlapping occurrences are all reported.
+
+    \sa indexIn()
+*/
+QList<QMultiStringMatcher::Match> QMultiStringMatcher::matchesIn(QStringView str,
+                                                                 qsizetype from) const
+{
+    if (from < 0)
+        from = 0;
+    if (!d || from >= str.size())
+        return {};
+    QString folded;
+    if (Q_UNLIKELY(d->foldSurrogatePairs)) {
+        folded = utf16Fold(str);
+        str = folded;
+    }
+    return d->matchesIn<Match>(str.utf16(), str.size(), from);
+}
+
+/*!
+    Constructs an empty matcher that won't match anything. Call
+    setPatterns() to give it patterns to match.
+*/
+QMultiByteArrayMatcher::QMultiByteArrayMatcher() noexcept
+    = default;
+
+/*!
+    Constructs a matcher that will search for the byte arrays in
+    \a patterns, with case sensitivity \a cs.
+*/
+QMultiByteArrayMatcher::QMultiByteArrayMatcher(const QByteArrayList &patterns,
+                                               Qt::CaseSensitivity cs)
+    : d(compiledByteArrayMatcher(patterns, cs))
+{
+}
+
+/*!
+    \fn QMultiByteArrayMatcher::QMultiByteArrayMatcher(QMultiByteArrayMatcher &&other)
+
+    Move-constructs a matcher from \a other.
+*/
+
+/*!
+    Constructs a copy of \a other. The compiled patterns are shared.
+*/
+QMultiByteArrayMatcher::QMultiByteArrayMatcher(const QMultiByteArrayMatcher &other)
+    = default;
+
+/*!
+    Destroys the matcher.
+*/
+QMultiByteArrayMatcher::~QMultiByteArrayMatcher()
+    = default;
+
+/*!
+    Assigns \a other to this matcher and returns a reference to this
+    matcher.
+*/
+QMultiByteArrayMatcher &QMultiByteArrayMatcher::operator=(const QMultiByteArrayMatcher &other)
+    = default;
+
+/*!
+    \fn QMultiByteArrayMatcher &QMultiByteArrayMatcher::operator=(QMultiByteArrayMatcher &&other)
+
+    Move-assigns \a other to this matcher.
+*/
+
+/*!
+    \fn void QMultiByteArrayMatcher::swap(QMultiByteArrayMatcher &other)
+
+    Swaps this matcher with \a other. This operation is very fast and never
+    fails.
+*/
+
+/*!
+    Sets the byte arrays that this matcher will search for to \a patterns,
+    and compiles them.
+
+    \sa patterns(), setCaseSensitivity()
+*/
+void QMultiByteArrayMatcher::setPatterns(const QByteArrayList &patterns)
+{
+    d.reset(compiledByteArrayMatcher(patterns, caseSensitivity()));
+}
+
+/*!
+    Returns the byte arrays that this matcher searches for.
+
+    \sa setPatterns()
+*/
+QByteArrayList QMultiByteArrayMatcher::patterns() const
+{
+    return d ? d->byteArrayPatterns : QByteArrayList();
+}
+
+/*!
+    Sets the case sensitivity of this matcher to \a cs, and compiles the
+    patterns again if it changed. Case insensitive matching treats the
+    data as Latin-1.
+
+    \sa caseSensitivity()
+*/
+void QMultiByteArrayMatcher::setCaseSensitivity(Qt::CaseSensitivity cs)
+{
+    if (cs != caseSensitivity())
+        d.reset(compiledByteArrayMatcher(patterns(), cs));
+}
+
+/*!
+    Returns the case sensitivity of this matcher.
+
+    \sa setCaseSensitivity()
+*/
+Qt::CaseSensitivity QMultiByteArrayMatcher::caseSensitivity() const
+{
+    return d ? d->cs : Qt::CaseSensitive;
+}
+
+/*!
+    Searches \a data from position \a from (default 0, i.e. from the first
+    byte) for any of the patterns. Returns the position of the first
+    occurrence, or -1 if none of the patterns was found.
+
+    If several patterns occur at that position, the longest one is
+    reported. If \a patternIndex is not \nullptr, it is set to the index of
+    that pattern in patterns(), or to -1 if there is no match.
+
+    \sa matchesIn()
+*/
+qsizetype QMultiByteArrayMatcher::indexIn(QByteArrayView data, qsizetype from,
+                                          qsizetype *patternIndex) const
+{
+    if (from < 0)
+        from = 0;
+    if (!d || from >= data.size()) {
+        if (patternIndex)
+            *patternIndex = -1;
+        return -1;
+    }
+    return d->indexIn(reinterpret_cast<const uchar *>(data.data()), data.size(), from,
+                      patternIndex);
+}
+
+/*!
+    Searches \a data from position \a from (default 0, i.e. from the first
+    byte) for all the occurrences of the patterns, in one pass. Returns the
+    list of occurrences, ordered by their end position; occurrences ending
+    at the same position are ordered from the longest. Overlapping
+    occurrences are all reported.
+
+    \sa indexIn()
+*/
+QList<QMultiByteArrayMatcher::Match> QMultiByteArrayMatcher::matchesIn(QByteArrayView data,
+                                                                       qsizetype from) const
+{
+    if (from < 0)
+        from = 0;
+    if (!d || from >= data.size())
+        return {};
+    return d->matchesIn<Match>(reinterpret_cast<const uchar *>(data.data()), data.size(), from);
+}
+
+QT_END_NAMESPACE
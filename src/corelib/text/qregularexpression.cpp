@@ -52,6 +52,8 @@
 #include <QtCore/qatomic.h>
 #include <QtCore/qdatastream.h>
 
+#include <private/qstringconverter_p.h>
+
 #define PCRE2_CODE_UNIT_WIDTH 16
 
 #include <pcre2.h>
@@ -739,6 +741,8 @@ struct QRegularExpressionPrivate : QSharedData
 
     void cleanCompiledPattern();
     void compilePattern();
+    void compilePatternUtf8();
+    void compilePatternWithLockHeld();
     void getPatternInfo();
     void optimizePattern();
 
@@ -751,6 +755,7 @@ struct QRegularExpressionPrivate : QSharedData
                  qsizetype offset,
                  CheckSubjectStringOption checkSubjectStringOption = CheckSubjectString,
                  const QRegularExpressionMatchPrivate *previous = nullptr) const;
+    void doMatchUtf8(QRegularExpressionMatchPrivate *priv, qsizetype offset) const;
 
     int captureIndexForName(QStringView name) const;
 
@@ -767,6 +772,9 @@ struct QRegularExpressionPrivate : QSharedData
     // objects themselves; when the private is copied (i.e. a detach happened)
     // it is set to nullptr
     pcre2_code_16 *compiledPattern;
+    // The same pattern compiled for the 8-bit library, used for matching
+    // UTF-8 subjects. It is only created on the first such match.
+    pcre2_code_8 *compiledPatternUtf8;
     int errorCode;
     qsizetype errorOffset;
     int capturingCount;
@@ -781,6 +789,10 @@ struct QRegularExpressionMatchPrivate : QSharedData
                                    QStringView subject,
                                    QRegularExpression::MatchType matchType,
                                    QRegularExpression::MatchOptions matchOptions);
+    QRegularExpressionMatchPrivate(const QRegularExpression &re,
+                                   QByteArrayView subjectUtf8,
+                                   QRegularExpression::MatchType matchType,
+                                   QRegularExpression::MatchOptions matchOptions);
 
     QRegularExpressionMatch nextMatch() const;
 
@@ -792,6 +804,11 @@ struct QRegularExpressionMatchPrivate : QSharedData
     const QString subjectStorage;
     const QStringView subject;
 
+    // if we've been asked to match over UTF-8 data, subjectUtf8 views it
+    // (subject is then empty) and all the offsets are byte offsets into it
+    const QByteArrayView subjectUtf8;
+    const bool isUtf8Subject = false;
+
     const QRegularExpression::MatchType matchType;
     const QRegularExpression::MatchOptions matchOptions;
 
@@ -837,6 +854,7 @@ QRegularExpressionPrivate::QRegularExpressionPrivate()
       pattern(),
       mutex(),
       compiledPattern(nullptr),
+      compiledPatternUtf8(nullptr),
       errorCode(0),
       errorOffset(-1),
       capturingCount(0),
@@ -857,7 +875,7 @@ QRegularExpressionPrivate::~QRegularExpressionPrivate()
     \internal
 
     Copies the private, which means copying only the pattern and the pattern
-    options. The compiledPattern pointer is NOT copied (we
+    options. The compiledPattern pointers are NOT copied (we
     do not own it any more), and in general all the members set when
     compiling a pattern are set to default values. isDirty is set back to true
     so that the pattern has to be recompiled again.
@@ -868,6 +886,7 @@ QRegularExpressionPrivate::QRegularExpressionPrivate(const QRegularExpressionPri
       pattern(other.pattern),
       mutex(),
       compiledPattern(nullptr),
+      compiledPatternUtf8(nullptr),
       errorCode(0),
       errorOffset(-1),
       capturingCount(0),
@@ -883,6 +902,10 @@ void QRegularExpressionPrivate::cleanCompiledPattern()
 {
     pcre2_code_free_16(compiledPattern);
     compiledPattern = nullptr;
+#ifndef QT_BOOTSTRAPPED
+    pcre2_code_free_8(compiledPatternUtf8);
+#endif
+    compiledPatternUtf8 = nullptr;
     errorCode = 0;
     errorOffset = -1;
     capturingCount = 0;
@@ -895,7 +918,14 @@ void QRegularExpressionPrivate::cleanCompiledPattern()
 void QRegularExpressionPrivate::compilePattern()
 {
     const QMutexLocker lock(&mutex);
+    compilePatternWithLockHeld();
+}
 
+/*!
+    \internal
+*/
+void QRegularExpressionPrivate::compilePatternWithLockHeld()
+{
     if (!isDirty)
         return;
 
@@ -955,7 +985,8 @@ void QRegularExpressionPrivate::getPatternInfo()
 
 
 /*
-    Simple "smartpointer" wrapper around a pcre2_jit_stack_16, to be used with
+    Simple "smartpointer" wrapper around a pcre2_jit_stack_16 and the
+    pcre2_jit_stack_8 used when matching UTF-8 subjects, to be used with
     QThreadStorage.
 */
 class QPcreJitStackPointer
@@ -971,6 +1002,9 @@ public:
         // The default JIT stack size in PCRE is 32K,
         // we allocate from 32K up to 512K.
         stack = pcre2_jit_stack_create_16(32 * 1024, 512 * 1024, nullptr);
+#ifndef QT_BOOTSTRAPPED
+        stackUtf8 = pcre2_jit_stack_create_8(32 * 1024, 512 * 1024, nullptr);
+#endif
     }
     /*!
         \internal
@@ -979,9 +1013,14 @@ public:
     {
         if (stack)
             pcre2_jit_stack_free_16(stack);
+#ifndef QT_BOOTSTRAPPED
+        if (stackUtf8)
+            pcre2_jit_stack_free_8(stackUtf8);
+#endif
     }
 
     pcre2_jit_stack_16 *stack;
+    pcre2_jit_stack_8 *stackUtf8 = nullptr;
 };
 
 Q_GLOBAL_STATIC(QThreadStorage<QPcreJitStackPointer *>, jitStacks)
@@ -997,6 +1036,19 @@ static pcre2_jit_stack_16 *qtPcreCallback(void *)
     return nullptr;
 }
 
+#ifndef QT_BOOTSTRAPPED
+/*!
+    \internal
+*/
+static pcre2_jit_stack_8 *qtPcreCallbackUtf8(void *)
+{
+    if (jitStacks()->hasLocalData())
+        return jitStacks()->localData()->stackUtf8;
+
+    return nullptr;
+}
+#endif // QT_BOOTSTRAPPED
+
 /*!
     \internal
 */
@@ -1037,6 +1089,45 @@ void QRegularExpressionPrivate::optimizePattern()
     pcre2_jit_compile_16(compiledPattern, PCRE2_JIT_COMPLETE | PCRE2_JIT_PARTIAL_SOFT | PCRE2_JIT_PARTIAL_HARD);
 }
 
+#ifndef QT_BOOTSTRAPPED
+/*!
+    \internal
+
+    Compiles the pattern for the 8-bit PCRE2 library as well, so that it can
+    be matched against UTF-8 subjects. The UTF-16 pattern is compiled first,
+    as it provides the error reporting and the pattern information (capturing
+    groups, newline settings) shared by both.
+*/
+void QRegularExpressionPrivate::compilePatternUtf8()
+{
+    const QMutexLocker lock(&mutex);
+    compilePatternWithLockHeld();
+
+    if (!compiledPattern || compiledPatternUtf8)
+        return;
+
+    const QByteArray patternUtf8 = pattern.toUtf8();
+    int options = convertToPcreOptions(patternOptions);
+    options |= PCRE2_UTF;
+
+    int patternErrorCode;
+    PCRE2_SIZE patternErrorOffset;
+    compiledPatternUtf8 = pcre2_compile_8(reinterpret_cast<PCRE2_SPTR8>(patternUtf8.constData()),
+                                          patternUtf8.length(),
+                                          options,
+                                          &patternErrorCode,
+                                          &patternErrorOffset,
+                                          nullptr);
+    // the UTF-16 version compiled, so this one must too
+    Q_ASSERT(compiledPatternUtf8);
+
+    static const bool enableJit = isJitEnabled();
+
+    if (compiledPatternUtf8 && enableJit)
+        pcre2_jit_compile_8(compiledPatternUtf8, PCRE2_JIT_COMPLETE | PCRE2_JIT_PARTIAL_SOFT | PCRE2_JIT_PARTIAL_HARD);
+}
+#endif // QT_BOOTSTRAPPED
+
 /*!
     \internal
 
@@ -1099,6 +1190,33 @@ static int safe_pcre2_match_16(const pcre2_code_16 *code,
     return result;
 }
 
+#ifndef QT_BOOTSTRAPPED
+/*!
+    \internal
+
+    Same as safe_pcre2_match_16, for the 8-bit library.
+*/
+static int safe_pcre2_match_8(const pcre2_code_8 *code,
+                              PCRE2_SPTR8 subject, qsizetype length,
+                              qsizetype startOffset, int options,
+                              pcre2_match_data_8 *matchData,
+                              pcre2_match_context_8 *matchContext)
+{
+    int result = pcre2_match_8(code, subject, length,
+                               startOffset, options, matchData, matchContext);
+
+    if (result == PCRE2_ERROR_JIT_STACKLIMIT && !jitStacks()->hasLocalData()) {
+        QPcreJitStackPointer *p = new QPcreJitStackPointer;
+        jitStacks()->setLocalData(p);
+
+        result = pcre2_match_8(code, subject, length,
+                               startOffset, options, matchData, matchContext);
+    }
+
+    return result;
+}
+#endif // QT_BOOTSTRAPPED
+
 /*!
     \internal
 
@@ -1272,6 +1390,122 @@ void QRegularExpressionPrivate::doMatch(QRegularExpressionMatchPrivate *priv,
     pcre2_match_context_free_16(matchContext);
 }
 
+#ifndef QT_BOOTSTRAPPED
+/*!
+    \internal
+
+    Performs a match on the UTF-8 subject held by \a priv, using the pattern
+    compiled for the 8-bit PCRE2 library. This is the equivalent of doMatch()
+    for QRegularExpression::match() called on a UTF-8 view: \a offset and the
+    resulting captured offsets are byte positions inside that view.
+
+    There is no support for advancing a previous match, as global matching is
+    only available for UTF-16 subjects.
+*/
+void QRegularExpressionPrivate::doMatchUtf8(QRegularExpressionMatchPrivate *priv,
+                                            qsizetype offset) const
+{
+    Q_ASSERT(priv);
+    Q_ASSERT(priv->isUtf8Subject);
+
+    const qsizetype subjectLength = priv->subjectUtf8.size();
+
+    if (offset < 0)
+        offset += subjectLength;
+
+    if (offset < 0 || offset > subjectLength)
+        return;
+
+    if (Q_UNLIKELY(!compiledPatternUtf8)) {
+        qWarning("QRegularExpressionPrivate::doMatchUtf8(): called on an invalid QRegularExpression object");
+        return;
+    }
+
+    // skip doing the actual matching if NoMatch type was requested
+    if (priv->matchType == QRegularExpression::NoMatch) {
+        priv->isValid = true;
+        return;
+    }
+
+    int pcreOptions = convertToPcreOptions(priv->matchOptions);
+
+    if (priv->matchType == QRegularExpression::PartialPreferCompleteMatch)
+        pcreOptions |= PCRE2_PARTIAL_SOFT;
+    else if (priv->matchType == QRegularExpression::PartialPreferFirstMatch)
+        pcreOptions |= PCRE2_PARTIAL_HARD;
+
+    const uchar * const subjectUtf8 = reinterpret_cast<const uchar *>(priv->subjectUtf8.data());
+
+    // Validate the subject ourselves: QUtf8::isValidUtf8() is vectorized,
+    // while the check PCRE2 does on every call is not. Like PCRE2, reject
+    // offsets pointing in the middle of a UTF-8 sequence.
+    if (!(pcreOptions & PCRE2_NO_UTF_CHECK)) {
+        if (!QUtf8::isValidUtf8(priv->subjectUtf8).isValidUtf8)
+            return;
+        if (offset < subjectLength && (subjectUtf8[offset] & 0xc0) == 0x80)
+            return;
+        pcreOptions |= PCRE2_NO_UTF_CHECK;
+    }
+
+    pcre2_match_context_8 *matchContext = pcre2_match_context_create_8(nullptr);
+    pcre2_jit_stack_assign_8(matchContext, &qtPcreCallbackUtf8, nullptr);
+    pcre2_match_data_8 *matchData = pcre2_match_data_create_from_pattern_8(compiledPatternUtf8, nullptr);
+
+    const int result = safe_pcre2_match_8(compiledPatternUtf8,
+                                          subjectUtf8, subjectLength,
+                                          offset, pcreOptions,
+                                          matchData, matchContext);
+
+    // result == 0 means not enough space in captureOffsets; should never happen
+    Q_ASSERT(result != 0);
+
+    if (result > 0) {
+        // full match
+        priv->isValid = true;
+        priv->hasMatch = true;
+        priv->capturedCount = result;
+        priv->capturedOffsets.resize(result * 2);
+    } else {
+        // no match, partial match or error
+        priv->hasPartialMatch = (result == PCRE2_ERROR_PARTIAL);
+        priv->isValid = (result == PCRE2_ERROR_NOMATCH || result == PCRE2_ERROR_PARTIAL);
+
+        if (result == PCRE2_ERROR_PARTIAL) {
+            priv->capturedCount = 1;
+            priv->capturedOffsets.resize(2);
+        } else {
+            priv->capturedCount = 0;
+            priv->capturedOffsets.clear();
+        }
+    }
+
+    if (priv->capturedCount) {
+        PCRE2_SIZE *ovector = pcre2_get_ovector_pointer_8(matchData);
+        qsizetype *const capturedOffsets = priv->capturedOffsets.data();
+
+        for (int i = 0; i < priv->capturedCount * 2; ++i)
+            capturedOffsets[i] = qsizetype(ovector[i]);
+
+        // See doMatch(). The maximum lookbehind is counted in characters,
+        // so step back over whole UTF-8 sequences.
+        if (result == PCRE2_ERROR_PARTIAL) {
+            unsigned int maximumLookBehind;
+            pcre2_pattern_info_8(compiledPatternUtf8, PCRE2_INFO_MAXLOOKBEHIND, &maximumLookBehind);
+            qsizetype start = capturedOffsets[0];
+            for (unsigned int i = 0; i < maximumLookBehind && start > 0; ++i) {
+                do {
+                    --start;
+                } while (start > 0 && (subjectUtf8[start] & 0xc0) == 0x80);
+            }
+            capturedOffsets[0] = start;
+        }
+    }
+
+    pcre2_match_data_free_8(matchData);
+    pcre2_match_context_free_8(matchContext);
+}
+#endif // QT_BOOTSTRAPPED
+
 /*!
     \internal
 */
@@ -1288,6 +1522,21 @@ QRegularExpressionMatchPrivate::QRegularExpressionMatchPrivate(const QRegularExp
 {
 }
 
+/*!
+    \internal
+*/
+QRegularExpressionMatchPrivate::QRegularExpressionMatchPrivate(const QRegularExpression &re,
+                                                               QByteArrayView subjectUtf8,
+                                                               QRegularExpression::MatchType matchType,
+                                                               QRegularExpression::MatchOptions matchOptions)
+    : regularExpression(re),
+      subjectUtf8(subjectUtf8),
+      isUtf8Subject(true),
+      matchType(matchType),
+      matchOptions(matchOptions)
+{
+}
+
 /*!
     \internal
 */
@@ -1648,6 +1897,64 @@ QRegularExpressionMatch QRegularExpression::match(QStringView subjectView,
     return QRegularExpressionMatch(*priv);
 }
 
+/*!
+    \fn QRegularExpressionMatch QRegularExpression::match(QUtf8StringView subjectView, qsizetype offset, MatchType matchType, MatchOptions matchOptions) const
+    \fn QRegularExpressionMatch QRegularExpression::match(QByteArrayView subjectView, qsizetype offset, MatchType matchType, MatchOptions matchOptions) const
+    \since 6.2
+    \overload
+
+    Attempts to match the regular expression against the UTF-8 encoded
+    \a subjectView, starting at the byte position \a offset inside the
+    subject, using a match of type \a matchType and honoring the given
+    \a matchOptions.
+
+    The subject is matched as it is, without converting it to UTF-16 first.
+    Consequently, all the offsets reported by the returned
+    QRegularExpressionMatch (capturedStart(), capturedEnd(),
+    capturedLength()) are byte offsets inside \a subjectView. Use
+    QRegularExpressionMatch::capturedUtf8View() to access the captured
+    substrings without copying them; QRegularExpressionMatch::captured()
+    returns them converted to QString, while
+    QRegularExpressionMatch::capturedView() returns a null QStringView.
+
+    An invalid match is returned if \a subjectView is not valid UTF-8 or if
+    \a offset does not point to the beginning of a UTF-8 sequence, unless
+    QRegularExpression::DontCheckSubjectStringMatchOption is passed, in
+    which case the behavior on invalid UTF-8 is undefined.
+
+    These overloads only accept QUtf8StringView and QByteArrayView arguments
+    exactly, so that passing a string literal or a QByteArray keeps calling
+    the QString overload.
+
+    The pattern is compiled for UTF-8 matching (and JIT-compiled, if the JIT
+    is enabled) on the first call, and the result is shared by all the
+    copies of this QRegularExpression object.
+
+    \note The data referenced by \a subjectView must remain valid as long
+    as there are QRegularExpressionMatch objects using it.
+
+    \sa QRegularExpressionMatch, {normal matching}
+*/
+
+#ifndef QT_BOOTSTRAPPED
+/*!
+    \internal
+*/
+QRegularExpressionMatch QRegularExpression::matchUtf8(QByteArrayView subjectView,
+                                                      qsizetype offset,
+                                                      MatchType matchType,
+                                                      MatchOptions matchOptions) const
+{
+    d.data()->compilePatternUtf8();
+    auto priv = new QRegularExpressionMatchPrivate(*this,
+                                                   subjectView,
+                                                   matchType,
+                                                   matchOptions);
+    d->doMatchUtf8(priv, offset);
+    return QRegularExpressionMatch(*priv);
+}
+#endif // QT_BOOTSTRAPPED
+
 /*!
     Attempts to perform a global match of the regular expression against the
     given \a subject string, starting at the position \a offset inside the
@@ -2187,6 +2494,12 @@ int QRegularExpressionMatch::lastCapturedIndex() const
 */
 QString QRegularExpressionMatch::captured(int nth) const
 {
+    if (d->isUtf8Subject) {
+        const QUtf8StringView view = capturedUtf8View(nth);
+        if (view.isNull())
+            return QString();
+        return QString::fromUtf8(view.data(), view.size());
+    }
     return capturedView(nth).toString();
 }
 
@@ -2201,6 +2514,9 @@ QString QRegularExpressionMatch::captured(int nth) const
     \note The implicit capturing group number 0 captures the substring matched
     by the entire pattern.
 
+    \note If the match was performed on a UTF-8 subject, this function
+    returns a null QStringView; use capturedUtf8View() instead.
+
     \sa captured(), lastCapturedIndex(), capturedStart(), capturedEnd(),
     capturedLength(), QStringView::isNull()
 */
@@ -2247,8 +2563,10 @@ QString QRegularExpressionMatch::captured(QStringView name) const
         qWarning("QRegularExpressionMatch::captured: empty capturing group name passed");
         return QString();
     }
-
-    return capturedView(name).toString();
+    int nth = d->regularExpression.d->captureIndexForName(name);
+    if (nth == -1)
+        return QString();
+    return captured(nth);
 }
 
 /*!
@@ -2275,6 +2593,58 @@ QStringView QRegularExpressionMatch::capturedView(QStringView name) const
     return capturedView(nth);
 }
 
+/*!
+    \since 6.2
+
+    Returns a view of the substring captured by the \a nth capturing group
+    inside the UTF-8 subject the match was performed on.
+
+    If the \a nth capturing group did not capture a string, if there is no
+    such capturing group, or if the match was not performed on a UTF-8
+    subject, returns a null QUtf8StringView.
+
+    \note The implicit capturing group number 0 captures the substring matched
+    by the entire pattern.
+
+    \sa captured(), capturedView(), QRegularExpression::match()
+*/
+QUtf8StringView QRegularExpressionMatch::capturedUtf8View(int nth) const
+{
+    if (!d->isUtf8Subject || nth < 0 || nth > lastCapturedIndex())
+        return QUtf8StringView();
+
+    qsizetype start = capturedStart(nth);
+
+    if (start == -1) // didn't capture
+        return QUtf8StringView();
+
+    return QUtf8StringView(d->subjectUtf8.data() + start, capturedLength(nth));
+}
+
+/*!
+    \since 6.2
+
+    Returns a view of the substring captured by the capturing group named
+    \a name inside the UTF-8 subject the match was performed on.
+
+    If the named capturing group \a name did not capture a string, if there
+    is no capturing group named \a name, or if the match was not performed
+    on a UTF-8 subject, returns a null QUtf8StringView.
+
+    \sa captured(), capturedView(), QRegularExpression::match()
+*/
+QUtf8StringView QRegularExpressionMatch::capturedUtf8View(QStringView name) const
+{
+    if (name.isEmpty()) {
+        qWarning("QRegularExpressionMatch::capturedUtf8View: empty capturing group name passed");
+        return QUtf8StringView();
+    }
+    int nth = d->regularExpression.d->captureIndexForName(name);
+    if (nth == -1)
+        return QUtf8StringView();
+    return capturedUtf8View(nth);
+}
+
 /*!
     Returns a list of all strings captured by capturing groups, in the order
     the groups themselves appear in the pattern string. The list includes the
@@ -45,6 +45,8 @@
 #include <QtCore/qglobal.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qstringview.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qutf8stringview.h>
 #include <QtCore/qshareddata.h>
 #include <QtCore/qvariant.h>
 
@@ -135,6 +137,43 @@ public:
                                   MatchType matchType       = NormalMatch,
                                   MatchOptions matchOptions = NoMatchOption) const;
 
+private:
+    template <typename View>
+    using if_utf8_subject = std::enable_if_t<
+        std::disjunction_v<std::is_same<View, QByteArrayView>,
+                           std::is_same<View, QBasicUtf8StringView<false>>,
+                           std::is_same<View, QBasicUtf8StringView<true>>>,
+        bool>;
+
+    QRegularExpressionMatch matchUtf8(QByteArrayView subjectView,
+                                      qsizetype offset,
+                                      MatchType matchType,
+                                      MatchOptions matchOptions) const;
+
+public:
+#ifdef Q_CLANG_QDOC
+    [[nodiscard]]
+    QRegularExpressionMatch match(QUtf8StringView subjectView,
+                                  qsizetype offset          = 0,
+                                  MatchType matchType       = NormalMatch,
+                                  MatchOptions matchOptions = NoMatchOption) const;
+
+    [[nodiscard]]
+    QRegularExpressionMatch match(QByteArrayView subjectView,
+                                  qsizetype offset          = 0,
+                                  MatchType matchType       = NormalMatch,
+                                  MatchOptions matchOptions = NoMatchOption) const;
+#else
+    // Only exact view types are accepted, so that match("literal") keeps
+    // resolving to the QString overload.
+    template <typename View, if_utf8_subject<View> = true>
+    [[nodiscard]]
+    QRegularExpressionMatch match(View subjectView,
+                                  qsizetype offset          = 0,
+                                  MatchType matchType       = NormalMatch,
+                                  MatchOptions matchOptions = NoMatchOption) const;
+#endif
+
     [[nodiscard]]
     QRegularExpressionMatchIterator globalMatch(const QString &subject,
                                                 qsizetype offset          = 0,
@@ -244,6 +283,9 @@ public:
     QString captured(QStringView name) const;
     QStringView capturedView(QStringView name) const;
 
+    QUtf8StringView capturedUtf8View(int nth = 0) const;
+    QUtf8StringView capturedUtf8View(QStringView name) const;
+
     QStringList capturedTexts() const;
 
     qsizetype capturedStart(int nth = 0) const;
@@ -274,6 +316,19 @@ private:
 
 Q_DECLARE_SHARED(QRegularExpressionMatch)
 
+#ifndef Q_CLANG_QDOC
+template <typename View, QRegularExpression::if_utf8_subject<View>>
+QRegularExpressionMatch QRegularExpression::match(View subjectView,
+                                                  qsizetype offset,
+                                                  MatchType matchType,
+                                                  MatchOptions matchOptions) const
+{
+    return matchUtf8(QByteArrayView(reinterpret_cast<const char *>(subjectView.data()),
+                                    subjectView.size()),
+                     offset, matchType, matchOptions);
+}
+#endif
+
 #ifndef QT_NO_DEBUG_STREAM
 Q_CORE_EXPORT QDebug operator<<(QDebug debug, const QRegularExpressionMatch &match);
 #endif
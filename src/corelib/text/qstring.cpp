@@ -262,6 +262,65 @@ inline RetType UnrollTailLoop<0>::exec(Number, RetType returnIfExited, Functor1,
 }
 #endif
 
+/*
+ * The AVX2 and AVX-512 versions of the functions below are selected at
+ * runtime with qCpuHasFeature(), so they are used even if QtCore was built
+ * for a baseline x86 CPU. If the compiler was already told to generate code
+ * for that CPU, the check is resolved at compile time.
+ *
+ * The AVX-512 versions process the whole input and use masked loads for the
+ * final partial block; those don't fault on the masked-off elements. The
+ * AVX2 versions only process full blocks and leave the tail to the SSE2 code.
+ */
+#if QT_COMPILER_SUPPORTS_HERE(AVX512BW) && !defined(__OPTIMIZE_SIZE__)
+#  define QT_STRING_AVX512BW
+static Q_ALWAYS_INLINE __mmask32 mm512_tailmask32(qptrdiff left) noexcept
+{
+    return left >= 32 ? __mmask32(~0U) : __mmask32((1U << left) - 1);
+}
+#endif
+#if QT_COMPILER_SUPPORTS_HERE(AVX2) && !defined(__OPTIMIZE_SIZE__)
+#  define QT_STRING_AVX2
+#endif
+
+#ifdef QT_STRING_AVX512BW
+QT_FUNCTION_TARGET(AVX512BW)
+static const char16_t *qustrchr_avx512bw(const char16_t *n, const char16_t *e, char16_t c) noexcept
+{
+    const __m512i mch = _mm512_set1_epi16(short(c));
+    for (qptrdiff offset = 0; offset < e - n; offset += 32) {
+        const __mmask32 valid = mm512_tailmask32(e - n - offset);
+        __m512i data = _mm512_maskz_loadu_epi16(valid, n + offset);
+        quint32 mask = _mm512_mask_cmpeq_epi16_mask(valid, data, mch);
+        if (mask)
+            return n + offset + qCountTrailingZeroBits(mask);
+    }
+    return e;
+}
+#endif
+
+#ifdef QT_STRING_AVX2
+// Returns true and sets \a n to the match if \a c is found in one of the
+// 16-character blocks; otherwise, \a n points to the remaining tail.
+QT_FUNCTION_TARGET(AVX2)
+static bool qustrchr_avx2(const char16_t *&n, const char16_t *e, char16_t c) noexcept
+{
+    // we're going to read n[0..15] (32 bytes)
+    __m256i mch256 = _mm256_set1_epi32(c | (c << 16));
+    for (const char16_t *next = n + 16; next <= e; n = next, next += 16) {
+        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(n));
+        __m256i result = _mm256_cmpeq_epi16(data, mch256);
+        uint mask = uint(_mm256_movemask_epi8(result));
+        if (mask) {
+            uint idx = qCountTrailingZeroBits(mask);
+            n += idx / 2;
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
 /*!
  * \internal
  *
@@ -277,25 +336,20 @@ const char16_t *QtPrivate::qustrchr(QStringView str, char16_t c) noexcept
 
 #ifdef __SSE2__
     bool loops = true;
+#  ifdef QT_STRING_AVX512BW
+    if (qCpuHasFeature(AVX512BW))
+        return qustrchr_avx512bw(n, e, c);
+#  endif
+#  ifdef QT_STRING_AVX2
+    if (qCpuHasFeature(AVX2)) {
+        if (qustrchr_avx2(n, e, c))
+            return n;
+        loops = false;
+    }
+#  endif
     // Using the PMOVMSKB instruction, we get two bits for each character
     // we compare.
-#  if defined(__AVX2__) && !defined(__OPTIMIZE_SIZE__)
-    // we're going to read n[0..15] (32 bytes)
-    __m256i mch256 = _mm256_set1_epi32(c | (c << 16));
-    for (const char16_t *next = n + 16; next <= e; n = next, next += 16) {
-        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(n));
-        __m256i result = _mm256_cmpeq_epi16(data, mch256);
-        uint mask = uint(_mm256_movemask_epi8(result));
-        if (mask) {
-            uint idx = qCountTrailingZeroBits(mask);
-            return n + idx / 2;
-        }
-    }
-    loops = false;
-    __m128i mch = _mm256_castsi256_si128(mch256);
-#  else
     __m128i mch = _mm_set1_epi32(c | (c << 16));
-#  endif
 
     auto hasMatch = [mch, &n](__m128i data, ushort validityMask) {
         __m128i result = _mm_cmpeq_epi16(data, mch);
@@ -355,77 +409,98 @@ const char16_t *QtPrivate::qustrchr(QStringView str, char16_t c) noexcept
 }
 
 #ifdef __SSE2__
-// Scans from \a ptr to \a end until \a maskval is non-zero. Returns true if
-// the no non-zero was found. Returns false and updates \a ptr to point to the
-// first 16-bit word that has any bit set (note: if the input is 8-bit, \a ptr
-// may be updated to one byte short).
-static bool simdTestMask(const char *&ptr, const char *end, quint32 maskval)
+static bool simdTestMaskFound(const char *&ptr, uint result)
 {
-    auto updatePtr = [&](uint result) {
-        // found a character matching the mask
-        uint idx = qCountTrailingZeroBits(~result);
-        ptr += idx;
-        return false;
-    };
+    // found a character matching the mask
+    uint idx = qCountTrailingZeroBits(~result);
+    ptr += idx;
+    return false;
+}
 
-#  if defined(__SSE4_1__)
-    __m128i mask;
-    auto updatePtrSimd = [&](__m128i data) {
-        __m128i masked = _mm_and_si128(mask, data);
-        __m128i comparison = _mm_cmpeq_epi16(masked, _mm_setzero_si128());
-        uint result = _mm_movemask_epi8(comparison);
-        return updatePtr(result);
-    };
+#  if QT_COMPILER_SUPPORTS_HERE(SSE4_1)
+static bool simdTestMaskFound(const char *&ptr, __m128i mask, __m128i data)
+{
+    __m128i masked = _mm_and_si128(mask, data);
+    __m128i comparison = _mm_cmpeq_epi16(masked, _mm_setzero_si128());
+    return simdTestMaskFound(ptr, _mm_movemask_epi8(comparison));
+}
 
-#    if defined(__AVX2__)
-    // AVX2 implementation: test 32 bytes at a time
-    const __m256i mask256 = _mm256_broadcastd_epi32(_mm_cvtsi32_si128(maskval));
-    while (ptr + 32 <= end) {
-        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
-        if (!_mm256_testz_si256(mask256, data)) {
-            // found a character matching the mask
-            __m256i masked256 = _mm256_and_si256(mask256, data);
-            __m256i comparison256 = _mm256_cmpeq_epi16(masked256, _mm256_setzero_si256());
-            return updatePtr(_mm256_movemask_epi8(comparison256));
-        }
-        ptr += 32;
+// AVX2 and SSE4.1: final 16- and 8-byte comparisons
+QT_FUNCTION_TARGET(SSE4_1)
+static bool simdTestMaskTail_sse4(const char *&ptr, const char *end, __m128i mask)
+{
+    if (ptr + 16 <= end) {
+        __m128i data1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+        if (!_mm_testz_si128(mask, data1))
+            return simdTestMaskFound(ptr, mask, data1);
+        ptr += 16;
     }
 
-    mask = _mm256_castsi256_si128(mask256);
-#    else
-    // SSE 4.1 implementation: test 32 bytes at a time (two 16-byte
-    // comparisons, unrolled)
-    mask = _mm_set1_epi32(maskval);
+    if (ptr + 8 <= end) {
+        __m128i data1 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(ptr));
+        if (!_mm_testz_si128(mask, data1))
+            return simdTestMaskFound(ptr, mask, data1);
+        ptr += 8;
+    }
+    return true;
+}
+
+// SSE 4.1 implementation: test 32 bytes at a time (two 16-byte
+// comparisons, unrolled)
+QT_FUNCTION_TARGET(SSE4_1)
+static bool simdTestMask_sse4(const char *&ptr, const char *end, quint32 maskval)
+{
+    const __m128i mask = _mm_set1_epi32(maskval);
     while (ptr + 32 <= end) {
         __m128i data1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
         __m128i data2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr + 16));
         if (!_mm_testz_si128(mask, data1))
-            return updatePtrSimd(data1);
+            return simdTestMaskFound(ptr, mask, data1);
 
         ptr += 16;
         if (!_mm_testz_si128(mask, data2))
-            return updatePtrSimd(data2);
+            return simdTestMaskFound(ptr, mask, data2);
         ptr += 16;
     }
-#    endif
+    return simdTestMaskTail_sse4(ptr, end, mask);
+}
+#  endif
 
-    // AVX2 and SSE4.1: final 16-byte comparison
-    if (ptr + 16 <= end) {
-        __m128i data1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
-        if (!_mm_testz_si128(mask, data1))
-            return updatePtrSimd(data1);
-        ptr += 16;
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+// AVX2 implementation: test 32 bytes at a time
+QT_FUNCTION_TARGET(AVX2)
+static bool simdTestMask_avx2(const char *&ptr, const char *end, quint32 maskval)
+{
+    const __m256i mask256 = _mm256_broadcastd_epi32(_mm_cvtsi32_si128(maskval));
+    while (ptr + 32 <= end) {
+        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+        if (!_mm256_testz_si256(mask256, data)) {
+            // found a character matching the mask
+            __m256i masked256 = _mm256_and_si256(mask256, data);
+            __m256i comparison256 = _mm256_cmpeq_epi16(masked256, _mm256_setzero_si256());
+            return simdTestMaskFound(ptr, _mm256_movemask_epi8(comparison256));
+        }
+        ptr += 32;
     }
+    return simdTestMaskTail_sse4(ptr, end, _mm256_castsi256_si128(mask256));
+}
+#  endif
 
-    // and final 8-byte comparison
-    if (ptr + 8 <= end) {
-        __m128i data1 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(ptr));
-        if (!_mm_testz_si128(mask, data1))
-            return updatePtrSimd(data1);
-        ptr += 8;
-    }
+// Scans from \a ptr to \a end until \a maskval is non-zero. Returns true if
+// the no non-zero was found. Returns false and updates \a ptr to point to the
+// first 16-bit word that has any bit set (note: if the input is 8-bit, \a ptr
+// may be updated to one byte short).
+static bool simdTestMask(const char *&ptr, const char *end, quint32 maskval)
+{
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    if (qCpuHasFeature(AVX2))
+        return simdTestMask_avx2(ptr, end, maskval);
+#  endif
+#  if QT_COMPILER_SUPPORTS_HERE(SSE4_1)
+    if (qCpuHasFeature(SSE4_1))
+        return simdTestMask_sse4(ptr, end, maskval);
+#  endif
 
-#  else
     // SSE2 implementation: test 16 bytes at a time.
     const __m128i mask = _mm_set1_epi32(maskval);
     while (ptr + 16 <= end) {
@@ -434,7 +509,7 @@ static bool simdTestMask(const char *&ptr, const char *end, quint32 maskval)
         __m128i comparison = _mm_cmpeq_epi16(masked, _mm_setzero_si128());
         quint16 result = _mm_movemask_epi8(comparison);
         if (result != 0xffff)
-            return updatePtr(result);
+            return simdTestMaskFound(ptr, result);
         ptr += 16;
     }
 
@@ -445,10 +520,9 @@ static bool simdTestMask(const char *&ptr, const char *end, quint32 maskval)
         __m128i comparison = _mm_cmpeq_epi16(masked, _mm_setzero_si128());
         quint8 result = _mm_movemask_epi8(comparison);
         if (result != 0xff)
-            return updatePtr(result);
+            return simdTestMaskFound(ptr, result);
         ptr += 8;
     }
-#  endif
 
     return true;
 }
@@ -469,13 +543,10 @@ static Q_ALWAYS_INLINE __m128i mm_load8_zero_extend(const void *ptr)
 }
 #endif
 
-// Note: ptr on output may be off by one and point to a preceding US-ASCII
-// character. Usually harmless.
-bool qt_is_ascii(const char *&ptr, const char *end) noexcept
+#if defined(__SSE2__) && QT_COMPILER_SUPPORTS_HERE(AVX2)
+QT_FUNCTION_TARGET(AVX2)
+static bool qt_is_ascii_avx2(const char *&ptr, const char *end) noexcept
 {
-#if defined(__SSE2__)
-    // Testing for the high bit can be done efficiently with just PMOVMSKB
-#  if defined(__AVX2__)
     while (ptr + 32 <= end) {
         __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
         quint32 mask = _mm256_movemask_epi8(data);
@@ -486,6 +557,19 @@ bool qt_is_ascii(const char *&ptr, const char *end) noexcept
         }
         ptr += 32;
     }
+    return true;
+}
+#endif
+
+// Note: ptr on output may be off by one and point to a preceding US-ASCII
+// character. Usually harmless.
+bool qt_is_ascii(const char *&ptr, const char *end) noexcept
+{
+#if defined(__SSE2__)
+    // Testing for the high bit can be done efficiently with just PMOVMSKB
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    if (qCpuHasFeature(AVX2) && !qt_is_ascii_avx2(ptr, end))
+        return false;
 #  endif
     while (ptr + 16 <= end) {
         __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
@@ -600,6 +684,42 @@ bool QtPrivate::isValidUtf16(QStringView s) noexcept
     return true;
 }
 
+#if defined(__SSE2__) && defined(QT_STRING_AVX512BW)
+QT_FUNCTION_TARGET(AVX512BW)
+static void qt_from_latin1_avx512bw(char16_t *dst, const char *str, size_t size) noexcept
+{
+    size_t offset = 0;
+    for ( ; offset + 32 <= size; offset += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(str + offset));
+        _mm512_storeu_si512(dst + offset, _mm512_cvtepu8_epi16(chunk));
+    }
+    if (offset < size) {
+        const __mmask32 valid = mm512_tailmask32(size - offset);
+        const __m512i chunk = _mm512_maskz_loadu_epi8(valid, str + offset);
+        // like _mm512_castsi512_si256(), but GCC warns about the undefined
+        // upper half that the cast leaves behind
+        const __m256i chunk256 = _mm512_maskz_extracti64x4_epi64(0xf, chunk, 0);
+        _mm512_mask_storeu_epi16(dst + offset, valid, _mm512_cvtepu8_epi16(chunk256));
+    }
+}
+#endif
+
+#if defined(__SSE2__) && defined(QT_STRING_AVX2)
+// Converts all 16-character blocks and returns how many characters that was
+QT_FUNCTION_TARGET(AVX2)
+static qptrdiff qt_from_latin1_avx2(char16_t *dst, const char *str, size_t size) noexcept
+{
+    qptrdiff offset = 0;
+    for ( ; offset + 16 <= qptrdiff(size); offset += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + offset));
+        // zero extend to an YMM register and store
+        const __m256i extended = _mm256_cvtepu8_epi16(chunk);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + offset), extended);
+    }
+    return offset;
+}
+#endif
+
 // conversion between Latin 1 and UTF-16
 Q_CORE_EXPORT void qt_from_latin1(char16_t *dst, const char *str, size_t size) noexcept
 {
@@ -612,16 +732,18 @@ Q_CORE_EXPORT void qt_from_latin1(char16_t *dst, const char *str, size_t size) n
     const char *e = str + size;
     qptrdiff offset = 0;
 
+#  ifdef QT_STRING_AVX512BW
+    if (qCpuHasFeature(AVX512BW))
+        return qt_from_latin1_avx512bw(dst, str, size);
+#  endif
+#  ifdef QT_STRING_AVX2
+    if (qCpuHasFeature(AVX2))
+        offset = qt_from_latin1_avx2(dst, str, size);
+#  endif
+
     // we're going to read str[offset..offset+15] (16 bytes)
     for ( ; str + offset + 15 < e; offset += 16) {
         const __m128i chunk = _mm_loadu_si128((const __m128i*)(str + offset)); // load
-#ifdef __AVX2__
-        // zero extend to an YMM register
-        const __m256i extended = _mm256_cvtepu8_epi16(chunk);
-
-        // store
-        _mm256_storeu_si256((__m256i*)(dst + offset), extended);
-#else
         const __m128i nullMask = _mm_set1_epi32(0);
 
         // unpack the first 8 bytes, padding with zeros
@@ -631,7 +753,6 @@ Q_CORE_EXPORT void qt_from_latin1(char16_t *dst, const char *str, size_t size) n
         // unpack the last 8 bytes, padding with zeros
         const __m128i secondHalf = _mm_unpackhi_epi8 (chunk, nullMask);
         _mm_storeu_si128((__m128i*)(dst + offset + 8), secondHalf); // store
-#endif
     }
 
     // we're going to read str[offset..offset+7] (8 bytes)
@@ -659,6 +780,55 @@ Q_CORE_EXPORT void qt_from_latin1(char16_t *dst, const char *str, size_t size) n
 #endif
 }
 
+#if defined(__SSE2__) && defined(QT_STRING_AVX512BW)
+template <bool Checked>
+QT_FUNCTION_TARGET(AVX512BW)
+static void qt_to_latin1_avx512bw(uchar *dst, const char16_t *src, qsizetype length) noexcept
+{
+    const __m512i questionMark = _mm512_set1_epi16('?');
+    const __m512i maxLatin1 = _mm512_set1_epi16(0xff);
+    for (qsizetype offset = 0; offset < length; offset += 32) {
+        const __mmask32 valid = mm512_tailmask32(length - offset);
+        __m512i chunk = _mm512_maskz_loadu_epi16(valid, src + offset);
+        if (Checked) {
+            const __mmask32 offLimitMask = _mm512_cmpgt_epu16_mask(chunk, maxLatin1);
+            chunk = _mm512_mask_mov_epi16(chunk, offLimitMask, questionMark);
+        }
+        _mm512_mask_cvtepi16_storeu_epi8(dst + offset, valid, chunk);
+    }
+}
+#endif
+
+#if defined(__SSE2__) && defined(QT_STRING_AVX2)
+// Converts all 16-character blocks and returns how many characters that was
+template <bool Checked>
+QT_FUNCTION_TARGET(AVX2)
+static qptrdiff qt_to_latin1_avx2(uchar *dst, const char16_t *src, qsizetype length) noexcept
+{
+    const __m256i questionMark256 = _mm256_broadcastw_epi16(_mm_cvtsi32_si128('?'));
+    const __m256i outOfRange256 = _mm256_broadcastw_epi16(_mm_cvtsi32_si128(0x100));
+
+    qptrdiff offset = 0;
+    for ( ; offset + 16 <= length; offset += 16) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + offset));
+        if (Checked) {
+            // See mergeQuestionMarks lambda in qt_to_latin1_internal for details
+            chunk = _mm256_min_epu16(chunk, outOfRange256);
+            const __m256i offLimitMask = _mm256_cmpeq_epi16(chunk, outOfRange256);
+            chunk = _mm256_blendv_epi8(chunk, questionMark256, offLimitMask);
+        }
+
+        const __m128i chunk2 = _mm256_extracti128_si256(chunk, 1);
+        const __m128i chunk1 = _mm256_castsi256_si128(chunk);
+
+        // pack the two vector to 16 x 8bits elements
+        const __m128i result = _mm_packus_epi16(chunk1, chunk2);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + offset), result);
+    }
+    return offset;
+}
+#endif
+
 template <bool Checked>
 static void qt_to_latin1_internal(uchar *dst, const char16_t *src, qsizetype length)
 {
@@ -666,15 +836,17 @@ static void qt_to_latin1_internal(uchar *dst, const char16_t *src, qsizetype len
     uchar *e = dst + length;
     qptrdiff offset = 0;
 
-#  ifdef __AVX2__
-    const __m256i questionMark256 = _mm256_broadcastw_epi16(_mm_cvtsi32_si128('?'));
-    const __m256i outOfRange256 = _mm256_broadcastw_epi16(_mm_cvtsi32_si128(0x100));
-    const __m128i questionMark = _mm256_castsi256_si128(questionMark256);
-    const __m128i outOfRange = _mm256_castsi256_si128(outOfRange256);
-#  else
+#  ifdef QT_STRING_AVX512BW
+    if (qCpuHasFeature(AVX512BW))
+        return qt_to_latin1_avx512bw<Checked>(dst, src, length);
+#  endif
+#  ifdef QT_STRING_AVX2
+    if (qCpuHasFeature(AVX2))
+        offset = qt_to_latin1_avx2<Checked>(dst, src, length);
+#  endif
+
     const __m128i questionMark = _mm_set1_epi16('?');
     const __m128i outOfRange = _mm_set1_epi16(0x100);
-#  endif
 
     auto mergeQuestionMarks = [=](__m128i chunk) {
         // SSE has no compare instruction for unsigned comparison.
@@ -709,18 +881,6 @@ static void qt_to_latin1_internal(uchar *dst, const char16_t *src, qsizetype len
 
     // we're going to write to dst[offset..offset+15] (16 bytes)
     for ( ; dst + offset + 15 < e; offset += 16) {
-#  if defined(__AVX2__)
-        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + offset));
-        if (Checked) {
-            // See mergeQuestionMarks lambda above for details
-            chunk = _mm256_min_epu16(chunk, outOfRange256);
-            const __m256i offLimitMask = _mm256_cmpeq_epi16(chunk, outOfRange256);
-            chunk = _mm256_blendv_epi8(chunk, questionMark256, offLimitMask);
-        }
-
-        const __m128i chunk2 = _mm256_extracti128_si256(chunk, 1);
-        const __m128i chunk1 = _mm256_castsi256_si128(chunk);
-#  else
         __m128i chunk1 = _mm_loadu_si128((const __m128i*)(src + offset)); // load
         if (Checked)
             chunk1 = mergeQuestionMarks(chunk1);
@@ -728,7 +888,6 @@ static void qt_to_latin1_internal(uchar *dst, const char16_t *src, qsizetype len
         __m128i chunk2 = _mm_loadu_si128((const __m128i*)(src + offset + 8)); // load
         if (Checked)
             chunk2 = mergeQuestionMarks(chunk2);
-#  endif
 
         // pack the two vector to 16 x 8bits elements
         const __m128i result = _mm_packus_epi16(chunk1, chunk2);
@@ -914,6 +1073,72 @@ extern "C" int qt_ucstrncmp_mips_dsp_asm(const char16_t *a,
                                          unsigned len);
 #endif
 
+#if defined(__SSE2__) && defined(QT_STRING_AVX512BW)
+QT_FUNCTION_TARGET(AVX512BW)
+static int ucstrncmp_avx512bw(const char16_t *a, const char16_t *b, size_t l) noexcept
+{
+    for (qptrdiff offset = 0; offset < qptrdiff(l); offset += 32) {
+        const __mmask32 valid = mm512_tailmask32(l - offset);
+        __m512i a_data = _mm512_maskz_loadu_epi16(valid, a + offset);
+        __m512i b_data = _mm512_maskz_loadu_epi16(valid, b + offset);
+        quint32 mask = _mm512_cmpneq_epi16_mask(a_data, b_data);
+        if (mask) {
+            // found a different character
+            uint idx = qCountTrailingZeroBits(mask);
+            return a[offset + idx] - b[offset + idx];
+        }
+    }
+    return 0;
+}
+#endif
+
+#if defined(__SSE2__) && defined(QT_STRING_AVX2)
+// Compares all 16-character blocks, advancing \a offset past them. Returns the
+// difference of the first mismatching characters, or 0 if there was none.
+QT_FUNCTION_TARGET(AVX2)
+static int ucstrncmp_avx2(const char16_t *a, const char16_t *b, size_t l, qptrdiff &offset) noexcept
+{
+    // we're going to read a[0..15] and b[0..15] (32 bytes)
+    for ( ; qptrdiff(l) >= offset + 16; offset += 16) {
+        __m256i a_data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + offset));
+        __m256i b_data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + offset));
+        __m256i result = _mm256_cmpeq_epi16(a_data, b_data);
+        uint mask = ~uint(_mm256_movemask_epi8(result));
+        if (mask) {
+            // found a different character
+            uint idx = qCountTrailingZeroBits(mask);
+            return a[offset + idx / 2] - b[offset + idx / 2];
+        }
+    }
+    return 0;
+}
+
+// Same as above, but \a c is in Latin 1
+QT_FUNCTION_TARGET(AVX2)
+static int ucstrncmp_avx2(const char16_t *uc, const uchar *c, size_t l, qptrdiff &offset) noexcept
+{
+    // we're going to read uc[offset..offset+15] (32 bytes)
+    // and c[offset..offset+15] (16 bytes)
+    for ( ; qptrdiff(l) >= offset + 16; offset += 16) {
+        // expand Latin 1 data via zero extension
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c + offset));
+        __m256i ldata = _mm256_cvtepu8_epi16(chunk);
+
+        // load UTF-16 data and compare
+        __m256i ucdata = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(uc + offset));
+        __m256i result = _mm256_cmpeq_epi16(ldata, ucdata);
+
+        uint mask = ~uint(_mm256_movemask_epi8(result));
+        if (mask) {
+            // found a different character
+            uint idx = qCountTrailingZeroBits(mask);
+            return uc[offset + idx / 2] - c[offset + idx / 2];
+        }
+    }
+    return 0;
+}
+#endif
+
 // Unicode case-sensitive compare two same-sized strings
 static int ucstrncmp(const QChar *a, const QChar *b, size_t l)
 {
@@ -939,6 +1164,20 @@ static int ucstrncmp(const QChar *a, const QChar *b, size_t l)
     const QChar *end = a + l;
     qptrdiff offset = 0;
 
+#  ifdef QT_STRING_AVX512BW
+    if (qCpuHasFeature(AVX512BW)) {
+        return ucstrncmp_avx512bw(reinterpret_cast<const char16_t *>(a),
+                                  reinterpret_cast<const char16_t *>(b), l);
+    }
+#  endif
+#  ifdef QT_STRING_AVX2
+    if (qCpuHasFeature(AVX2)) {
+        if (int diff = ucstrncmp_avx2(reinterpret_cast<const char16_t *>(a),
+                                      reinterpret_cast<const char16_t *>(b), l, offset))
+            return diff;
+    }
+#  endif
+
     // Using the PMOVMSKB instruction, we get two bits for each character
     // we compare.
     int retval;
@@ -954,12 +1193,6 @@ static int ucstrncmp(const QChar *a, const QChar *b, size_t l)
 
     // we're going to read a[0..15] and b[0..15] (32 bytes)
     for ( ; end - a >= offset + 16; offset += 16) {
-#ifdef __AVX2__
-        __m256i a_data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + offset));
-        __m256i b_data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + offset));
-        __m256i result = _mm256_cmpeq_epi16(a_data, b_data);
-        uint mask = _mm256_movemask_epi8(result);
-#else
         __m128i a_data1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + offset));
         __m128i a_data2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + offset + 8));
         __m128i b_data1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + offset));
@@ -967,7 +1200,6 @@ static int ucstrncmp(const QChar *a, const QChar *b, size_t l)
         __m128i result1 = _mm_cmpeq_epi16(a_data1, b_data1);
         __m128i result2 = _mm_cmpeq_epi16(a_data2, b_data2);
         uint mask = _mm_movemask_epi8(result1) | (_mm_movemask_epi8(result2) << 16);
-#endif
         mask = ~mask;
         if (mask) {
             // found a different character
@@ -1086,6 +1318,13 @@ static int ucstrncmp(const QChar *a, const uchar *c, size_t l)
     __m128i nullmask = _mm_setzero_si128();
     qptrdiff offset = 0;
 
+#  ifdef QT_STRING_AVX2
+    if (qCpuHasFeature(AVX2)) {
+        if (int diff = ucstrncmp_avx2(uc, c, l, offset))
+            return diff;
+    }
+#  endif
+
 #  if !defined(__OPTIMIZE_SIZE__)
     // Using the PMOVMSKB instruction, we get two bits for each character
     // we compare.
@@ -1108,16 +1347,6 @@ static int ucstrncmp(const QChar *a, const uchar *c, size_t l)
         // load 16 bytes of Latin 1 data
         __m128i chunk = _mm_loadu_si128((const __m128i*)(c + offset));
 
-#  ifdef __AVX2__
-        // expand Latin 1 data via zero extension
-        __m256i ldata = _mm256_cvtepu8_epi16(chunk);
-
-        // load UTF-16 data and compare
-        __m256i ucdata = _mm256_loadu_si256((const __m256i*)(uc + offset));
-        __m256i result = _mm256_cmpeq_epi16(ldata, ucdata);
-
-        uint mask = ~_mm256_movemask_epi8(result);
-#  else
         // expand via unpacking
         __m128i firstHalf = _mm_unpacklo_epi8(chunk, nullmask);
         __m128i secondHalf = _mm_unpackhi_epi8(chunk, nullmask);
@@ -1129,7 +1358,6 @@ static int ucstrncmp(const QChar *a, const uchar *c, size_t l)
         __m128i result2 = _mm_cmpeq_epi16(secondHalf, ucdata2);
 
         uint mask = ~(_mm_movemask_epi8(result1) | _mm_movemask_epi8(result2) << 16);
-#  endif
         if (mask) {
             // found a different character
             uint idx = qCountTrailingZeroBits(mask);
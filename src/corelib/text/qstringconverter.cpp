@@ -78,18 +78,52 @@ static Q_ALWAYS_INLINE uint qBitScanReverse(unsigned v) noexcept
 #endif
 
 #if defined(__SSE2__) && defined(QT_COMPILER_SUPPORTS_SSE2)
+// The AVX2 versions of the helpers below are selected at runtime, so they are
+// used even if QtCore was built for a baseline x86 CPU. They only process
+// full 32-character blocks; they return false if they found non-ASCII
+// (updating the pointers like their callers), true to continue with SSE2.
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+QT_FUNCTION_TARGET(AVX2)
+static bool simdEncodeAscii_avx2(uchar *&dst, const ushort *&nextAscii, const ushort *&src, const ushort *end)
+{
+    // do thirty-two characters at a time
+    for ( ; end - src >= 32; src += 32, dst += 32) {
+        __m256i data1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+        __m256i data2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src) + 1);
+
+        // see below for the packing; VPACKUSWB works in 128-bit lanes, so
+        // the result needs to be put back in order
+        __m256i packed = _mm256_packus_epi16(data1, data2);
+        packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i nonAscii = _mm256_cmpgt_epi8(packed, _mm256_setzero_si256());
+
+        // store, even if there are non-ASCII characters here
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), packed);
+
+        uint n = ~uint(_mm256_movemask_epi8(nonAscii));
+        if (n) {
+            nextAscii = src + qBitScanReverse(n) + 1;
+            n = qCountTrailingZeroBits(n);
+            dst += n;
+            src += n;
+            return false;
+        }
+    }
+    return true;
+}
+#  endif
+
 static inline bool simdEncodeAscii(uchar *&dst, const ushort *&nextAscii, const ushort *&src, const ushort *end)
 {
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    if (qCpuHasFeature(AVX2) && !simdEncodeAscii_avx2(dst, nextAscii, src, end))
+        return false;
+#  endif
+
     // do sixteen characters at a time
     for ( ; end - src >= 16; src += 16, dst += 16) {
-#  ifdef __AVX2__
-        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
-        __m128i data1 = _mm256_castsi256_si128(data);
-        __m128i data2 = _mm256_extracti128_si256(data, 1);
-#  else
         __m128i data1 = _mm_loadu_si128((const __m128i*)src);
         __m128i data2 = _mm_loadu_si128(1+(const __m128i*)src);
-#  endif
 
         // check if everything is ASCII
         // the highest ASCII value is U+007F
@@ -142,26 +176,48 @@ static inline bool simdEncodeAscii(uchar *&dst, const ushort *&nextAscii, const
     return src == end;
 }
 
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+QT_FUNCTION_TARGET(AVX2)
+static bool simdDecodeAscii_avx2(ushort *&dst, const uchar *&nextAscii, const uchar *&src, const uchar *end)
+{
+    // do thirty-two characters at a time
+    for ( ; end - src >= 32; src += 32, dst += 32) {
+        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+        uint n = _mm256_movemask_epi8(data);
+        if (!n) {
+            // zero extend each half to an YMM register and store
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst),
+                                _mm256_cvtepu8_epi16(_mm256_castsi256_si128(data)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst) + 1,
+                                _mm256_cvtepu8_epi16(_mm256_extracti128_si256(data, 1)));
+            continue;
+        }
+
+        // copy the front part that is still ASCII
+        while (!(n & 1)) {
+            *dst++ = *src++;
+            n >>= 1;
+        }
+
+        n = qBitScanReverse(n);
+        nextAscii = src + n + 1;
+        return false;
+    }
+    return true;
+}
+#  endif
+
 static inline bool simdDecodeAscii(ushort *&dst, const uchar *&nextAscii, const uchar *&src, const uchar *end)
 {
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    if (qCpuHasFeature(AVX2) && !simdDecodeAscii_avx2(dst, nextAscii, src, end))
+        return false;
+#  endif
+
     // do sixteen characters at a time
     for ( ; end - src >= 16; src += 16, dst += 16) {
         __m128i data = _mm_loadu_si128((const __m128i*)src);
 
-#ifdef __AVX2__
-        const int BitSpacing = 2;
-        // load and zero extend to an YMM register
-        const __m256i extended = _mm256_cvtepu8_epi16(data);
-
-        uint n = _mm256_movemask_epi8(extended);
-        if (!n) {
-            // store
-            _mm256_storeu_si256((__m256i*)dst, extended);
-            continue;
-        }
-#else
-        const int BitSpacing = 1;
-
         // check if everything is ASCII
         // movemask extracts the high bit of every byte, so n is non-zero if something isn't ASCII
         uint n = _mm_movemask_epi8(data);
@@ -171,19 +227,18 @@ static inline bool simdDecodeAscii(ushort *&dst, const uchar *&nextAscii, const
             _mm_storeu_si128(1+(__m128i*)dst, _mm_unpackhi_epi8(data, _mm_setzero_si128()));
             continue;
         }
-#endif
 
         // copy the front part that is still ASCII
         while (!(n & 1)) {
             *dst++ = *src++;
-            n >>= BitSpacing;
+            n >>= 1;
         }
 
         // find the next probable ASCII character
         // we don't want to load 16 bytes again in this loop if we know there are non-ASCII
         // characters still coming
         n = qBitScanReverse(n);
-        nextAscii = src + (n / BitSpacing) + 1;
+        nextAscii = src + n + 1;
         return false;
 
     }
@@ -209,12 +264,13 @@ static inline bool simdDecodeAscii(ushort *&dst, const uchar *&nextAscii, const
     return src == end;
 }
 
-static inline const uchar *simdFindNonAscii(const uchar *src, const uchar *end, const uchar *&nextAscii)
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+QT_FUNCTION_TARGET(AVX2)
+static bool simdFindNonAscii_avx2(const uchar *&src, const uchar *end, const uchar *&nextAscii)
 {
-#ifdef __AVX2__
     // do 32 characters at a time
     // (this is similar to simdTestMask in qstring.cpp)
-    const __m256i mask = _mm256_set1_epi8(0x80);
+    const __m256i mask = _mm256_set1_epi8(char(0x80));
     for ( ; end - src >= 32; src += 32) {
         __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
         if (_mm256_testz_si256(mask, data))
@@ -228,10 +284,20 @@ static inline const uchar *simdFindNonAscii(const uchar *src, const uchar *end,
         // characters still coming
         nextAscii = src + qBitScanReverse(n) + 1;
 
-        // return the non-ASCII character
-        return src + qCountTrailingZeroBits(n);
+        // point to the non-ASCII character
+        src += qCountTrailingZeroBits(n);
+        return false;
     }
-#endif
+    return true;
+}
+#  endif
+
+static inline const uchar *simdFindNonAscii(const uchar *src, const uchar *end, const uchar *&nextAscii)
+{
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    if (qCpuHasFeature(AVX2) && !simdFindNonAscii_avx2(src, end, nextAscii))
+        return src;
+#  endif
 
     // do sixteen characters at a time
     for ( ; end - src >= 16; src += 16) {
@@ -269,20 +335,16 @@ static inline const uchar *simdFindNonAscii(const uchar *src, const uchar *end,
     return src;
 }
 
-// Compare only the US-ASCII beginning of [src8, end8) and [src16, end16)
-// and advance src8 and src16 to the first character that could not be compared
-static void simdCompareAscii(const char8_t *&src8, const char8_t *end8, const char16_t *&src16, const char16_t *end16)
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+// Returns the mismatch mask (two bits per character), or 0 if all sixteen
+// character blocks compared equal.
+QT_FUNCTION_TARGET(AVX2)
+static uint simdCompareAscii_avx2(const char8_t *src8, const char16_t *src16, qptrdiff len, qptrdiff &offset)
 {
-    int bitSpacing = 1;
-    qptrdiff len = qMin(end8 - src8, end16 - src16);
-    qptrdiff offset = 0;
     uint mask = 0;
-
-    // do sixteen characters at a time
     for ( ; offset + 16 < len; offset += 16) {
+        // use 256-bit registers and VPMOVXZBW
         __m128i data8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src8 + offset));
-#ifdef __AVX2__
-        // AVX2 version, use 256-bit registers and VPMOVXZBW
         __m256i data16 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src16 + offset));
 
         // expand US-ASCII as if it were Latin1 and confirm it's US-ASCII
@@ -296,8 +358,28 @@ static void simdCompareAscii(const char8_t *&src8, const char8_t *end8, const ch
         mask = ~_mm256_movemask_epi8(latin1cmp);
         if (mask)
             break;
-#else
-        // non-AVX2 code
+    }
+    return mask;
+}
+#  endif
+
+// Compare only the US-ASCII beginning of [src8, end8) and [src16, end16)
+// and advance src8 and src16 to the first character that could not be compared
+static void simdCompareAscii(const char8_t *&src8, const char8_t *end8, const char16_t *&src16, const char16_t *end16)
+{
+    int bitSpacing = 1;
+    qptrdiff len = qMin(end8 - src8, end16 - src16);
+    qptrdiff offset = 0;
+    uint mask = 0;
+
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    if (qCpuHasFeature(AVX2))
+        mask = simdCompareAscii_avx2(src8, src16, len, offset);
+#  endif
+
+    // do sixteen characters at a time
+    for ( ; mask == 0 && offset + 16 < len; offset += 16) {
+        __m128i data8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src8 + offset));
         __m128i datalo16 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src16 + offset));
         __m128i datahi16 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src16 + offset) + 1);
 
@@ -320,7 +402,6 @@ static void simdCompareAscii(const char8_t *&src8, const char8_t *end8, const ch
             bitSpacing = 0;
             break;
         }
-#endif
     }
 
     // helper for comparing 4 or 8 characters
@@ -482,6 +563,467 @@ static void simdCompareAscii(const char8_t *&, const char8_t *, const char16_t *
 }
 #endif
 
+// UTF-8 validation and decoding of non-ASCII text in blocks.
+//
+// The validator is the lookup algorithm from Keiser & Lemire, "Validating
+// UTF-8 In Less Than One Instruction Per Byte": three PSHUFB nibble lookups
+// on each byte and the one preceding it classify every error that shows in a
+// pair of bytes, and a separate check verifies that the lead bytes of three-
+// and four-byte sequences are followed by the right number of continuation
+// bytes.
+//
+// The decoders take over from QUtf8Functions::fromUtf8() after it decoded a
+// two- or three-byte sequence. One handles text made of one- and two-byte
+// sequences (U+0000 to U+07FF: Latin, Greek, Cyrillic, Hebrew, Arabic, etc.),
+// the other runs of three-byte sequences (the rest of the BMP, including
+// CJK). They only consume complete and valid sequences and leave everything
+// else to the byte-by-byte decoder, so the handling of invalid input does not
+// change.
+#if defined(__SSE2__) && defined(QT_COMPILER_SUPPORTS_SSE2)
+// Returns the position of the last sequence that may be incomplete in
+// [begin, src), so the caller can decode or validate it byte by byte.
+static inline const uchar *utf8LastSequenceStart(const uchar *begin, const uchar *src)
+{
+    const uchar *p = src;
+    while (p > begin && src - p < 3 && (p[-1] & 0xc0) == 0x80)
+        --p;
+    if (p > begin && p[-1] >= 0xc0)
+        --p;
+    return p;
+}
+
+#  if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+namespace Utf8Lookup {
+enum : uchar {
+    TooShort = 1 << 0,          // 11______ followed by 0_______ or 11______
+    TooLong = 1 << 1,           // 0_______ followed by 10______
+    Overlong3 = 1 << 2,         // 11100000 100_____
+    TooLarge = 1 << 3,          // 11110100 1001____ or 101_____, and above
+    Surrogate = 1 << 4,         // 11101101 101_____
+    Overlong2 = 1 << 5,         // 1100000_ 10______
+    TooLarge1000 = 1 << 6,      // 11110101 1000____ and above
+    Overlong4 = 1 << 6,         // 11110000 1000____
+    TwoConts = 1 << 7,          // 10______ 10______
+    Carry = TooShort | TooLong | TwoConts
+};
+
+// indexed by the high nibble of the first byte
+alignas(16) static const uchar firstHigh[16] = {
+    // 0_______: ASCII
+    TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong,
+    // 10______: continuation
+    TwoConts, TwoConts, TwoConts, TwoConts,
+    // 1100____, 1101____: two-byte lead
+    TooShort | Overlong2,
+    TooShort,
+    // 1110____: three-byte lead
+    TooShort | Overlong3 | Surrogate,
+    // 1111____: four-byte lead (or invalid)
+    TooShort | TooLarge | TooLarge1000 | Overlong4
+};
+
+// indexed by the low nibble of the first byte
+alignas(16) static const uchar firstLow[16] = {
+    Carry | Overlong3 | Overlong2 | Overlong4,      // ____0000
+    Carry | Overlong2,                              // ____0001
+    Carry,
+    Carry,
+    Carry | TooLarge,                               // ____0100
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,                // ____1___
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000 | Surrogate,    // ____1101
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000
+};
+
+// indexed by the high nibble of the second byte
+alignas(16) static const uchar secondHigh[16] = {
+    // 0_______: ASCII
+    TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort,
+    // 1000____
+    TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge1000 | Overlong4,
+    // 1001____
+    TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge,
+    // 101_____
+    TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+    TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+    // 11______
+    TooShort, TooShort, TooShort, TooShort
+};
+
+// Bytes that cannot be the last ones of the input: any lead byte in the last
+// position, a three- or four-byte lead before that and a four-byte lead in
+// the third to last position.
+alignas(32) static const uchar maxValue[32] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1
+};
+} // namespace Utf8Lookup
+
+QT_FUNCTION_TARGET(SSSE3)
+static inline __m128i utf8CheckBlock_ssse3(__m128i input, __m128i prevInput)
+{
+    const __m128i nibbleMask = _mm_set1_epi8(0x0f);
+    const __m128i prev1 = _mm_alignr_epi8(input, prevInput, 15);
+    const __m128i prev1High = _mm_and_si128(_mm_srli_epi16(prev1, 4), nibbleMask);
+    const __m128i prev1Low = _mm_and_si128(prev1, nibbleMask);
+    const __m128i inputHigh = _mm_and_si128(_mm_srli_epi16(input, 4), nibbleMask);
+
+    __m128i errors = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(Utf8Lookup::firstHigh)), prev1High);
+    errors = _mm_and_si128(errors, _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(Utf8Lookup::firstLow)), prev1Low));
+    errors = _mm_and_si128(errors, _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(Utf8Lookup::secondHigh)), inputHigh));
+
+    // the third byte of a three- or four-byte sequence and the fourth of a
+    // four-byte one must be continuations; two continuation bytes in a row
+    // are an error (TwoConts) everywhere else
+    const __m128i prev2 = _mm_alignr_epi8(input, prevInput, 14);
+    const __m128i prev3 = _mm_alignr_epi8(input, prevInput, 13);
+    const __m128i isThirdByte = _mm_subs_epu8(prev2, _mm_set1_epi8(char(0xe0 - 0x80)));
+    const __m128i isFourthByte = _mm_subs_epu8(prev3, _mm_set1_epi8(char(0xf0 - 0x80)));
+    const __m128i must23 = _mm_and_si128(_mm_or_si128(isThirdByte, isFourthByte), _mm_set1_epi8(char(0x80)));
+    return _mm_xor_si128(must23, errors);
+}
+
+QT_FUNCTION_TARGET(SSSE3)
+static bool simdValidateUtf8_ssse3(const uchar *&src, const uchar *end, bool &isValidAscii)
+{
+    const uchar *begin = src;
+    const __m128i maxValue = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Utf8Lookup::maxValue + 16));
+    __m128i prevInput = _mm_setzero_si128();
+    __m128i prevIncomplete = _mm_setzero_si128();
+    __m128i errors = _mm_setzero_si128();
+    __m128i highBits = _mm_setzero_si128();
+
+    for ( ; end - src >= 16; src += 16) {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        if (_mm_movemask_epi8(input) == 0) {
+            // all ASCII: only need to check the end of the previous block
+            errors = _mm_or_si128(errors, prevIncomplete);
+            prevIncomplete = _mm_setzero_si128();
+        } else {
+            highBits = _mm_or_si128(highBits, input);
+            errors = _mm_or_si128(errors, utf8CheckBlock_ssse3(input, prevInput));
+            prevIncomplete = _mm_subs_epu8(input, maxValue);
+        }
+        prevInput = input;
+    }
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(errors, _mm_setzero_si128())) != 0xffff)
+        return false;
+    if (_mm_movemask_epi8(highBits))
+        isValidAscii = false;
+    src = utf8LastSequenceStart(begin, src);
+    return true;
+}
+#  endif // SSSE3
+
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+QT_FUNCTION_TARGET(AVX2)
+static inline __m256i utf8CheckBlock_avx2(__m256i input, __m256i prevInput)
+{
+    // VPALIGNR works on 128-bit lanes, so bring in the high half of the
+    // previous block first
+    const __m256i prevHalf = _mm256_permute2x128_si256(prevInput, input, 0x21);
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0f);
+    const __m256i prev1 = _mm256_alignr_epi8(input, prevHalf, 15);
+    const __m256i prev1High = _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibbleMask);
+    const __m256i prev1Low = _mm256_and_si256(prev1, nibbleMask);
+    const __m256i inputHigh = _mm256_and_si256(_mm256_srli_epi16(input, 4), nibbleMask);
+
+    const __m256i firstHigh = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(Utf8Lookup::firstHigh)));
+    const __m256i firstLow = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(Utf8Lookup::firstLow)));
+    const __m256i secondHigh = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(Utf8Lookup::secondHigh)));
+    __m256i errors = _mm256_shuffle_epi8(firstHigh, prev1High);
+    errors = _mm256_and_si256(errors, _mm256_shuffle_epi8(firstLow, prev1Low));
+    errors = _mm256_and_si256(errors, _mm256_shuffle_epi8(secondHigh, inputHigh));
+
+    // see utf8CheckBlock_ssse3
+    const __m256i prev2 = _mm256_alignr_epi8(input, prevHalf, 14);
+    const __m256i prev3 = _mm256_alignr_epi8(input, prevHalf, 13);
+    const __m256i isThirdByte = _mm256_subs_epu8(prev2, _mm256_set1_epi8(char(0xe0 - 0x80)));
+    const __m256i isFourthByte = _mm256_subs_epu8(prev3, _mm256_set1_epi8(char(0xf0 - 0x80)));
+    const __m256i must23 = _mm256_and_si256(_mm256_or_si256(isThirdByte, isFourthByte), _mm256_set1_epi8(char(0x80)));
+    return _mm256_xor_si256(must23, errors);
+}
+
+QT_FUNCTION_TARGET(AVX2)
+static bool simdValidateUtf8_avx2(const uchar *&src, const uchar *end, bool &isValidAscii)
+{
+    const uchar *begin = src;
+    const __m256i maxValue = _mm256_load_si256(reinterpret_cast<const __m256i *>(Utf8Lookup::maxValue));
+    __m256i prevInput = _mm256_setzero_si256();
+    __m256i prevIncomplete = _mm256_setzero_si256();
+    __m256i errors = _mm256_setzero_si256();
+    __m256i highBits = _mm256_setzero_si256();
+
+    for ( ; end - src >= 32; src += 32) {
+        __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+        if (_mm256_movemask_epi8(input) == 0) {
+            errors = _mm256_or_si256(errors, prevIncomplete);
+            prevIncomplete = _mm256_setzero_si256();
+        } else {
+            highBits = _mm256_or_si256(highBits, input);
+            errors = _mm256_or_si256(errors, utf8CheckBlock_avx2(input, prevInput));
+            prevIncomplete = _mm256_subs_epu8(input, maxValue);
+        }
+        prevInput = input;
+    }
+
+    if (!_mm256_testz_si256(errors, errors))
+        return false;
+    if (_mm256_movemask_epi8(highBits))
+        isValidAscii = false;
+    src = utf8LastSequenceStart(begin, src);
+    return true;
+}
+#  endif // AVX2
+
+// Validates [src, end) in blocks. Returns false if an error was found;
+// otherwise, advances src to where the caller should continue validating
+// byte by byte and clears isValidAscii if it found non-ASCII characters.
+static inline bool simdValidateUtf8(const uchar *&src, const uchar *end, bool &isValidAscii)
+{
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    if (qCpuHasFeature(AVX2))
+        return simdValidateUtf8_avx2(src, end, isValidAscii);
+#  endif
+#  if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+    if (qCpuHasFeature(SSSE3))
+        return simdValidateUtf8_ssse3(src, end, isValidAscii);
+#  endif
+    Q_UNUSED(end);
+    Q_UNUSED(isValidAscii);
+    return true;
+}
+
+#  if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+// PSHUFB patterns that remove the 16-bit lanes whose bit is not set in the
+// index, moving the remaining ones to the front.
+struct Utf8CompressTable
+{
+    uchar shuffle[256][16];
+};
+
+static constexpr Utf8CompressTable makeUtf8CompressTable()
+{
+    Utf8CompressTable table = {};
+    for (int mask = 0; mask < 256; ++mask) {
+        int n = 0;
+        for (int i = 0; i < 8; ++i) {
+            if (mask & (1 << i)) {
+                table.shuffle[mask][2 * n] = uchar(2 * i);
+                table.shuffle[mask][2 * n + 1] = uchar(2 * i + 1);
+                ++n;
+            }
+        }
+        for ( ; n < 8; ++n)
+            table.shuffle[mask][2 * n] = table.shuffle[mask][2 * n + 1] = 0x80;
+    }
+    return table;
+}
+
+alignas(16) static constexpr Utf8CompressTable utf8CompressTable = makeUtf8CompressTable();
+
+// Decodes text made of one- and two-byte sequences (U+0000 to U+07FF, that
+// is, Latin, Greek, Cyrillic, Hebrew, Arabic, etc. mixed with US-ASCII),
+// eight bytes at a time. Stops at the first block with anything else in it,
+// including invalid sequences, or if there is a block of US-ASCII that
+// simdDecodeAscii() can deal with faster.
+QT_FUNCTION_TARGET(SSSE3)
+static void simdDecodeUtf8TwoBytes_ssse3(ushort *&dst, const uchar *&src, const uchar *end)
+{
+    for ( ; end - src >= 16; ) {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        if (_mm_movemask_epi8(data) == 0)
+            return;
+
+        // classify the first nine bytes: we decode the sequences starting in
+        // the first eight, so we may need the ninth to complete the last one
+        const uint cont = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(data, _mm_set1_epi8(char(0xc0))),
+                                                           _mm_set1_epi8(char(0x80))));
+        const uint lead = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(data, _mm_set1_epi8(char(0xe0))),
+                                                           _mm_set1_epi8(char(0xc0))));
+        // three- and four-byte leads, plus 0xC0 and 0xC1 (overlong US-ASCII)
+        const __m128i invalid = _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(data, _mm_set1_epi8(char(0xe0))), data),
+                                             _mm_cmpeq_epi8(_mm_and_si128(data, _mm_set1_epi8(char(0xfe))),
+                                                            _mm_set1_epi8(char(0xc0))));
+
+        // each continuation byte must follow a lead byte and vice-versa
+        if ((_mm_movemask_epi8(invalid) & 0xff) || ((lead << 1) ^ cont) & 0xff
+                || (lead & 0x80 && !(cont & 0x100)))
+            return;
+
+        // decode every byte as if it started a sequence
+        const __m128i bytes = _mm_unpacklo_epi8(data, _mm_setzero_si128());
+        const __m128i next = _mm_unpacklo_epi8(_mm_srli_si128(data, 1), _mm_setzero_si128());
+        const __m128i ascii = _mm_cmplt_epi16(bytes, _mm_set1_epi16(0x80));
+        __m128i result = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(bytes, _mm_set1_epi16(0x1f)), 6),
+                                      _mm_and_si128(next, _mm_set1_epi16(0x3f)));
+        result = _mm_or_si128(_mm_and_si128(ascii, bytes), _mm_andnot_si128(ascii, result));
+
+        // and keep only the ones that did
+        const uint starts = ~cont & 0xff;
+        const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i *>(utf8CompressTable.shuffle[starts]));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_shuffle_epi8(result, shuffle));
+        dst += qPopulationCount(starts);
+        src += 8 + (lead >> 7 & 1);
+    }
+}
+
+// PSHUFB patterns that put the first two bytes of four three-byte sequences
+// in the low 64 bits (lead byte in the high half of each 16-bit lane) and the
+// third bytes in the high 64 bits. The second pattern is for a load starting
+// 8 bytes later, for the next four sequences.
+#    define UTF8_THREE_BYTE_SHUFFLE1    1, 0, 4, 3, 7, 6, 10, 9, 2, -1, 5, -1, 8, -1, 11, -1
+#    define UTF8_THREE_BYTE_SHUFFLE2    5, 4, 8, 7, 11, 10, 14, 13, 6, -1, 9, -1, 12, -1, 15, -1
+
+// Returns the mask of lanes holding valid sequences.
+QT_FUNCTION_TARGET(SSSE3)
+static inline uint utf8DecodeThreeBytes(__m128i first, __m128i second, __m128i &result)
+{
+    const __m128i high = _mm_unpacklo_epi64(first, second);
+    const __m128i low = _mm_unpackhi_epi64(first, second);
+    const __m128i shape = _mm_and_si128(
+                _mm_cmpeq_epi16(_mm_and_si128(high, _mm_set1_epi16(short(0xf0c0))), _mm_set1_epi16(short(0xe080))),
+                _mm_cmpeq_epi16(_mm_and_si128(low, _mm_set1_epi16(0xc0)), _mm_set1_epi16(0x80)));
+    result = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(high, _mm_set1_epi16(0x0f00)), 4),
+                          _mm_slli_epi16(_mm_and_si128(high, _mm_set1_epi16(0x3f)), 6));
+    result = _mm_or_si128(result, _mm_and_si128(low, _mm_set1_epi16(0x3f)));
+
+    // reject overlong forms (below U+0800) and surrogates
+    const __m128i top = _mm_and_si128(result, _mm_set1_epi16(short(0xf800)));
+    const __m128i invalid = _mm_or_si128(_mm_cmpeq_epi16(top, _mm_setzero_si128()),
+                                         _mm_cmpeq_epi16(top, _mm_set1_epi16(short(0xd800))));
+    return _mm_movemask_epi8(_mm_andnot_si128(invalid, shape));
+}
+
+#    if QT_COMPILER_SUPPORTS_HERE(AVX2)
+QT_FUNCTION_TARGET(AVX2)
+static bool simdDecodeUtf8ThreeBytes_avx2(ushort *&dst, const uchar *&src, const uchar *end)
+{
+    // VPSHUFB works on 128-bit lanes, so load the first eight sequences in
+    // the low lane and the next eight in the high one
+    const __m256i shuffle1 = _mm256_setr_epi8(UTF8_THREE_BYTE_SHUFFLE1, UTF8_THREE_BYTE_SHUFFLE1);
+    const __m256i shuffle2 = _mm256_setr_epi8(UTF8_THREE_BYTE_SHUFFLE2, UTF8_THREE_BYTE_SHUFFLE2);
+
+    // sixteen characters (48 bytes) at a time, see utf8DecodeThreeBytes
+    for ( ; end - src >= 48; src += 48, dst += 16) {
+        __m256i first = _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src)));
+        first = _mm256_inserti128_si256(first, _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 24)), 1);
+        __m256i second = _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 8)));
+        second = _mm256_inserti128_si256(second, _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32)), 1);
+        first = _mm256_shuffle_epi8(first, shuffle1);
+        second = _mm256_shuffle_epi8(second, shuffle2);
+        __m256i high = _mm256_unpacklo_epi64(first, second);
+        __m256i low = _mm256_unpackhi_epi64(first, second);
+        __m256i shape = _mm256_and_si256(
+                    _mm256_cmpeq_epi16(_mm256_and_si256(high, _mm256_set1_epi16(short(0xf0c0))), _mm256_set1_epi16(short(0xe080))),
+                    _mm256_cmpeq_epi16(_mm256_and_si256(low, _mm256_set1_epi16(0xc0)), _mm256_set1_epi16(0x80)));
+        __m256i result = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(high, _mm256_set1_epi16(0x0f00)), 4),
+                                         _mm256_slli_epi16(_mm256_and_si256(high, _mm256_set1_epi16(0x3f)), 6));
+        result = _mm256_or_si256(result, _mm256_and_si256(low, _mm256_set1_epi16(0x3f)));
+        __m256i top = _mm256_and_si256(result, _mm256_set1_epi16(short(0xf800)));
+        __m256i invalid = _mm256_or_si256(_mm256_cmpeq_epi16(top, _mm256_setzero_si256()),
+                                          _mm256_cmpeq_epi16(top, _mm256_set1_epi16(short(0xd800))));
+        uint valid = _mm256_movemask_epi8(_mm256_andnot_si256(invalid, shape));
+
+        // store, even if there are invalid sequences
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), result);
+        if (valid != ~0U) {
+            uint n = qCountTrailingZeroBits(~valid) / 2;
+            src += 3 * n;
+            dst += n;
+            return false;
+        }
+    }
+    return true;
+}
+#    endif
+
+QT_FUNCTION_TARGET(SSSE3)
+static void simdDecodeUtf8ThreeBytes_ssse3(ushort *&dst, const uchar *&src, const uchar *end)
+{
+#    if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    if (qCpuHasFeature(AVX2) && !simdDecodeUtf8ThreeBytes_avx2(dst, src, end))
+        return;
+#    endif
+
+    const __m128i shuffle1 = _mm_setr_epi8(UTF8_THREE_BYTE_SHUFFLE1);
+    const __m128i shuffle2 = _mm_setr_epi8(UTF8_THREE_BYTE_SHUFFLE2);
+
+    // eight characters (24 bytes) at a time
+    for ( ; end - src >= 24; src += 24, dst += 8) {
+        __m128i first = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src)), shuffle1);
+        __m128i second = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 8)), shuffle2);
+        __m128i result;
+        uint valid = utf8DecodeThreeBytes(first, second, result);
+
+        // store, even if there are invalid sequences
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), result);
+        if (valid != 0xffff) {
+            uint n = qCountTrailingZeroBits(~valid) / 2;
+            src += 3 * n;
+            dst += n;
+            return;
+        }
+    }
+}
+#    undef UTF8_THREE_BYTE_SHUFFLE1
+#    undef UTF8_THREE_BYTE_SHUFFLE2
+
+static Q_NEVER_INLINE void simdDecodeNonAscii_ssse3(ushort *&dst, const uchar *&src, const uchar *end)
+{
+    // alternate between the two decoders for as long as one makes progress
+    const uchar *begin;
+    do {
+        begin = src;
+        if ((*src & 0xf0) == 0xe0)
+            simdDecodeUtf8ThreeBytes_ssse3(dst, src, end);
+        else
+            simdDecodeUtf8TwoBytes_ssse3(dst, src, end);
+    } while (src != begin && end - src >= 16);
+}
+#  endif // SSSE3
+
+// Called after the caller decoded a multi-byte sequence, to decode the rest
+// of the text in the same script in blocks.
+static Q_ALWAYS_INLINE void simdDecodeNonAscii(ushort *&dst, const uchar *&src, const uchar *end)
+{
+#  if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+    if (end - src < 16 || !qCpuHasFeature(SSSE3))
+        return;
+
+    // work on copies, so the caller's pointers can stay in registers
+    ushort *d = dst;
+    const uchar *s = src;
+    simdDecodeNonAscii_ssse3(d, s, end);
+    dst = d;
+    src = s;
+#  else
+    Q_UNUSED(dst);
+    Q_UNUSED(src);
+    Q_UNUSED(end);
+#  endif
+}
+#else
+static inline bool simdValidateUtf8(const uchar *&, const uchar *, bool &)
+{
+    return true;
+}
+
+static inline void simdDecodeNonAscii(ushort *&, const uchar *&, const uchar *)
+{
+}
+#endif
+
 enum { HeaderDone = 1 };
 
 QByteArray QUtf8::convertFromUnicode(QStringView in)
@@ -659,6 +1201,9 @@ QChar *QUtf8::convertToUnicode(QChar *buffer, QByteArrayView in) noexcept
                 if (res < 0) {
                     // decoding error
                     *dst++ = QChar::ReplacementCharacter;
+                } else if (res == 2 || res == 3) {
+                    // try to decode the rest of this run in blocks
+                    simdDecodeNonAscii(dst, src, end);
                 }
             } while (src < nextAscii);
         }
@@ -763,6 +1308,8 @@ QChar *QUtf8::convertToUnicode(QChar *out, QByteArrayView in, QStringConverter::
             res = 0;
             ++state->invalidChars;
             *dst++ = replacement;
+        } else if (res == 2 || res == 3) {
+            simdDecodeNonAscii(dst, src, end);
         }
     }
 
@@ -802,6 +1349,9 @@ QUtf8::ValidUtf8Result QUtf8::isValidUtf8(QByteArrayView in)
     const uchar *nextAscii = src;
     bool isValidAscii = true;
 
+    if (!simdValidateUtf8(src, end, isValidAscii))
+        return { false, false };
+
     while (src < end) {
         if (src >= nextAscii)
             src = simdFindNonAscii(src, end, nextAscii);
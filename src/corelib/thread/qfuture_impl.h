@@ -476,23 +476,35 @@ void Continuation<Function, ResultType, ParentResultType>::create(F &&func,
 
     p.setLaunchAsync(launchAsync);
 
+    // A synchronous continuation of a future that has already finished can run
+    // right away; there is no need to wrap it into a std::function first.
+    // Finished is never cleared, so checking it without the continuation mutex
+    // is fine, and setContinuation() would run it immediately anyway.
+    if (!launchAsync && f->isFinished()) {
+        SyncContinuation<Function, ResultType, ParentResultType> continuationJob(
+                std::forward<F>(func), *f, p);
+        continuationJob.execute();
+        return;
+    }
+
     auto continuation = [func = std::forward<F>(func), p, pool,
                          launchAsync](const QFutureInterfaceBase &parentData) mutable {
         const auto parent = QFutureInterface<ParentResultType>(parentData).future();
-        Continuation<Function, ResultType, ParentResultType> *continuationJob = nullptr;
-        if (launchAsync) {
-            continuationJob = new AsyncContinuation<Function, ResultType, ParentResultType>(
-                    std::forward<Function>(func), parent, p, pool);
-        } else {
-            continuationJob = new SyncContinuation<Function, ResultType, ParentResultType>(
+        if (!launchAsync) {
+            // Synchronous continuations are executed immediately, so they can
+            // live on the stack.
+            SyncContinuation<Function, ResultType, ParentResultType> continuationJob(
                     std::forward<Function>(func), parent, p);
+            continuationJob.execute();
+            return;
         }
 
+        auto continuationJob = new AsyncContinuation<Function, ResultType, ParentResultType>(
+                std::forward<Function>(func), parent, p, pool);
         bool isLaunched = continuationJob->execute();
         // If continuation is successfully launched, AsyncContinuation will be deleted
-        // by the QThreadPool which has started it. Synchronous continuation will be
-        // executed immediately, so it's safe to always delete it here.
-        if (!(launchAsync && isLaunched)) {
+        // by the QThreadPool which has started it.
+        if (!isLaunched) {
             delete continuationJob;
             continuationJob = nullptr;
         }
@@ -49,9 +49,13 @@
 #include "qelapsedtimer.h"
 #include "private/qfreelist_p.h"
 #include "private/qlocking_p.h"
+#include "qfutex_p.h"
+#include "qdeadlinetimer.h"
 
 QT_BEGIN_NAMESPACE
 
+using namespace QtFutex;
+
 /*
  * Implementation details of QReadWriteLock:
  *
@@ -62,6 +66,17 @@ QT_BEGIN_NAMESPACE
  *    are waiting, and the lock is not recursive.
  *  - when d_ptr == 0x2: We are locked for write and nobody is waiting. (no contention)
  *  - In any other case, d_ptr points to an actual QReadWriteLockPrivate.
+ *
+ * On platforms with futexes, a non-recursive lock never uses a QReadWriteLockPrivate.
+ * Instead, d_ptr holds the whole state and waiters sleep on its low 32 bits:
+ *  - bit 0x1: locked for read; d_ptr>>16 is the number of reading threads minus 1.
+ *  - bit 0x2: locked for write.
+ *  - bit 0x4: readers are waiting for the lock.
+ *  - bits 3 to 15: the number of writers waiting for the lock. As long as that is
+ *    non-zero, no new reader gets the lock, so writers are not starved by readers.
+ * These values never point to an actual QReadWriteLockPrivate: those are never
+ * allocated in the first 64 kB of the address space. Recursive locks always use
+ * one, regardless of the platform.
  */
 
 namespace {
@@ -70,10 +85,150 @@ enum {
     StateLockedForRead = 0x1,
     StateLockedForWrite = 0x2,
 };
+enum : quintptr {
+    FutexReadersWaiting = 0x4,
+    FutexWriterWaitingIncrement = 0x8,
+    FutexWritersWaitingMask = 0xfff8,
+    FutexReaderIncrement = 0x10000,
+    FutexReaderCountMask = ~quintptr(0xffff)
+};
 const auto dummyLockedForRead = reinterpret_cast<QReadWriteLockPrivate *>(quintptr(StateLockedForRead));
 const auto dummyLockedForWrite = reinterpret_cast<QReadWriteLockPrivate *>(quintptr(StateLockedForWrite));
 inline bool isUncontendedLocked(const QReadWriteLockPrivate *d)
 { return quintptr(d) & StateMask; }
+inline bool isPrivate(const QReadWriteLockPrivate *d)
+{ return !isUncontendedLocked(d) && quintptr(d) > FutexWritersWaitingMask; }
+inline QReadWriteLockPrivate *futexState(quintptr v)
+{ return reinterpret_cast<QReadWriteLockPrivate *>(v); }
+
+bool futexWaitUntil(QAtomicPointer<QReadWriteLockPrivate> &d_ptr, quintptr expected,
+                    QDeadlineTimer deadline)
+{
+    if (deadline.isForever()) {
+        futexWait(d_ptr, futexState(expected));
+        return true;
+    }
+    qint64 remainingTime = deadline.remainingTimeNSecs();
+    if (remainingTime <= 0)
+        return false;
+    return futexWait(d_ptr, futexState(expected), remainingTime);
+}
+
+bool futexLockForRead(QAtomicPointer<QReadWriteLockPrivate> &d_ptr, QReadWriteLockPrivate *d,
+                      int timeout)
+{
+    QDeadlineTimer deadline(timeout);
+    quintptr v = quintptr(d);
+    forever {
+        if (!(v & (StateLockedForWrite | FutexWritersWaitingMask))) {
+            // unlocked, or locked for read with no writer waiting: join in
+            const quintptr n = (v & StateLockedForRead) ? v + FutexReaderIncrement
+                                                        : v | StateLockedForRead;
+            Q_ASSERT_X(n > v, "QReadWriteLock::tryLockForRead()", "Overflow in lock counter");
+            if (d_ptr.testAndSetAcquire(futexState(v), futexState(n), d))
+                return true;
+            v = quintptr(d);
+            continue;
+        }
+
+        if (timeout == 0)
+            return false;
+        if (!(v & FutexReadersWaiting)) {
+            if (!d_ptr.testAndSetRelaxed(futexState(v), futexState(v | FutexReadersWaiting), d)) {
+                v = quintptr(d);
+                continue;
+            }
+            v |= FutexReadersWaiting;
+        }
+        if (!futexWaitUntil(d_ptr, v, deadline))
+            return false;
+        v = quintptr(d_ptr.loadRelaxed());
+    }
+}
+
+bool futexLockForWrite(QAtomicPointer<QReadWriteLockPrivate> &d_ptr, QReadWriteLockPrivate *d,
+                       int timeout)
+{
+    QDeadlineTimer deadline(timeout);
+    quintptr v = quintptr(d);
+    bool waiting = false;   // whether we are counted in the waiting writers
+    forever {
+        if (!(v & StateMask)) {
+            quintptr n = v | StateLockedForWrite;
+            if (waiting)
+                n -= FutexWriterWaitingIncrement;
+            if (d_ptr.testAndSetAcquire(futexState(v), futexState(n), d))
+                return true;
+            v = quintptr(d);
+            continue;
+        }
+
+        if (timeout == 0)
+            return false;
+        if (!waiting) {
+            const quintptr n = v + FutexWriterWaitingIncrement;
+            Q_ASSERT_X(n & FutexWritersWaitingMask, "QReadWriteLock::tryLockForWrite()",
+                       "Overflow in waiting writer counter");
+            if (!d_ptr.testAndSetRelaxed(futexState(v), futexState(n), d)) {
+                v = quintptr(d);
+                continue;
+            }
+            v = n;
+            waiting = true;
+        }
+        if (!futexWaitUntil(d_ptr, v, deadline))
+            break;
+        v = quintptr(d_ptr.loadRelaxed());
+    }
+
+    // We timed out. Stop holding back the readers if we were the last writer waiting,
+    // and pass on a wake-up we might have swallowed if the lock is free.
+    v = quintptr(d_ptr.loadRelaxed());
+    forever {
+        quintptr n = v - FutexWriterWaitingIncrement;
+        bool wake = false;
+        if (!(n & (FutexWritersWaitingMask | StateLockedForWrite)) && (n & FutexReadersWaiting)) {
+            n &= ~FutexReadersWaiting;
+            wake = true;
+        } else if (!(n & StateMask) && (n & FutexWritersWaitingMask)) {
+            wake = true;
+        }
+        if (d_ptr.testAndSetRelaxed(futexState(v), futexState(n), d)) {
+            if (wake)
+                futexWakeAll(d_ptr);
+            return false;
+        }
+        v = quintptr(d);
+    }
+}
+
+void futexUnlock(QAtomicPointer<QReadWriteLockPrivate> &d_ptr, QReadWriteLockPrivate *d)
+{
+    quintptr v = quintptr(d);
+    forever {
+        Q_ASSERT_X(v & StateMask, "QReadWriteLock::unlock()", "Cannot unlock an unlocked lock");
+        if ((v & StateLockedForRead) && (v & FutexReaderCountMask)) {
+            // other readers remain
+            if (d_ptr.testAndSetRelease(futexState(v), futexState(v - FutexReaderIncrement), d))
+                return;
+            v = quintptr(d);
+            continue;
+        }
+
+        // Last one out. Only the count of waiting writers survives, as everyone
+        // that sleeps gets woken up and re-registers if needed. If no reader is
+        // waiting, all sleepers are writers and only one of them can get the lock.
+        const quintptr n = v & FutexWritersWaitingMask;
+        if (d_ptr.testAndSetRelease(futexState(v), futexState(n), d)) {
+            if (v & FutexReadersWaiting)
+                futexWakeAll(d_ptr);
+            else if (n)
+                futexWakeOne(d_ptr);
+            return;
+        }
+        v = quintptr(d);
+    }
+}
 }
 
 /*! \class QReadWriteLock
@@ -156,7 +311,7 @@ QReadWriteLock::QReadWriteLock(RecursionMode recursionMode)
 QReadWriteLock::~QReadWriteLock()
 {
     auto d = d_ptr.loadRelaxed();
-    if (isUncontendedLocked(d)) {
+    if (d && !isPrivate(d)) {
         qWarning("QReadWriteLock: destroying locked QReadWriteLock");
         return;
     }
@@ -226,6 +381,9 @@ bool QReadWriteLock::tryLockForRead(int timeout)
     if (d_ptr.testAndSetAcquire(nullptr, dummyLockedForRead, d))
         return true;
 
+    if (futexAvailable() && !isPrivate(d))
+        return futexLockForRead(d_ptr, d, timeout);
+
     while (true) {
         if (d == nullptr) {
             if (!d_ptr.testAndSetAcquire(nullptr, dummyLockedForRead, d))
@@ -340,6 +498,9 @@ bool QReadWriteLock::tryLockForWrite(int timeout)
     if (d_ptr.testAndSetAcquire(nullptr, dummyLockedForWrite, d))
         return true;
 
+    if (futexAvailable() && !isPrivate(d))
+        return futexLockForWrite(d_ptr, d, timeout);
+
     while (true) {
         if (d == nullptr) {
             if (!d_ptr.testAndSetAcquire(d, dummyLockedForWrite, d))
@@ -393,6 +554,9 @@ bool QReadWriteLock::tryLockForWrite(int timeout)
 void QReadWriteLock::unlock()
 {
     QReadWriteLockPrivate *d = d_ptr.loadAcquire();
+    if (futexAvailable() && !isPrivate(d))
+        return futexUnlock(d_ptr, d);
+
     while (true) {
         Q_ASSERT_X(d, "QReadWriteLock::unlock()", "Cannot unlock an unlocked lock");
 
@@ -451,7 +615,7 @@ QReadWriteLock::StateForWaitCondition QReadWriteLock::stateForWaitCondition() co
     case StateLockedForWrite: return LockedForWrite;
     }
 
-    if (!d)
+    if (!isPrivate(d))
         return Unlocked;
     if (d->writerCount > 1)
         return RecursivelyLocked;
@@ -150,7 +150,8 @@ bool ResultIteratorBase::isValid() const
 }
 
 ResultStoreBase::ResultStoreBase()
-    : insertIndex(0), resultCount(0), m_filterMode(false), filteredResults(0) { }
+    : insertIndex(0), resultCount(0), m_filterMode(false), filteredResults(0),
+      m_inlineResultInUse(false) { }
 
 ResultStoreBase::~ResultStoreBase()
 {
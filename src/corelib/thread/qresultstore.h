@@ -43,6 +43,8 @@
 #include <QtCore/qmap.h>
 #include <QtCore/qdebug.h>
 
+#include <cstddef>
+#include <new>
 #include <utility>
 
 QT_REQUIRE_CONFIG(future);
@@ -154,15 +156,53 @@ protected:
     QMap<int, ResultItem> pendingResults;
     int filteredResults;
 
+    // The first single result that fits is constructed in place here rather
+    // than on the heap; most futures (and every continuation) carry just one.
+    enum { InlineResultSize = 4 * sizeof(void *) };
+    alignas(std::max_align_t) char m_inlineResult[InlineResultSize];
+    bool m_inlineResultInUse;
+
+    template <typename T>
+    static constexpr bool fitsInline()
+    {
+        return sizeof(T) <= InlineResultSize && alignof(T) <= alignof(std::max_align_t);
+    }
+
+    template <typename T, typename... Args>
+    void *createResult(Args &&... args)
+    {
+        if constexpr (fitsInline<T>()) {
+            if (!m_inlineResultInUse) {
+                void *result = new (m_inlineResult) T(std::forward<Args>(args)...);
+                m_inlineResultInUse = true;
+                return result;
+            }
+        }
+        return new T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void destroyResult(const T *result)
+    {
+        if constexpr (fitsInline<T>()) {
+            if (static_cast<const void *>(result) == m_inlineResult) {
+                result->~T();
+                m_inlineResultInUse = false;
+                return;
+            }
+        }
+        delete result;
+    }
+
     template <typename T>
-    static void clear(QMap<int, ResultItem> &store)
+    void clear(QMap<int, ResultItem> &store)
     {
         QMap<int, ResultItem>::const_iterator mapIterator = store.constBegin();
         while (mapIterator != store.constEnd()) {
             if (mapIterator.value().isVector())
                 delete reinterpret_cast<const QList<T> *>(mapIterator.value().result);
             else
-                delete reinterpret_cast<const T *>(mapIterator.value().result);
+                destroyResult(reinterpret_cast<const T *>(mapIterator.value().result));
             ++mapIterator;
         }
         store.clear();
@@ -178,7 +218,7 @@ public:
         if (result == nullptr)
             return addResult(index, static_cast<void *>(nullptr));
 
-        return addResult(index, static_cast<void *>(new T(*result)));
+        return addResult(index, createResult<T>(*result));
     }
 
     template <typename T>
@@ -187,7 +227,7 @@ public:
         if (containsValidResultItem(index)) // reject if already present
             return -1;
 
-        return addResult(index, static_cast<void *>(new T(std::move_if_noexcept(result))));
+        return addResult(index, createResult<T>(std::move_if_noexcept(result)));
     }
 
     template<typename T>
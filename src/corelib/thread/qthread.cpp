@@ -93,6 +93,7 @@ QThreadData::~QThreadData()
     thread.storeRelease(nullptr);
     delete t;
 
+    takeIncomingPostedEvents();
     for (int i = 0; i < postEventList.size(); ++i) {
         const QPostEvent &pe = postEventList.at(i);
         if (pe.event) {
@@ -102,9 +103,36 @@ QThreadData::~QThreadData()
         }
     }
 
+#if QT_CONFIG(eventstatistics)
+    QEventStatistics::release(this);
+#endif
+
     // fprintf(stderr, "QThreadData %p destroyed\n", this);
 }
 
+/*
+    Moves the events that were posted lock-free into the sorted postEventList,
+    in the order they were posted. Must be called with postEventList.mutex
+    held, before anything inspects or modifies the list.
+*/
+void QThreadData::takeIncomingPostedEvents()
+{
+    QPostEventInbox &incoming = postEventList.incoming;
+    while (!incoming.isEmpty()) {
+        QPostEventInbox::Node *node = incoming.pop();
+        if (!node) {
+            // a poster has claimed the tail but not linked its node yet
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        const QPostEvent &pe = node->event;
+        ++QObjectPrivate::get(pe.receiver)->postedEvents;
+        postEventList.addEvent(pe);
+        canWait = false;
+        delete node;
+    }
+}
+
 void QThreadData::ref()
 {
 #if QT_CONFIG(thread)
@@ -63,6 +63,9 @@
 #include "QtCore/qmap.h"
 #include "QtCore/qcoreapplication.h"
 #include "private/qobject_p.h"
+#if QT_CONFIG(eventstatistics)
+#include "private/qeventstatistics_p.h"
+#endif
 
 #include <algorithm>
 #include <atomic>
@@ -78,12 +81,23 @@ public:
     QObject *receiver;
     QEvent *event;
     int priority;
+#if QT_CONFIG(eventstatistics)
+    qint64 postTime; // 0 unless event statistics are being recorded
+#endif
     inline QPostEvent()
         : receiver(nullptr), event(nullptr), priority(0)
-    { }
+    {
+#if QT_CONFIG(eventstatistics)
+        postTime = 0;
+#endif
+    }
     inline QPostEvent(QObject *r, QEvent *e, int p)
         : receiver(r), event(e), priority(p)
-    { }
+    {
+#if QT_CONFIG(eventstatistics)
+        postTime = QEventStatistics::isEnabled() ? QEventStatistics::currentTime() : 0;
+#endif
+    }
 };
 Q_DECLARE_TYPEINFO(QPostEvent, Q_RELOCATABLE_TYPE);
 
@@ -92,6 +106,68 @@ inline bool operator<(const QPostEvent &first, const QPostEvent &second)
     return first.priority > second.priority;
 }
 
+// Lock-free multi-producer, single-consumer queue of posted events. This is
+// Dmitry Vyukov's intrusive node-based queue: producers only swap the tail,
+// and the consumer (whoever holds the QPostEventList mutex) walks from head.
+class QPostEventInbox
+{
+public:
+    struct Node
+    {
+        QAtomicPointer<Node> next;
+        QPostEvent event;
+    };
+
+    QPostEventInbox() : head(&stub), tail(&stub) { }
+    ~QPostEventInbox() { Q_ASSERT(isEmpty()); }
+
+    // may be called from any thread
+    bool isEmpty() const { return tail.loadAcquire() == &stub; }
+
+    // may be called from any thread
+    void push(Node *node)
+    {
+        node->next.storeRelaxed(nullptr);
+        Node *prev = tail.fetchAndStoreOrdered(node);
+        prev->next.storeRelease(node);
+    }
+
+    // consumer only; returns nullptr if the queue is empty or if the next
+    // node has been claimed by a producer that hasn't linked it in yet
+    Node *pop()
+    {
+        Node *h = head;
+        Node *next = h->next.loadAcquire();
+        if (h == &stub) {
+            if (!next)
+                return nullptr;
+            head = next;
+            h = next;
+            next = next->next.loadAcquire();
+        }
+        if (next) {
+            head = next;
+            return h;
+        }
+        if (h != tail.loadAcquire())
+            return nullptr;
+        push(&stub);
+        next = h->next.loadAcquire();
+        if (next) {
+            head = next;
+            return h;
+        }
+        return nullptr;
+    }
+
+private:
+    Q_DISABLE_COPY_MOVE(QPostEventInbox)
+
+    Node stub;
+    Node *head;
+    alignas(64) QAtomicPointer<Node> tail;
+};
+
 // This class holds the list of posted events.
 //  The list has to be kept sorted by priority
 class QPostEventList : public QList<QPostEvent>
@@ -107,8 +183,36 @@ public:
 
     QMutex mutex;
 
+    // events posted without taking the mutex; see QCoreApplication::postEvent()
+    // and QThreadData::takeIncomingPostedEvents()
+    QPostEventInbox incoming;
+    // bit 0 is set while lock-free posting is blocked (by QObject::moveToThread),
+    // the remaining bits count the posters currently pushing to incoming
+    QAtomicInt incomingState;
+
     inline QPostEventList() : QList<QPostEvent>(), recursion(0), startOffset(0), insertionOffset(0) { }
 
+    // Returns false if lock-free posting is currently blocked, in which case
+    // the caller must fall back to taking the mutex.
+    bool beginIncomingPost()
+    {
+        if (incomingState.fetchAndAddOrdered(2) & 1) {
+            incomingState.fetchAndSubOrdered(2);
+            return false;
+        }
+        return true;
+    }
+    void endIncomingPost() { incomingState.fetchAndSubRelease(2); }
+
+    // requires the mutex; waits for the posters already past beginIncomingPost()
+    void blockIncomingPosts()
+    {
+        incomingState.fetchAndOrOrdered(1);
+        while (incomingState.loadAcquire() != 1)
+            QThread::yieldCurrentThread();
+    }
+    void unblockIncomingPosts() { incomingState.fetchAndAndRelease(~1); }
+
     void addEvent(const QPostEvent &ev)
     {
         int priority = ev.priority;
@@ -257,9 +361,11 @@ public:
     bool canWaitLocked()
     {
         QMutexLocker locker(&postEventList.mutex);
-        return canWait;
+        return canWait && postEventList.incoming.isEmpty();
     }
 
+    void takeIncomingPostedEvents();
+
     // This class provides per-thread (by way of being a QThreadData
     // member) storage for qFlagLocation()
     class FlaggedDebugSignatures
@@ -294,6 +400,9 @@ public:
     QAtomicPointer<QAbstractEventDispatcher> eventDispatcher;
     QList<void *> tls;
     FlaggedDebugSignatures flaggedSignatures;
+#if QT_CONFIG(eventstatistics)
+    QEventStatistics *eventStatistics = nullptr;
+#endif
 
     bool quitNow;
     bool canWait;
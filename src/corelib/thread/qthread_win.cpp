@@ -343,6 +343,9 @@ void QThreadPrivate::finish(void *arg, bool lockAnyway) noexcept
     emit thr->finished(QThread::QPrivateSignal());
     QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
     QThreadStorageData::finish(tls_data);
+#if QT_CONFIG(eventstatistics)
+    QEventStatistics::threadFinished(d->data);
+#endif
     locker.relock();
 
     QAbstractEventDispatcher *eventDispatcher = d->data->eventDispatcher.loadRelaxed();
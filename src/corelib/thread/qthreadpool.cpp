@@ -43,6 +43,7 @@
 #include "qcoreapplication.h"
 
 #include <algorithm>
+#include <atomic>
 
 QT_BEGIN_NAMESPACE
 
@@ -60,8 +61,12 @@ public:
     QWaitCondition runnableReady;
     QThreadPoolPrivate *manager;
     QRunnable *runnable;
+    int homeQueue;
 };
 
+// the pool thread running on the current thread, if any
+static thread_local QThreadPoolThread *currentPoolThread = nullptr;
+
 /*
     QThreadPool private class.
 */
@@ -71,8 +76,9 @@ public:
     \internal
 */
 QThreadPoolThread::QThreadPoolThread(QThreadPoolPrivate *manager)
-    :manager(manager), runnable(nullptr)
+    :manager(manager), runnable(nullptr), homeQueue(manager->nextHomeQueue)
 {
+    manager->nextHomeQueue = (homeQueue + 1) % manager->queueCount;
     setStackSize(manager->stackSize);
 }
 
@@ -81,18 +87,20 @@ QThreadPoolThread::QThreadPoolThread(QThreadPoolPrivate *manager)
 */
 void QThreadPoolThread::run()
 {
+    currentPoolThread = this;
     QMutexLocker locker(&manager->mutex);
     for(;;) {
         QRunnable *r = runnable;
         runnable = nullptr;
 
+        // the run queues have their own locks
+        locker.unlock();
         do {
             if (r) {
                 // If autoDelete() is false, r might already be deleted after run(), so check status now.
                 const bool del = r->autoDelete();
 
                 // run the task
-                locker.unlock();
 #ifndef QT_NO_EXCEPTIONS
                 try {
 #endif
@@ -109,37 +117,43 @@ void QThreadPoolThread::run()
 
                 if (del)
                     delete r;
-                locker.relock();
             }
 
-            // if too many threads are active, expire this thread
-            if (manager->tooManyThreadsActive())
-                break;
-
-            if (manager->queue.isEmpty()) {
-                r = nullptr;
+            // if too many threads might be active, check below
+            if (manager->overCommitted.loadRelaxed())
                 break;
-            }
 
-            QueuePage *page = manager->queue.first();
-            r = page->pop();
-
-            if (page->isFinished()) {
-                manager->queue.removeFirst();
-                delete page;
-            }
-        } while (true);
+            r = manager->dequeueTask(homeQueue);
+        } while (r);
+        locker.relock();
 
         // if too many threads are active, expire this thread
         bool expired = manager->tooManyThreadsActive();
         if (!expired) {
             manager->waitingThreads.enqueue(this);
             registerThreadInactive();
+            manager->updateThreadState();
+
+            // QThreadPool::start() queues tasks without the lock and then
+            // checks for waiting threads; check for tasks after announcing
+            // that we wait, so that one of us notices the other.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (manager->hasQueuedTasks()) {
+                manager->waitingThreads.removeOne(this);
+                ++manager->activeThreads;
+                manager->updateThreadState();
+                continue;
+            }
+
             // wait for work, exiting after the expiry timeout is reached
             runnableReady.wait(locker.mutex(), QDeadlineTimer(manager->expiryTimeout));
             ++manager->activeThreads;
-            if (manager->waitingThreads.removeOne(this))
-                expired = true;
+            if (manager->waitingThreads.removeOne(this)) {
+                // timed out, but stay if a task was queued in the meantime
+                manager->updateThreadState();
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                expired = !manager->hasQueuedTasks();
+            }
             if (!manager->allThreads.contains(this)) {
                 registerThreadInactive();
                 break;
@@ -148,6 +162,7 @@ void QThreadPoolThread::run()
         if (expired) {
             manager->expiredThreads.enqueue(this);
             registerThreadInactive();
+            manager->updateThreadState();
             break;
         }
     }
@@ -164,7 +179,11 @@ void QThreadPoolThread::registerThreadInactive()
     \internal
 */
 QThreadPoolPrivate:: QThreadPoolPrivate()
-{ }
+    : queueCount(qMax(1, QThread::idealThreadCount())),
+      queues(new QThreadPoolQueue[queueCount])
+{
+    canStartThreads.storeRelaxed(1);
+}
 
 bool QThreadPoolPrivate::tryStart(QRunnable *task)
 {
@@ -172,6 +191,7 @@ bool QThreadPoolPrivate::tryStart(QRunnable *task)
     if (allThreads.isEmpty()) {
         // always create at least one thread
         startThread(task);
+        updateThreadState();
         return true;
     }
 
@@ -183,6 +203,7 @@ bool QThreadPoolPrivate::tryStart(QRunnable *task)
         // recycle an available thread
         enqueueTask(task);
         waitingThreads.takeFirst()->runnableReady.wakeOne();
+        updateThreadState();
         return true;
     }
 
@@ -195,11 +216,13 @@ bool QThreadPoolPrivate::tryStart(QRunnable *task)
 
         thread->runnable = task;
         thread->start();
+        updateThreadState();
         return true;
     }
 
     // start a new thread
     startThread(task);
+    updateThreadState();
     return true;
 }
 
@@ -208,17 +231,147 @@ inline bool comparePriority(int priority, const QueuePage *p)
     return p->priority() < priority;
 }
 
-void QThreadPoolPrivate::enqueueTask(QRunnable *runnable, int priority)
+void QThreadPoolQueue::push(QRunnable *runnable, int priority)
 {
-    Q_ASSERT(runnable != nullptr);
-    for (QueuePage *page : qAsConst(queue)) {
+    QMutexLocker locker(&mutex);
+    for (QueuePage *page : qAsConst(pages)) {
         if (page->priority() == priority && !page->isFull()) {
             page->push(runnable);
             return;
         }
     }
-    auto it = std::upper_bound(queue.constBegin(), queue.constEnd(), priority, comparePriority);
-    queue.insert(std::distance(queue.constBegin(), it), new QueuePage(runnable, priority));
+    auto it = std::upper_bound(pages.constBegin(), pages.constEnd(), priority, comparePriority);
+    pages.insert(std::distance(pages.constBegin(), it), new QueuePage(runnable, priority));
+    updateTopPriority();
+}
+
+QRunnable *QThreadPoolQueue::pop()
+{
+    QMutexLocker locker(&mutex);
+    if (pages.isEmpty())
+        return nullptr;
+
+    QueuePage *page = pages.constFirst();
+    QRunnable *runnable = page->pop();
+    if (page->isFinished()) {
+        pages.removeFirst();
+        delete page;
+        updateTopPriority();
+    }
+    return runnable;
+}
+
+bool QThreadPoolQueue::tryTake(QRunnable *runnable)
+{
+    QMutexLocker locker(&mutex);
+    for (QueuePage *page : qAsConst(pages)) {
+        if (page->tryTake(runnable)) {
+            if (page->isFinished()) {
+                pages.removeOne(page);
+                delete page;
+                updateTopPriority();
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+QList<QueuePage *> QThreadPoolQueue::takeAll()
+{
+    QMutexLocker locker(&mutex);
+    QList<QueuePage *> result;
+    result.swap(pages);
+    updateTopPriority();
+    return result;
+}
+
+/*!
+    \internal
+
+    Queues \a runnable with \a priority. Does not need the pool's mutex.
+*/
+void QThreadPoolPrivate::enqueueTask(QRunnable *runnable, int priority)
+{
+    Q_ASSERT(runnable != nullptr);
+    // tasks started from a pool thread are likely to be related to what
+    // that thread is doing, keep them close
+    uint index;
+    if (currentPoolThread && currentPoolThread->manager == this)
+        index = currentPoolThread->homeQueue;
+    else
+        index = uint(nextQueue.fetchAndAddRelaxed(1)) % uint(queueCount);
+    queues[index].push(runnable, priority);
+}
+
+/*!
+    \internal
+
+    Takes the next task to run from the run queues, preferring \a homeQueue
+    unless another queue holds a task with a higher priority. Pass -1 for
+    \a homeQueue to simply take the most urgent task. Does not need the
+    pool's mutex. Returns \nullptr if all queues are empty.
+*/
+QRunnable *QThreadPoolPrivate::dequeueTask(int homeQueue)
+{
+    for (;;) {
+        int best = homeQueue;
+        int bestPriority = homeQueue >= 0 ? queues[homeQueue].topPriority.loadAcquire()
+                                          : int(QThreadPoolQueue::Empty);
+        const int start = homeQueue >= 0 ? homeQueue + 1 : 0;
+        for (int n = 0; n < queueCount; ++n) {
+            const int i = (start + n) % queueCount;
+            const int priority = queues[i].topPriority.loadAcquire();
+            if (priority > bestPriority) {
+                best = i;
+                bestPriority = priority;
+            }
+        }
+        if (bestPriority == QThreadPoolQueue::Empty)
+            return nullptr;
+        if (QRunnable *runnable = queues[best].pop())
+            return runnable;
+        // another thread emptied the queue in the meantime, look again
+    }
+}
+
+bool QThreadPoolPrivate::hasQueuedTasks() const
+{
+    for (int i = 0; i < queueCount; ++i) {
+        if (!queues[i].isEmpty())
+            return true;
+    }
+    return false;
+}
+
+/*!
+    \internal
+
+    Makes sure a thread is going to pick up a task that was queued without
+    holding the mutex, which must be locked when calling this function.
+*/
+void QThreadPoolPrivate::wakeOrStartThreadForQueuedTask()
+{
+    if (!waitingThreads.isEmpty()) {
+        waitingThreads.takeFirst()->runnableReady.wakeOne();
+        updateThreadState();
+    } else {
+        tryToStartMoreThreads();
+    }
+}
+
+/*!
+    \internal
+
+    Publishes the parts of the thread bookkeeping that are read without
+    holding the mutex. Must be called, with the mutex locked, whenever that
+    bookkeeping changes.
+*/
+void QThreadPoolPrivate::updateThreadState()
+{
+    waitingThreadCount.storeRelaxed(waitingThreads.count());
+    canStartThreads.storeRelaxed(allThreads.isEmpty() || activeThreadCount() < maxThreadCount);
+    overCommitted.storeRelaxed(tooManyThreadsActive());
 }
 
 int QThreadPoolPrivate::activeThreadCount() const
@@ -232,18 +385,22 @@ int QThreadPoolPrivate::activeThreadCount() const
 void QThreadPoolPrivate::tryToStartMoreThreads()
 {
     // try to push tasks on the queue to any available threads
-    while (!queue.isEmpty()) {
-        QueuePage *page = queue.first();
-        if (!tryStart(page->first()))
-            break;
-
-        page->pop();
-
-        if (page->isFinished()) {
-            queue.removeFirst();
-            delete page;
+    while (allThreads.isEmpty() || activeThreadCount() < maxThreadCount) {
+        if (!waitingThreads.isEmpty()) {
+            // idle threads take the tasks from the queues themselves
+            if (!hasQueuedTasks())
+                break;
+            waitingThreads.takeFirst()->runnableReady.wakeOne();
+            continue;
         }
+
+        QRunnable *runnable = dequeueTask(-1);
+        if (!runnable)
+            break;
+        // restarts an expired thread or starts a new one, cannot fail here
+        tryStart(runnable);
     }
+    updateThreadState();
 }
 
 bool QThreadPoolPrivate::tooManyThreadsActive() const
@@ -280,6 +437,7 @@ void QThreadPoolPrivate::reset()
     allThreadsCopy.swap(allThreads);
     expiredThreads.clear();
     waitingThreads.clear();
+    updateThreadState();
     mutex.unlock();
 
     for (QThreadPoolThread *thread : qAsConst(allThreadsCopy)) {
@@ -300,10 +458,10 @@ void QThreadPoolPrivate::reset()
 */
 bool QThreadPoolPrivate::waitForDone(const QDeadlineTimer &timer)
 {
-    while (!(queue.isEmpty() && activeThreads == 0) && !timer.hasExpired())
+    while (!(!hasQueuedTasks() && activeThreads == 0) && !timer.hasExpired())
         noActiveThreads.wait(&mutex, timer);
 
-    return queue.isEmpty() && activeThreads == 0;
+    return !hasQueuedTasks() && activeThreads == 0;
 }
 
 bool QThreadPoolPrivate::waitForDone(int msecs)
@@ -316,25 +474,23 @@ bool QThreadPoolPrivate::waitForDone(int msecs)
         reset();
         // More threads can be started during reset(), in that case continue
         // waiting if we still have time left.
-    } while ((!queue.isEmpty() || activeThreads) && !timer.hasExpired());
+    } while ((hasQueuedTasks() || activeThreads) && !timer.hasExpired());
 
-    return queue.isEmpty() && activeThreads == 0;
+    return !hasQueuedTasks() && activeThreads == 0;
 }
 
 void QThreadPoolPrivate::clear()
 {
-    QMutexLocker locker(&mutex);
-    while (!queue.isEmpty()) {
-        auto *page = queue.takeLast();
-        while (!page->isFinished()) {
-            QRunnable *r = page->pop();
-            if (r && r->autoDelete()) {
-                locker.unlock();
-                delete r;
-                locker.relock();
+    for (int i = 0; i < queueCount; ++i) {
+        const QList<QueuePage *> pages = queues[i].takeAll();
+        for (QueuePage *page : pages) {
+            while (!page->isFinished()) {
+                QRunnable *r = page->pop();
+                if (r && r->autoDelete())
+                    delete r;
             }
+            delete page;
         }
-        delete page;
     }
 }
 
@@ -362,15 +518,9 @@ bool QThreadPool::tryTake(QRunnable *runnable)
     if (runnable == nullptr)
         return false;
 
-    QMutexLocker locker(&d->mutex);
-    for (QueuePage *page : qAsConst(d->queue)) {
-        if (page->tryTake(runnable)) {
-            if (page->isFinished()) {
-                d->queue.removeOne(page);
-                delete page;
-            }
+    for (int i = 0; i < d->queueCount; ++i) {
+        if (d->queues[i].tryTake(runnable))
             return true;
-        }
     }
 
     return false;
@@ -500,6 +650,19 @@ void QThreadPool::start(QRunnable *runnable, int priority)
         return;
 
     Q_D(QThreadPool);
+    if (!d->canStartThreads.loadRelaxed()) {
+        // All threads are busy, which is the common case when many tasks
+        // are started: queue the task without taking the pool's mutex, and
+        // only lock it if a thread became available in the meantime.
+        d->enqueueTask(runnable, priority);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (d->waitingThreadCount.loadRelaxed() || d->canStartThreads.loadRelaxed()) {
+            QMutexLocker locker(&d->mutex);
+            d->wakeOrStartThreadForQueuedTask();
+        }
+        return;
+    }
+
     QMutexLocker locker(&d->mutex);
 
     if (!d->tryStart(runnable)) {
@@ -507,6 +670,7 @@ void QThreadPool::start(QRunnable *runnable, int priority)
 
         if (!d->waitingThreads.isEmpty())
             d->waitingThreads.takeFirst()->runnableReady.wakeOne();
+        d->updateThreadState();
     }
 }
 
@@ -548,6 +712,9 @@ bool QThreadPool::tryStart(QRunnable *runnable)
         return false;
 
     Q_D(QThreadPool);
+    // no need to lock the mutex just to find out that all threads are busy
+    if (!d->canStartThreads.loadAcquire())
+        return false;
     QMutexLocker locker(&d->mutex);
     if (d->tryStart(runnable))
         return true;
@@ -570,6 +737,8 @@ bool QThreadPool::tryStart(std::function<void()> functionToRun)
         return false;
 
     Q_D(QThreadPool);
+    if (!d->canStartThreads.loadAcquire())
+        return false;
     QMutexLocker locker(&d->mutex);
     if (!d->allThreads.isEmpty() && d->activeThreadCount() >= d->maxThreadCount)
         return false;
@@ -672,6 +841,7 @@ void QThreadPool::reserveThread()
     Q_D(QThreadPool);
     QMutexLocker locker(&d->mutex);
     ++d->reservedThreads;
+    d->updateThreadState();
 }
 
 /*! \property QThreadPool::stackSize
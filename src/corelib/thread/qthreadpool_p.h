@@ -59,6 +59,9 @@
 #include "QtCore/qqueue.h"
 #include "private/qobject_p.h"
 
+#include <limits>
+#include <memory>
+
 QT_REQUIRE_CONFIG(thread);
 
 QT_BEGIN_NAMESPACE
@@ -142,6 +145,39 @@ private:
     QRunnable *m_entries[MaxPageSize];
 };
 
+/*
+    One of the run queues of a thread pool: a list of pages sorted by
+    descending priority, with its own lock. topPriority mirrors the priority
+    of the first page so that workers can pick a queue without locking.
+*/
+class alignas(64) QThreadPoolQueue
+{
+public:
+    enum : int { Empty = std::numeric_limits<int>::min() };
+
+    ~QThreadPoolQueue() { qDeleteAll(pages); }
+
+    void push(QRunnable *runnable, int priority);
+    QRunnable *pop();
+    bool tryTake(QRunnable *runnable);
+    QList<QueuePage *> takeAll();
+
+    bool isEmpty() const { return topPriority.loadAcquire() == Empty; }
+
+    QMutex mutex;
+    QList<QueuePage *> pages;
+    QAtomicInt topPriority = Empty;
+
+private:
+    void updateTopPriority()
+    {
+        // keep Empty reserved, even for tasks started with INT_MIN priority
+        topPriority.storeRelease(pages.isEmpty()
+                                 ? int(Empty)
+                                 : qMax(pages.constFirst()->priority(), Empty + 1));
+    }
+};
+
 class QThreadPoolThread;
 class Q_CORE_EXPORT QThreadPoolPrivate : public QObjectPrivate
 {
@@ -164,15 +200,33 @@ public:
     bool waitForDone(const QDeadlineTimer &timer);
     void clear();
     void stealAndRunRunnable(QRunnable *runnable);
-    void deletePageIfFinished(QueuePage *page);
+
+    QRunnable *dequeueTask(int homeQueue);
+    bool hasQueuedTasks() const;
+    void wakeOrStartThreadForQueuedTask();
+    void updateThreadState();
 
     mutable QMutex mutex;
     QSet<QThreadPoolThread *> allThreads;
     QQueue<QThreadPoolThread *> waitingThreads;
     QQueue<QThreadPoolThread *> expiredThreads;
-    QList<QueuePage *> queue;
     QWaitCondition noActiveThreads;
 
+    // The run queues have their own locks; new tasks go to the queue of the
+    // submitting pool thread, or are spread round-robin, and idle threads
+    // steal from the other queues.
+    const int queueCount;
+    std::unique_ptr<QThreadPoolQueue[]> queues;
+    QAtomicInt nextQueue;
+    int nextHomeQueue = 0;
+
+    // Snapshots of the state guarded by mutex, updated by
+    // updateThreadState(), so that start() and the workers do not need the
+    // lock while the pool is busy.
+    QAtomicInt waitingThreadCount;
+    QAtomicInt canStartThreads;
+    QAtomicInt overCommitted;
+
     int expiryTimeout = 30000;
     int maxThreadCount = QThread::idealThreadCount();
     int reservedThreads = 0;
@@ -41,6 +41,7 @@
 #include <QOperatingSystemVersion>
 #include <QStorageInfo>
 #include <QScopeGuard>
+#include <QSignalSpy>
 
 #include <private/qabstractfileengine_p.h>
 #include <private/qfsfileengine_p.h>
@@ -282,6 +283,9 @@ private slots:
 
     void reuseQFile();
 
+    void asynchronousWrite();
+    void asynchronousRead();
+
     void moveToTrash_data();
     void moveToTrash();
 
@@ -3667,6 +3671,82 @@ void tst_QFile::reuseQFile()
     }
 }
 
+void tst_QFile::asynchronousWrite()
+{
+    // QTemporaryDir is current dir, no need to remove this file
+    QFile file("asyncWrite");
+    file.setAsynchronous(true);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    if (!file.isAsynchronous())
+        QSKIP("Asynchronous file I/O is not available on this system");
+
+    QSignalSpy spy(&file, &QIODevice::bytesWritten);
+    QByteArray expected;
+    for (int i = 0; i < 64; ++i) {
+        const QByteArray chunk(4096 + i, char('a' + i % 26));
+        QCOMPARE(file.write(chunk), chunk.size());
+        expected += chunk;
+    }
+    QCOMPARE(file.pos(), expected.size());
+    QVERIFY(file.flush());
+    QCOMPARE(file.bytesToWrite(), 0);
+    qint64 written = 0;
+    for (const QList<QVariant> &args : qAsConst(spy))
+        written += args.at(0).toLongLong();
+    QCOMPARE(written, expected.size());
+
+    // overwrite in the middle
+    QVERIFY(file.seek(10));
+    QCOMPARE(file.write("0123456789"), 10);
+    expected.replace(10, 10, "0123456789");
+    file.close();
+    QVERIFY(!file.isAsynchronous());
+
+    file.setAsynchronous(false);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), expected);
+}
+
+void tst_QFile::asynchronousRead()
+{
+    // QTemporaryDir is current dir, no need to remove this file
+    const QString fileName("asyncRead");
+    QByteArray expected;
+    for (int i = 0; i < 100000; ++i)
+        expected += QByteArray::number(i) + '\n';
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(expected), expected.size());
+    }
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    file.setAsynchronous(true);
+    if (!file.isAsynchronous())
+        QSKIP("Asynchronous file I/O is not available on this system");
+
+    // data arrives through the event loop
+    QByteArray data;
+    connect(&file, &QIODevice::readyRead, this, [&] { data += file.readAll(); });
+    QTRY_COMPARE(data.size(), expected.size());
+    QCOMPARE(data, expected);
+    QVERIFY(file.atEnd());
+    disconnect(&file, &QIODevice::readyRead, this, nullptr);
+
+    // seeking restarts read-ahead at the new position
+    QVERIFY(file.seek(expected.indexOf("5000\n")));
+    while (file.bytesAvailable() && !file.canReadLine())
+        QVERIFY(file.waitForReadyRead(5000));
+    QCOMPARE(file.readLine(), QByteArray("5000\n"));
+    QCOMPARE(file.readLine(), QByteArray("5001\n"));
+
+    // switching back to blocking I/O keeps the position
+    file.setAsynchronous(false);
+    QVERIFY(!file.isAsynchronous());
+    QCOMPARE(file.readLine(), QByteArray("5002\n"));
+}
+
 void tst_QFile::moveToTrash_data()
 {
     QTest::addColumn<QString>("source");
@@ -36,6 +36,10 @@
 #include <QAbstractEventDispatcher>
 #include <QTimer>
 
+#ifdef ENABLE_EPOLL
+static bool epollEnabled = []() { qputenv("QT_EVENT_DISPATCHER_EPOLL", "1"); return true; }();
+#endif
+
 enum {
     PreciseTimerInterval    =   10,
     CoarseTimerInterval     =  200,
@@ -0,0 +1,261 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDataStream>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QThread>
+#include <QTest>
+
+#include <private/qeventstatistics_p.h>
+
+class tst_QEventStatistics : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void histogram();
+    void ring();
+    void sendEvent();
+    void postEvent();
+    void binaryDump();
+    void otherThread();
+};
+
+class EventCounter : public QObject
+{
+    Q_OBJECT
+public:
+    int count = 0;
+
+protected:
+    bool event(QEvent *e) override
+    {
+        if (e->type() != QEvent::User)
+            return QObject::event(e);
+        ++count;
+        return true;
+    }
+};
+
+static quint64 countFor(const QEventStatistics *statistics, const QMetaObject *mo)
+{
+    const QList<QEventStatistics::ReceiverClass> classes = statistics->receiverClasses();
+    for (const QEventStatistics::ReceiverClass &c : classes) {
+        if (c.metaObject == mo)
+            return c.count;
+    }
+    return 0;
+}
+
+void tst_QEventStatistics::initTestCase()
+{
+    QLoggingCategory::setFilterRules(QStringLiteral("qt.core.eventstatistics.debug=true"));
+    QVERIFY(QEventStatistics::isEnabled());
+}
+
+void tst_QEventStatistics::cleanupTestCase()
+{
+    QLoggingCategory::setFilterRules(QString());
+}
+
+void tst_QEventStatistics::histogram()
+{
+    QEventLatencyHistogram histogram;
+    QCOMPARE(histogram.count(), 0u);
+    QCOMPARE(histogram.percentile(0.5), 0u);
+
+    histogram.record(0);
+    histogram.record(1);
+    histogram.record(3);
+    histogram.record(1000);
+    QCOMPARE(histogram.count(), 4u);
+    QCOMPARE(histogram.sum(), 1004u);
+    QCOMPARE(histogram.bucketValue(0), 1u);
+    QCOMPARE(histogram.bucketValue(1), 1u);
+    QCOMPARE(histogram.bucketValue(2), 1u);
+    QCOMPARE(histogram.bucketValue(10), 1u);
+
+    QCOMPARE(histogram.percentile(0.25), 0u);
+    QCOMPARE(histogram.percentile(0.5), 1u);
+    QCOMPARE(histogram.percentile(0.75), 3u);
+    QCOMPARE(histogram.percentile(1), 1023u);
+
+    // everything too large ends up in the last bucket
+    histogram.record(std::numeric_limits<quint64>::max() / 2);
+    QCOMPARE(histogram.bucketValue(QEventLatencyHistogram::BucketCount - 1), 1u);
+}
+
+void tst_QEventStatistics::ring()
+{
+    QScopedPointer<QEventDispatchRing> ring(new QEventDispatchRing);
+    QVERIFY(ring->snapshot().isEmpty());
+
+    for (int i = 0; i < 10; ++i)
+        ring->append({ i, 2 * i, &QObject::staticMetaObject, i });
+    QList<QEventDispatchRecord> records = ring->snapshot();
+    QCOMPARE(records.size(), 10);
+    QCOMPARE(records.first().timestamp, 0);
+    QCOMPARE(records.last().duration, 18);
+    QCOMPARE(records.last().eventType, 9);
+
+    // wrap around: only the most recent entries are kept, oldest first
+    const int total = QEventDispatchRing::Size + 100;
+    for (int i = 10; i < total; ++i)
+        ring->append({ i, 2 * i, &QObject::staticMetaObject, i });
+    records = ring->snapshot();
+    QCOMPARE(records.size(), int(QEventDispatchRing::Size));
+    QCOMPARE(records.first().timestamp, total - QEventDispatchRing::Size);
+    QCOMPARE(records.last().timestamp, total - 1);
+}
+
+void tst_QEventStatistics::sendEvent()
+{
+    QEventStatistics *statistics = QEventStatistics::current();
+    const quint64 dispatchesBefore = statistics->dispatchTime.count();
+
+    EventCounter receiver;
+    for (int i = 0; i < 5; ++i) {
+        QEvent e(QEvent::User);
+        QCoreApplication::sendEvent(&receiver, &e);
+    }
+    QCOMPARE(receiver.count, 5);
+    QCOMPARE(countFor(statistics, &EventCounter::staticMetaObject), 5u);
+    QVERIFY(statistics->dispatchTime.count() >= dispatchesBefore + 5);
+
+    const QList<QEventDispatchRecord> records = statistics->recentDispatches.snapshot();
+    QVERIFY(records.size() >= 5);
+    QCOMPARE(records.last().receiverClass, &EventCounter::staticMetaObject);
+    QCOMPARE(records.last().eventType, int(QEvent::User));
+    QVERIFY(records.last().duration >= 0);
+}
+
+void tst_QEventStatistics::postEvent()
+{
+    QEventStatistics *statistics = QEventStatistics::current();
+    const quint64 waitsBefore = statistics->queueWait.count();
+    const quint64 depthsBefore = statistics->queueDepth.count();
+    const quint64 deepBefore = statistics->queueDepth.bucketValue(3);  // 4..7 events
+
+    EventCounter receiver;
+    for (int i = 0; i < 5; ++i)
+        QCoreApplication::postEvent(&receiver, new QEvent(QEvent::User));
+    QCoreApplication::sendPostedEvents();
+
+    QCOMPARE(receiver.count, 5);
+    QCOMPARE(statistics->queueWait.count(), waitsBefore + 5);
+    QVERIFY(statistics->queueDepth.count() > depthsBefore);
+    QCOMPARE(statistics->queueDepth.bucketValue(3), deepBefore + 1);
+}
+
+void tst_QEventStatistics::binaryDump()
+{
+    EventCounter receiver;
+    QEvent e(QEvent::User);
+    QCoreApplication::sendEvent(&receiver, &e);
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(QEventStatistics::writeBinary(&buffer));
+    buffer.close();
+
+    QDataStream stream(buffer.data());
+    stream.setVersion(QDataStream::Qt_6_0);
+    char magic[4];
+    QCOMPARE(stream.readRawData(magic, 4), 4);
+    QCOMPARE(QByteArray(magic, 4), QByteArray("QEVS"));
+    quint32 version, threads;
+    stream >> version >> threads;
+    QCOMPARE(version, 1u);
+    QVERIFY(threads >= 1);
+
+    quint64 threadId;
+    QString name;
+    stream >> threadId >> name;
+    for (int i = 0; i < 3; ++i) {
+        quint32 buckets;
+        stream >> buckets;
+        QCOMPARE(buckets, quint32(QEventLatencyHistogram::BucketCount));
+        quint64 value;
+        for (quint32 j = 0; j <= buckets; ++j)
+            stream >> value;
+    }
+
+    quint32 classCount;
+    stream >> classCount;
+    bool found = false;
+    for (quint32 i = 0; i < classCount; ++i) {
+        QByteArray className;
+        quint64 count, nsecs;
+        stream >> className >> count >> nsecs;
+        if (className == "EventCounter")
+            found = true;
+    }
+    QVERIFY(found);
+    QCOMPARE(stream.status(), QDataStream::Ok);
+}
+
+void tst_QEventStatistics::otherThread()
+{
+    const quint64 countBefore = countFor(QEventStatistics::current(), &EventCounter::staticMetaObject);
+
+    QThread thread;
+    thread.setObjectName(QStringLiteral("statistics thread"));
+    EventCounter receiver;
+    QObject helper;
+    receiver.moveToThread(&thread);
+    helper.moveToThread(&thread);
+    thread.start();
+
+    for (int i = 0; i < 3; ++i)
+        QCoreApplication::postEvent(&receiver, new QEvent(QEvent::User));
+    // wait until the thread has dispatched the events posted before
+    QVERIFY(QMetaObject::invokeMethod(&helper, [] {}, Qt::BlockingQueuedConnection));
+    QCOMPARE(receiver.count, 3);
+
+    // the other thread keeps its own statistics, which can be read while it runs
+    QTest::ignoreMessage(QtDebugMsg,
+                         QRegularExpression(QStringLiteral("statistics thread.*EventCounter: 3 events"),
+                                            QRegularExpression::DotMatchesEverythingOption));
+    QTest::ignoreMessage(QtDebugMsg, QRegularExpression(QStringLiteral("for thread 0x[0-9a-f]+\n")));
+    QEventStatistics::logAll();
+
+    // only the ThreadChange event was sent in this thread
+    QCOMPARE(countFor(QEventStatistics::current(), &EventCounter::staticMetaObject), countBefore + 1);
+
+    // don't log the summary when the thread finishes, it may happen at any time
+    QLoggingCategory::setFilterRules(QString());
+    thread.quit();
+    QVERIFY(thread.wait());
+}
+
+QTEST_MAIN(tst_QEventStatistics)
+#include "tst_qeventstatistics.moc"
@@ -162,6 +162,7 @@ private slots:
     void functorReferencesConnection();
     void disconnectDisconnects();
     void singleShotConnection();
+    void batchedConnection();
 };
 
 struct QObjectCreatedOnShutdown
@@ -8138,6 +8139,155 @@ void tst_QObject::singleShotConnection()
     }
 }
 
+class MetaCallCounter : public QObject
+{
+public:
+    int metaCallEvents = 0;
+    QObject *currentSender() const { return sender(); }
+
+protected:
+    bool event(QEvent *e) override
+    {
+        if (e->type() == QEvent::MetaCall)
+            ++metaCallEvents;
+        return QObject::event(e);
+    }
+};
+
+void tst_QObject::batchedConnection()
+{
+    const auto batchedQueued = Qt::ConnectionType(Qt::QueuedConnection | Qt::BatchedConnection);
+
+    {
+        // All emissions are delivered in order, with a single event
+        SenderObject sender;
+        MetaCallCounter receiver;
+        QList<int> ints;
+        QStringList strings;
+        QObject *currentSender = nullptr;
+        QVERIFY(connect(&sender, &SenderObject::signal7, &receiver,
+                        [&](int i, const QString &s) {
+                            ints << i;
+                            strings << s;
+                            currentSender = receiver.currentSender();
+                        }, batchedQueued));
+
+        for (int i = 0; i < 1000; ++i)
+            emit sender.signal7(i, QString::number(i));
+        QVERIFY(ints.isEmpty());
+
+        QCoreApplication::sendPostedEvents(&receiver, QEvent::MetaCall);
+        QCOMPARE(receiver.metaCallEvents, 1);
+        QCOMPARE(ints.size(), 1000);
+        for (int i = 0; i < 1000; ++i) {
+            QCOMPARE(ints.at(i), i);
+            QCOMPARE(strings.at(i), QString::number(i));
+        }
+        QCOMPARE(currentSender, &sender);
+
+        // the next pass gets a new batch
+        emit sender.signal7(1000, QString());
+        QCoreApplication::sendPostedEvents(&receiver, QEvent::MetaCall);
+        QCOMPARE(receiver.metaCallEvents, 2);
+        QCOMPARE(ints.size(), 1001);
+    }
+
+    {
+        // String based connections, and several connections sharing a batch
+        SenderObject sender;
+        ReceiverObject receiver;
+        receiver.reset();
+        QVERIFY(connect(&sender, SIGNAL(signal1()), &receiver, SLOT(slot1()), batchedQueued));
+        QVERIFY(connect(&sender, SIGNAL(signal2()), &receiver, SLOT(slot2()), batchedQueued));
+        sender.emitSignal1();
+        sender.emitSignal2();
+        sender.emitSignal1();
+        QCOMPARE(receiver.count_slot1, 0);
+        QCoreApplication::sendPostedEvents(&receiver, QEvent::MetaCall);
+        QCOMPARE(receiver.count_slot1, 2);
+        QCOMPARE(receiver.count_slot2, 1);
+        QVERIFY(receiver.sequence_slot1 > receiver.sequence_slot2);
+    }
+
+    {
+        // Emitting from a slot of the batch starts a new one
+        SenderObject sender;
+        QObject receiver;
+        int calls = 0;
+        QVERIFY(connect(&sender, &SenderObject::signal1, &receiver, [&] {
+            if (++calls == 1)
+                sender.emitSignal1();
+        }, batchedQueued));
+        sender.emitSignal1();
+        QCoreApplication::sendPostedEvents(&receiver, QEvent::MetaCall);
+        QCOMPARE(calls, 1);
+        QCoreApplication::sendPostedEvents(&receiver, QEvent::MetaCall);
+        QCOMPARE(calls, 2);
+    }
+
+    {
+        // Single shot
+        SenderObject sender;
+        QVERIFY(connect(&sender, &SenderObject::signal1, &sender, &SenderObject::aPublicSlot,
+                        Qt::ConnectionType(batchedQueued | Qt::SingleShotConnection)));
+        sender.emitSignal1();
+        sender.emitSignal1();
+        QCoreApplication::sendPostedEvents(&sender, QEvent::MetaCall);
+        QCOMPARE(sender.aPublicSlotCalled, 1);
+    }
+
+    {
+        // The receiver deletes itself from the first slot
+        SenderObject sender;
+        QPointer<DeleteThisReceiver> p = new DeleteThisReceiver;
+        DeleteThisReceiver::counter = 0;
+        QVERIFY(connect(&sender, &SenderObject::signal1, p.get(), &DeleteThisReceiver::deleteThis,
+                        batchedQueued));
+        sender.emitSignal1();
+        sender.emitSignal1();
+        QTRY_VERIFY(!p);
+        QCOMPARE(DeleteThisReceiver::counter, 1);
+    }
+
+    {
+        // The receiver is deleted with a batch pending, or the batch is removed
+        SenderObject sender;
+        QObject *receiver = new QObject;
+        int calls = 0;
+        QVERIFY(connect(&sender, &SenderObject::signal1, receiver, [&] { ++calls; }, batchedQueued));
+        sender.emitSignal1();
+        QCoreApplication::removePostedEvents(receiver, QEvent::MetaCall);
+        sender.emitSignal1();
+        sender.emitSignal1();
+        QCoreApplication::sendPostedEvents(receiver, QEvent::MetaCall);
+        QCOMPARE(calls, 2);
+        sender.emitSignal1();
+        delete receiver;
+        QCoreApplication::processEvents();
+        QCOMPARE(calls, 2);
+    }
+
+    {
+        // Emissions from other threads
+        SenderObject sender;
+        MetaCallCounter receiver;
+        QList<int> ints;
+        QVERIFY(connect(&sender, &SenderObject::signal7, &receiver,
+                        [&](int i, const QString &) { ints << i; },
+                        Qt::ConnectionType(Qt::AutoConnection | Qt::BatchedConnection)));
+        QScopedPointer<QThread> thread(QThread::create([&] {
+            for (int i = 0; i < 10000; ++i)
+                emit sender.signal7(i, QString());
+        }));
+        thread->start();
+        QVERIFY(thread->wait());
+        QTRY_COMPARE(ints.size(), 10000);
+        for (int i = 0; i < 10000; ++i)
+            QCOMPARE(ints.at(i), i);
+        QVERIFY(receiver.metaCallEvents < 10000);
+    }
+}
+
 // Test for QtPrivate::HasQ_OBJECT_Macro
 static_assert(QtPrivate::HasQ_OBJECT_Macro<tst_QObject>::Value);
 static_assert(!QtPrivate::HasQ_OBJECT_Macro<SiblingDeleter>::Value);
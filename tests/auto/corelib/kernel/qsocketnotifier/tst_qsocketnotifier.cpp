@@ -44,6 +44,10 @@
 #endif
 #include <limits>
 
+#ifdef ENABLE_EPOLL
+static bool epollEnabled = []() { qputenv("QT_EVENT_DISPATCHER_EPOLL", "1"); return true; }();
+#endif
+
 #if defined (Q_CC_MSVC) && defined(max)
 #  undef max
 #  undef min
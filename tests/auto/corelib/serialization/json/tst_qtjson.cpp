@@ -110,6 +110,7 @@ private Q_SLOTS:
     void parseStrings();
     void parseDuplicateKeys();
     void testParser();
+    void parseLargeDocument();
 
     void assignToDocument();
 
@@ -2298,6 +2299,57 @@ void tst_QtJson::testParser()
     QVERIFY(!doc.isEmpty());
 }
 
+void tst_QtJson::parseLargeDocument()
+{
+    // Strings of every length and with escapes at every offset, so that they
+    // start, end and have backslashes at all positions relative to the
+    // blocks and chunks the parser indexes the input in.
+    QByteArray json = "[";
+    QList<QString> expected;
+    for (int i = 0; json.size() < 100 * 1024; ++i) {
+        QByteArray string(i % 150, 'a' + i % 26);
+        QString value = QString::fromLatin1(string);
+        switch (i % 5) {
+        case 1:
+            string.insert(i % 7, "\\\\\\\\");
+            value.insert(i % 7, QLatin1String("\\\\"));
+            break;
+        case 2:
+            string.insert(i % 11, "\\\\\\\"");
+            value.insert(i % 11, QLatin1String("\\\""));
+            break;
+        case 3:
+            string.append("\xc3\xa9");
+            value.append(QChar(0xe9));
+            break;
+        case 4:
+            string.prepend("\\u00e9");
+            value.prepend(QChar(0xe9));
+            break;
+        }
+        json += QByteArray(i % 3, ' ') + '"' + string + "\"" + QByteArray(i % 4, '\n');
+        json += i % 2 ? ",\t" : ",";
+        json += QByteArray::number(i) + ',';
+        expected << value;
+    }
+    json.back() = ']';
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(json, &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    const QJsonArray array = doc.array();
+    QCOMPARE(array.size(), expected.size() * 2);
+    for (int i = 0; i < expected.size(); ++i) {
+        QCOMPARE(array.at(2 * i).toString(), expected.at(i));
+        QCOMPARE(array.at(2 * i + 1).toInt(), i);
+    }
+
+    json.chop(1);
+    QVERIFY(QJsonDocument::fromJson(json, &error).isNull());
+    QCOMPARE(error.error, QJsonParseError::TerminationByNumber);
+    QCOMPARE(error.offset, json.size());
+}
+
 void tst_QtJson::assignToDocument()
 {
     {
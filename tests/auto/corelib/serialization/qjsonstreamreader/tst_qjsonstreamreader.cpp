@@ -0,0 +1,526 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QTest>
+#include <QBuffer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonStreamReader>
+
+// One line per token, for comparing the token streams.
+static QString describe(const QJsonStreamReader &reader)
+{
+    const QMetaEnum tokenTypes = QMetaEnum::fromType<QJsonStreamReader::TokenType>();
+    QString result = QString::fromLatin1(tokenTypes.valueToKey(reader.tokenType()));
+    switch (reader.tokenType()) {
+    case QJsonStreamReader::Name:
+    case QJsonStreamReader::String:
+        result += u':' + reader.toString();
+        break;
+    case QJsonStreamReader::Number:
+        if (reader.toInteger(-42) != -42 || reader.toDouble() == -42)
+            result += QLatin1String(":i") + QString::number(reader.toInteger());
+        else
+            result += QLatin1String(":d") + QString::number(reader.toDouble());
+        break;
+    case QJsonStreamReader::Bool:
+        result += QLatin1String(reader.toBool() ? ":true" : ":false");
+        break;
+    case QJsonStreamReader::Invalid:
+        result += u':' + QString::number(reader.error());
+        break;
+    default:
+        break;
+    }
+    return result;
+}
+
+static QStringList readAll(QJsonStreamReader &reader)
+{
+    QStringList tokens;
+    while (!reader.atEnd()) {
+        if (reader.readNext() == QJsonStreamReader::Incomplete)
+            break;
+        tokens << describe(reader);
+    }
+    return tokens;
+}
+
+// Reads the document fed one byte at a time.
+static QStringList readByteByByte(const QByteArray &json)
+{
+    QJsonStreamReader reader;
+    QStringList tokens;
+    qsizetype fed = 0;
+    while (!reader.atEnd()) {
+        if (reader.readNext() == QJsonStreamReader::Incomplete) {
+            if (fed == json.size())
+                break;
+            reader.addData(json.mid(fed++, 1));
+            continue;
+        }
+        tokens << describe(reader);
+    }
+    return tokens;
+}
+
+class tst_QJsonStreamReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initialState();
+    void tokens_data();
+    void tokens();
+    void strings();
+    void zeroCopy();
+    void numbers_data();
+    void numbers();
+    void errors_data();
+    void errors();
+    void readValue_data();
+    void readValue();
+    void skipCurrentValue();
+    void largeDocument();
+    void incompleteDevice();
+};
+
+void tst_QJsonStreamReader::initialState()
+{
+    QJsonStreamReader reader;
+    QCOMPARE(reader.tokenType(), QJsonStreamReader::NoToken);
+    QVERIFY(!reader.atEnd());
+    QVERIFY(!reader.hasError());
+    QCOMPARE(reader.depth(), 0);
+    QCOMPARE(reader.offset(), 0);
+    QCOMPARE(reader.device(), nullptr);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Incomplete);
+    QVERIFY(!reader.hasError());
+
+    reader.addData("[]");
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartArray);
+    QCOMPARE(reader.depth(), 1);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndArray);
+    QCOMPARE(reader.depth(), 0);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndDocument);
+    QVERIFY(reader.atEnd());
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndDocument);
+
+    reader.clear();
+    QCOMPARE(reader.tokenType(), QJsonStreamReader::NoToken);
+    QVERIFY(!reader.atEnd());
+}
+
+void tst_QJsonStreamReader::tokens_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<QStringList>("expected");
+
+    QTest::newRow("empty-object") << QByteArray("{}")
+            << QStringList{ "StartObject", "EndObject", "EndDocument" };
+    QTest::newRow("whitespace") << QByteArray(" \r\n\t[ \n] \t")
+            << QStringList{ "StartArray", "EndArray", "EndDocument" };
+    QTest::newRow("bom") << QByteArray("\xef\xbb\xbf[1]")
+            << QStringList{ "StartArray", "Number:i1", "EndArray", "EndDocument" };
+    QTest::newRow("scalars") << QByteArray("[true, false, null, \"x\", 1.5, -2]")
+            << QStringList{ "StartArray", "Bool:true", "Bool:false", "Null", "String:x",
+                            "Number:d1.5", "Number:i-2", "EndArray", "EndDocument" };
+    QTest::newRow("object") << QByteArray(R"({"a": {"b": [1, {}]}, "c": "d"})")
+            << QStringList{ "StartObject", "Name:a", "StartObject", "Name:b", "StartArray",
+                            "Number:i1", "StartObject", "EndObject", "EndArray", "EndObject",
+                            "Name:c", "String:d", "EndObject", "EndDocument" };
+    QTest::newRow("duplicate-names") << QByteArray(R"({"a": 1, "a": 2})")
+            << QStringList{ "StartObject", "Name:a", "Number:i1", "Name:a", "Number:i2",
+                            "EndObject", "EndDocument" };
+}
+
+void tst_QJsonStreamReader::tokens()
+{
+    QFETCH(QByteArray, json);
+    QFETCH(QStringList, expected);
+
+    QJsonStreamReader reader(json);
+    QCOMPARE(readAll(reader), expected);
+    QVERIFY(!reader.hasError());
+
+    QCOMPARE(readByteByByte(json), expected);
+
+    QBuffer buffer(&json);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QJsonStreamReader deviceReader(&buffer);
+    QCOMPARE(deviceReader.device(), &buffer);
+    QCOMPARE(readAll(deviceReader), expected);
+}
+
+void tst_QJsonStreamReader::strings()
+{
+    const QByteArray json = R"(["plain", "caf\u00e9 \"q\" \\ \/ \n\t", "h\u00e9llo", )"
+                            R"("\ud83d\ude00", "\ud800x", "naïve"])";
+    QJsonStreamReader reader(json);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartArray);
+
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QCOMPARE(reader.text(), "plain");
+    QCOMPARE(reader.toString(), u"plain");
+
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QCOMPARE(reader.text(), "caf\xc3\xa9 \"q\" \\ / \n\t");
+    QCOMPARE(reader.toString(), QString::fromUtf8("caf\xc3\xa9 \"q\" \\ / \n\t"));
+
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QCOMPARE(reader.text(), "h\xc3\xa9llo");
+
+    // surrogate pairs are combined, unpaired surrogates are kept by
+    // toString() but can't be represented in UTF-8
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QCOMPARE(reader.text(), "\xf0\x9f\x98\x80");
+    QCOMPARE(reader.toString(), QString::fromUcs4(U"\U0001F600"));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QCOMPARE(reader.text(), "\xef\xbf\xbdx");
+    QCOMPARE(reader.toString(), QString(QChar(0xd800)) + u'x');
+
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QCOMPARE(reader.toString(), QString::fromUtf8("naïve"));
+
+    // same as QJsonDocument
+    const QJsonArray array = QJsonDocument::fromJson(json).array();
+    QJsonStreamReader again(json);
+    again.readNext();
+    for (const QJsonValue &value : array) {
+        again.readNext();
+        QCOMPARE(again.toString(), value.toString());
+    }
+}
+
+void tst_QJsonStreamReader::zeroCopy()
+{
+    const QByteArray json = R"({"name": "value", "escaped": "a\nb"})";
+    QJsonStreamReader reader(json);
+    auto inInput = [&json](QUtf8StringView view) {
+        return view.data() >= json.constData()
+                && view.data() + view.size() <= json.constData() + json.size();
+    };
+
+    reader.readNext();
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Name);
+    QVERIFY(inInput(reader.text()));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QVERIFY(inInput(reader.text()));
+    QCOMPARE(reader.text(), "value");
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Name);
+    QVERIFY(inInput(reader.text()));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QVERIFY(!inInput(reader.text()));
+    QCOMPARE(reader.text(), "a\nb");
+}
+
+void tst_QJsonStreamReader::numbers_data()
+{
+    QTest::addColumn<QByteArray>("number");
+    QTest::addColumn<bool>("isInteger");
+    QTest::addColumn<qint64>("integer");
+    QTest::addColumn<double>("value");
+
+    QTest::newRow("zero") << QByteArray("0") << true << qint64(0) << 0.;
+    QTest::newRow("negative") << QByteArray("-17") << true << qint64(-17) << -17.;
+    QTest::newRow("int64-max") << QByteArray("9223372036854775807") << true
+                               << std::numeric_limits<qint64>::max() << 9223372036854775807.;
+    QTest::newRow("too-large") << QByteArray("18446744073709551616") << false
+                               << qint64(0) << 18446744073709551616.;
+    QTest::newRow("fraction") << QByteArray("3.25") << false << qint64(0) << 3.25;
+    QTest::newRow("integral-fraction") << QByteArray("2.0") << true << qint64(2) << 2.;
+    QTest::newRow("exponent") << QByteArray("1e3") << true << qint64(1000) << 1000.;
+    QTest::newRow("negative-exponent") << QByteArray("-5E-1") << false << qint64(0) << -0.5;
+}
+
+void tst_QJsonStreamReader::numbers()
+{
+    QFETCH(QByteArray, number);
+    QFETCH(bool, isInteger);
+    QFETCH(qint64, integer);
+    QFETCH(double, value);
+
+    QJsonStreamReader reader("[" + number + "]");
+    reader.readNext();
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(reader.text(), number);
+    QCOMPARE(reader.toDouble(), value);
+    QCOMPARE(reader.toInteger(-1), isInteger ? integer : -1);
+
+    const QJsonValue expected = QJsonDocument::fromJson("[" + number + "]").array().at(0);
+    QCOMPARE(reader.readValue(), expected);
+}
+
+void tst_QJsonStreamReader::errors_data()
+{
+    QTest::addColumn<QByteArray>("json");
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("scalar") << QByteArray("true");
+    QTest::newRow("unterminated-object") << QByteArray("{\"a\": 1");
+    QTest::newRow("unterminated-array") << QByteArray("[1, 2");
+    QTest::newRow("missing-name-separator") << QByteArray("{\"a\" 1}");
+    QTest::newRow("missing-value-separator") << QByteArray("[1 2]");
+    QTest::newRow("trailing-comma-object") << QByteArray("{\"a\": 1,}");
+    QTest::newRow("trailing-comma-array") << QByteArray("[1,]");
+    QTest::newRow("missing-value") << QByteArray("{\"a\":,}");
+    QTest::newRow("illegal-value") << QByteArray("[nul]");
+    QTest::newRow("illegal-number") << QByteArray("[-]");
+    QTest::newRow("termination-by-number") << QByteArray("[1");
+    QTest::newRow("illegal-escape") << QByteArray("[\"\\u12x4\"]");
+    QTest::newRow("illegal-utf8") << QByteArray("[\"\xff\"]");
+    QTest::newRow("unterminated-string") << QByteArray("[\"abc");
+    QTest::newRow("mismatched-bracket") << QByteArray("{\"a\": 1]");
+    QTest::newRow("deep-nesting") << QByteArray(1025, '[') + QByteArray(1025, ']');
+    QTest::newRow("garbage-at-end") << QByteArray("{} x");
+}
+
+void tst_QJsonStreamReader::errors()
+{
+    QFETCH(QByteArray, json);
+
+    QJsonParseError expected;
+    QJsonDocument::fromJson(json, &expected);
+    QVERIFY(expected.error != QJsonParseError::NoError);
+
+    QJsonStreamReader reader(json);
+    const QStringList tokens = readAll(reader);
+    QCOMPARE(reader.tokenType(), QJsonStreamReader::Invalid);
+    QVERIFY(reader.atEnd());
+    QVERIFY(reader.hasError());
+    QCOMPARE(reader.error(), expected.error);
+    QCOMPARE(reader.errorString(), expected.errorString());
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Invalid);
+
+    // until the data ends, there is no error
+    const QStringList incremental = readByteByByte(json);
+    if (expected.error == QJsonParseError::GarbageAtEnd) {
+        QCOMPARE(incremental.last(), "EndDocument");
+    } else if (incremental.isEmpty() || !incremental.last().startsWith("Invalid")) {
+        QCOMPARE(incremental, tokens.mid(0, incremental.size()));
+    } else {
+        QCOMPARE(incremental, tokens);
+    }
+}
+
+void tst_QJsonStreamReader::readValue_data()
+{
+    QTest::addColumn<QByteArray>("json");
+
+    QTest::newRow("object") << QByteArray(R"({"b": [1, 2.5, "x", null, true], "a": {}})");
+    QTest::newRow("duplicate-names") << QByteArray(R"({"a": 1, "b": 2, "a": 3})");
+    QTest::newRow("nested-arrays") << QByteArray("[[[]], [[1], [2, [3]]]]");
+
+    QFile file(QFINDTESTDATA("../json/test.json"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QTest::newRow("test.json") << file.readAll();
+}
+
+void tst_QJsonStreamReader::readValue()
+{
+    QFETCH(QByteArray, json);
+
+    const QJsonDocument document = QJsonDocument::fromJson(json);
+    QVERIFY(!document.isNull());
+
+    QJsonStreamReader reader(json);
+    reader.readNext();
+    const QJsonValue value = reader.readValue();
+    QVERIFY(reader.isEndObject() || reader.isEndArray());
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndDocument);
+    if (document.isObject())
+        QCOMPARE(value.toObject(), document.object());
+    else
+        QCOMPARE(value.toArray(), document.array());
+
+    // element by element
+    if (document.isArray()) {
+        QJsonStreamReader elements(json);
+        elements.readNext();
+        QJsonArray array;
+        while (elements.readNext() != QJsonStreamReader::EndArray) {
+            QVERIFY(!elements.atEnd());
+            array.append(elements.readValue());
+        }
+        QCOMPARE(array, document.array());
+    }
+}
+
+void tst_QJsonStreamReader::skipCurrentValue()
+{
+    const QByteArray json =
+            R"({"skipped": {"s": "]}\"[{", "a": [1, [2, {"b": "\\"}]]}, "kept": 1, )"
+            R"("scalar": "x", "last": [[]]})";
+    const QStringList expected = { "StartObject", "Name:skipped", "EndObject", "Name:kept",
+                                   "Number:i1", "Name:scalar", "Name:last", "EndArray",
+                                   "EndObject", "EndDocument" };
+
+    auto run = [&](QJsonStreamReader &reader, auto feed) {
+        QStringList tokens;
+        while (!reader.atEnd()) {
+            const QJsonStreamReader::TokenType type = reader.readNext();
+            if (type == QJsonStreamReader::Incomplete) {
+                if (!feed())
+                    break;
+                continue;
+            }
+            tokens << describe(reader);
+            if (reader.isName() && reader.text() != "kept") {
+                while (!reader.skipCurrentValue()) {
+                    if (reader.tokenType() != QJsonStreamReader::Incomplete || !feed())
+                        return tokens;
+                }
+                if (reader.isEndObject() || reader.isEndArray())
+                    tokens << describe(reader);
+            }
+        }
+        return tokens;
+    };
+
+    QJsonStreamReader reader(json);
+    QCOMPARE(run(reader, [] { return false; }), expected);
+
+    QJsonStreamReader incremental;
+    qsizetype fed = 0;
+    QCOMPARE(run(incremental, [&] {
+        if (fed == json.size())
+            return false;
+        incremental.addData(json.mid(fed++, 1));
+        return true;
+    }), expected);
+
+    QJsonStreamReader unbalanced(R"({"a": [1, {]})");
+    unbalanced.readNext();
+    unbalanced.readNext();
+    QVERIFY(!unbalanced.skipCurrentValue());
+    QVERIFY(unbalanced.hasError());
+
+    QJsonStreamReader unterminated(R"({"a": ["]")");
+    unterminated.readNext();
+    unterminated.readNext();
+    QVERIFY(!unterminated.skipCurrentValue());
+    QCOMPARE(unterminated.error(), QJsonParseError::UnterminatedArray);
+}
+
+void tst_QJsonStreamReader::largeDocument()
+{
+    // larger than the reads from the device, with a string even larger
+    QByteArray json = "[";
+    for (int i = 0; i < 10000; ++i)
+        json += R"({"id": )" + QByteArray::number(i) + R"(, "name": "item\t)"
+                + QByteArray::number(i) + R"("}, )";
+    const QByteArray longString(300000, 'x');
+    json += "\"" + longString + "\\n\"]";
+
+    QBuffer buffer(&json);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QJsonStreamReader reader(&buffer);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartArray);
+    for (int i = 0; i < 10000; ++i) {
+        QCOMPARE(reader.readNext(), QJsonStreamReader::StartObject);
+        if (i % 2) {
+            QVERIFY(reader.skipCurrentValue());
+            continue;
+        }
+        QCOMPARE(reader.readNext(), QJsonStreamReader::Name);
+        QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+        QCOMPARE(reader.toInteger(), i);
+        QCOMPARE(reader.readNext(), QJsonStreamReader::Name);
+        QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+        QCOMPARE(reader.toString(), "item\t" + QString::number(i));
+        QCOMPARE(reader.readNext(), QJsonStreamReader::EndObject);
+    }
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QCOMPARE(reader.text().size(), longString.size() + 1);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndArray);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndDocument);
+    QCOMPARE(reader.offset(), json.size());
+}
+
+// A sequential device receiving data over time, like a socket.
+class Pipe : public QIODevice
+{
+public:
+    void append(const QByteArray &data) { pending += data; }
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override
+    { return pending.size() + QIODevice::bytesAvailable(); }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        const qint64 n = qMin(maxSize, qint64(pending.size()));
+        memcpy(data, pending.constData(), n);
+        pending.remove(0, n);
+        return n;
+    }
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    QByteArray pending;
+};
+
+void tst_QJsonStreamReader::incompleteDevice()
+{
+    Pipe device;
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    QJsonStreamReader reader(&device);
+
+    device.append(R"({"a": [1, "tex)");
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartObject);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Name);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartArray);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Incomplete);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Incomplete);
+    QVERIFY(!reader.hasError());
+
+    device.append(R"(t"]})");
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QCOMPARE(reader.text(), "text");
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndArray);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndObject);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndDocument);
+
+    // a closed device has no more data to come
+    Pipe truncatedDevice;
+    QVERIFY(truncatedDevice.open(QIODevice::ReadOnly));
+    truncatedDevice.append("[1, 2");
+    QJsonStreamReader truncated(&truncatedDevice);
+    QCOMPARE(truncated.readNext(), QJsonStreamReader::StartArray);
+    QCOMPARE(truncated.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(truncated.readNext(), QJsonStreamReader::Incomplete);
+    truncatedDevice.close();
+    QCOMPARE(truncated.readNext(), QJsonStreamReader::Invalid);
+    QCOMPARE(truncated.error(), QJsonParseError::TerminationByNumber);
+}
+
+QTEST_APPLESS_MAIN(tst_QJsonStreamReader)
+#include "tst_qjsonstreamreader.moc"
@@ -0,0 +1,371 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QTest>
+#include <QRandomGenerator>
+#include <qmultistringmatcher.h>
+
+using Match = QMultiStringMatcher::Match;
+using ByteArrayMatch = QMultiByteArrayMatcher::Match;
+
+QT_BEGIN_NAMESPACE
+namespace QTest {
+template <>
+char *toString(const Match &m)
+{
+    return qstrdup(QByteArray::number(m.position) + ':' + QByteArray::number(m.length)
+                   + '#' + QByteArray::number(m.patternIndex));
+}
+} // namespace QTest
+QT_END_NAMESPACE
+
+static bool operator==(const Match &lhs, const Match &rhs)
+{
+    return lhs.position == rhs.position && lhs.length == rhs.length
+            && lhs.patternIndex == rhs.patternIndex;
+}
+
+static QList<Match> toMatches(const QList<ByteArrayMatch> &matches)
+{
+    QList<Match> result;
+    for (const ByteArrayMatch &m : matches)
+        result.append({ m.position, m.length, m.patternIndex });
+    return result;
+}
+
+// The reference: all the occurrences, by end position, then from the longest.
+static QList<Match> naiveMatches(QStringView str, const QStringList &patterns,
+                                 Qt::CaseSensitivity cs)
+{
+    QList<Match> result;
+    for (qsizetype end = 1; end <= str.size(); ++end) {
+        QList<Match> here;
+        for (qsizetype p = 0; p < patterns.size(); ++p) {
+            const qsizetype length = patterns.at(p).size();
+            if (length && length <= end
+                    && str.mid(end - length, length).compare(patterns.at(p), cs) == 0)
+                here.append({ end - length, length, p });
+        }
+        std::stable_sort(here.begin(), here.end(), [](const Match &lhs, const Match &rhs) {
+            return lhs.length > rhs.length;
+        });
+        result += here;
+    }
+    return result;
+}
+
+static qsizetype naiveIndexIn(QStringView str, const QStringList &patterns,
+                              Qt::CaseSensitivity cs, qsizetype *patternIndex)
+{
+    qsizetype best = -1;
+    *patternIndex = -1;
+    for (const Match &m : naiveMatches(str, patterns, cs)) {
+        if (best < 0 || m.position < best
+                || (m.position == best && m.length > patterns.at(*patternIndex).size())) {
+            best = m.position;
+            *patternIndex = m.patternIndex;
+        }
+    }
+    return best;
+}
+
+class tst_QMultiStringMatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void defaults();
+    void indexIn_data();
+    void indexIn();
+    void matchesIn();
+    void caseInsensitive();
+    void surrogates();
+    void setters();
+    void byteArray();
+    void byteArrayCaseInsensitive();
+    void random_data();
+    void random();
+};
+
+void tst_QMultiStringMatcher::defaults()
+{
+    QMultiStringMatcher matcher;
+    QCOMPARE(matcher.caseSensitivity(), Qt::CaseSensitive);
+    QVERIFY(matcher.patterns().isEmpty());
+    qsizetype pattern = 42;
+    QCOMPARE(matcher.indexIn(u"foo", 0, &pattern), -1);
+    QCOMPARE(pattern, -1);
+    QVERIFY(matcher.matchesIn(u"foo").isEmpty());
+
+    QMultiByteArrayMatcher byteArrayMatcher;
+    QCOMPARE(byteArrayMatcher.caseSensitivity(), Qt::CaseSensitive);
+    QVERIFY(byteArrayMatcher.patterns().isEmpty());
+    QCOMPARE(byteArrayMatcher.indexIn("foo"), -1);
+    QVERIFY(byteArrayMatcher.matchesIn("foo").isEmpty());
+
+    // empty patterns never match
+    QMultiStringMatcher empty({ QString(), QString("") });
+    QCOMPARE(empty.indexIn(u"foo"), -1);
+    QCOMPARE(empty.indexIn(u""), -1);
+}
+
+void tst_QMultiStringMatcher::indexIn_data()
+{
+    QTest::addColumn<QStringList>("patterns");
+    QTest::addColumn<QString>("haystack");
+    QTest::addColumn<qsizetype>("from");
+    QTest::addColumn<qsizetype>("expectedIndex");
+    QTest::addColumn<qsizetype>("expectedPattern");
+
+    const QStringList words = { "he", "she", "his", "hers" };
+    QTest::newRow("no-match") << words << "xyz" << qsizetype(0) << qsizetype(-1) << qsizetype(-1);
+    QTest::newRow("empty-haystack") << words << "" << qsizetype(0) << qsizetype(-1) << qsizetype(-1);
+    QTest::newRow("first") << words << "ushers" << qsizetype(0) << qsizetype(1) << qsizetype(1);
+    QTest::newRow("longest") << words << "hers" << qsizetype(0) << qsizetype(0) << qsizetype(3);
+    QTest::newRow("from") << words << "ushers" << qsizetype(2) << qsizetype(2) << qsizetype(3);
+    QTest::newRow("negative-from") << words << "his" << qsizetype(-5) << qsizetype(0) << qsizetype(2);
+    QTest::newRow("from-past-end") << words << "his" << qsizetype(3) << qsizetype(-1) << qsizetype(-1);
+    QTest::newRow("leftmost-over-shorter")
+            << QStringList{ "bcd", "abcdef" } << "xabcdef" << qsizetype(0)
+            << qsizetype(1) << qsizetype(1);
+    QTest::newRow("duplicate") << QStringList{ "x", "ab", "ab" } << "zzab" << qsizetype(0)
+                               << qsizetype(2) << qsizetype(1);
+    QTest::newRow("long-haystack")
+            << words << QString(QString(1000, u'.') + "shi" + QString(1000, u'.') + "his")
+            << qsizetype(0) << qsizetype(2003) << qsizetype(2);
+    QTest::newRow("non-latin") << QStringList{ QStringLiteral("мир"), "peace" }
+                               << QString(QStringLiteral("привет, мир"))
+                               << qsizetype(0) << qsizetype(8) << qsizetype(0);
+}
+
+void tst_QMultiStringMatcher::indexIn()
+{
+    QFETCH(QStringList, patterns);
+    QFETCH(QString, haystack);
+    QFETCH(qsizetype, from);
+    QFETCH(qsizetype, expectedIndex);
+    QFETCH(qsizetype, expectedPattern);
+
+    QMultiStringMatcher matcher(patterns);
+    qsizetype pattern = 42;
+    QCOMPARE(matcher.indexIn(haystack, from, &pattern), expectedIndex);
+    QCOMPARE(pattern, expectedPattern);
+    QCOMPARE(matcher.indexIn(haystack, from), expectedIndex);
+
+    QByteArrayList byteArrayPatterns;
+    for (const QString &p : patterns)
+        byteArrayPatterns.append(p.toUtf8());
+    const QByteArray data = haystack.toUtf8();
+    if (data.size() == haystack.size()) {
+        QMultiByteArrayMatcher byteArrayMatcher(byteArrayPatterns);
+        pattern = 42;
+        QCOMPARE(byteArrayMatcher.indexIn(data, from, &pattern), expectedIndex);
+        QCOMPARE(pattern, expectedPattern);
+    }
+}
+
+void tst_QMultiStringMatcher::matchesIn()
+{
+    const QStringList words = { "he", "she", "his", "hers" };
+    QMultiStringMatcher matcher(words);
+    const QList<Match> expected = { { 1, 3, 1 }, { 2, 2, 0 }, { 2, 4, 3 } };
+    QCOMPARE(matcher.matchesIn(u"ushers"), expected);
+    QCOMPARE(matcher.matchesIn(u"ushers", 2), QList<Match>({ { 2, 2, 0 }, { 2, 4, 3 } }));
+
+    // overlapping occurrences of the same pattern
+    QMultiStringMatcher aa({ "aa" });
+    QCOMPARE(aa.matchesIn(u"aaaa"), QList<Match>({ { 0, 2, 0 }, { 1, 2, 0 }, { 2, 2, 0 } }));
+
+    // identical patterns are all reported, in order
+    QMultiStringMatcher duplicates({ "ab", "b", "ab" });
+    QCOMPARE(duplicates.matchesIn(u"ab"), QList<Match>({ { 0, 2, 0 }, { 0, 2, 2 }, { 1, 1, 1 } }));
+}
+
+void tst_QMultiStringMatcher::caseInsensitive()
+{
+    QMultiStringMatcher matcher({ "Hello", QStringLiteral("straße"), QStringLiteral("σοφία") },
+                                Qt::CaseInsensitive);
+    QCOMPARE(matcher.caseSensitivity(), Qt::CaseInsensitive);
+    qsizetype pattern;
+    QCOMPARE(matcher.indexIn(u"say hELLo", 0, &pattern), 4);
+    QCOMPARE(pattern, 0);
+    QCOMPARE(matcher.indexIn(u"STRAßE", 0, &pattern), 0);
+    QCOMPARE(pattern, 1);
+    QCOMPARE(matcher.indexIn(u"xx ΣΟΦΊΑ", 0, &pattern), 3);
+    QCOMPARE(pattern, 2);
+    QCOMPARE(matcher.indexIn(u"ΣΟΦΙΑ"), -1);
+
+    // characters folding to ASCII letters
+    QMultiStringMatcher kelvin({ "k" }, Qt::CaseInsensitive);
+    QCOMPARE(kelvin.indexIn(u"K"), 0);
+    QCOMPARE(kelvin.indexIn(u"K"), 0);
+
+    QMultiStringMatcher sensitive({ "Hello" });
+    QCOMPARE(sensitive.indexIn(u"hello"), -1);
+}
+
+void tst_QMultiStringMatcher::surrogates()
+{
+    // U+10400 DESERET CAPITAL LETTER LONG I folds to U+10428
+    const QString capital = QString::fromUcs4(U"\U00010400");
+    const QString small = QString::fromUcs4(U"\U00010428");
+    QMultiStringMatcher matcher({ capital + "x" });
+    QCOMPARE(matcher.indexIn(QString("ab" + capital + "x")), 2);
+    QCOMPARE(matcher.indexIn(QString("ab" + small + "x")), -1);
+
+    matcher.setCaseSensitivity(Qt::CaseInsensitive);
+    QCOMPARE(matcher.indexIn(QString("ab" + small + "X")), 2);
+    QCOMPARE(matcher.indexIn(QString("ab" + capital + "x")), 2);
+    QCOMPARE(matcher.matchesIn(QString(small + "X" + capital + "x")),
+             QList<Match>({ { 0, 3, 0 }, { 3, 3, 0 } }));
+}
+
+void tst_QMultiStringMatcher::setters()
+{
+    QMultiStringMatcher matcher({ "foo" });
+    QMultiStringMatcher copy = matcher;
+    matcher.setPatterns({ "bar", "baz" });
+    QCOMPARE(matcher.patterns(), QStringList({ "bar", "baz" }));
+    QCOMPARE(copy.patterns(), QStringList({ "foo" }));
+    QCOMPARE(matcher.indexIn(u"foobaz"), 3);
+    QCOMPARE(copy.indexIn(u"foobaz"), 0);
+
+    matcher.setCaseSensitivity(Qt::CaseInsensitive);
+    QCOMPARE(matcher.indexIn(u"FOOBAZ"), 3);
+    QCOMPARE(copy.indexIn(u"FOOBAZ"), -1);
+
+    copy = matcher;
+    QCOMPARE(copy.caseSensitivity(), Qt::CaseInsensitive);
+    QCOMPARE(copy.indexIn(u"BAR"), 0);
+
+    QMultiStringMatcher moved = std::move(copy);
+    QCOMPARE(moved.indexIn(u"xBAR"), 1);
+    swap(moved, copy);
+    QCOMPARE(copy.indexIn(u"xBAR"), 1);
+
+    // the case sensitivity is kept for matchers without patterns
+    QMultiStringMatcher empty;
+    empty.setCaseSensitivity(Qt::CaseInsensitive);
+    QCOMPARE(empty.caseSensitivity(), Qt::CaseInsensitive);
+    empty.setPatterns({ "abc" });
+    QCOMPARE(empty.indexIn(u"ABC"), 0);
+}
+
+void tst_QMultiStringMatcher::byteArray()
+{
+    QMultiByteArrayMatcher matcher({ "GET ", "POST ", "HEAD ", "\xff\x01" });
+    const QByteArray data = "xHEAD GET POST \xff\x01";
+    qsizetype pattern;
+    QCOMPARE(matcher.indexIn(data, 0, &pattern), 1);
+    QCOMPARE(pattern, 2);
+    QCOMPARE(toMatches(matcher.matchesIn(data)),
+             QList<Match>({ { 1, 5, 2 }, { 6, 4, 0 }, { 10, 5, 1 }, { 15, 2, 3 } }));
+
+    // embedded nulls
+    QMultiByteArrayMatcher nulls({ QByteArray("a\0b", 3) });
+    QCOMPARE(nulls.indexIn(QByteArrayView("xxa\0b", 5)), 2);
+
+    QMultiByteArrayMatcher copy = matcher;
+    matcher.setPatterns({ "x" });
+    QCOMPARE(matcher.patterns(), QByteArrayList({ "x" }));
+    QCOMPARE(copy.patterns().size(), 4);
+}
+
+void tst_QMultiStringMatcher::byteArrayCaseInsensitive()
+{
+    QMultiByteArrayMatcher matcher({ "content-length", "\xe9t\xe9" }, Qt::CaseInsensitive);
+    qsizetype pattern;
+    QCOMPARE(matcher.indexIn("Content-Length: 0", 0, &pattern), 0);
+    QCOMPARE(pattern, 0);
+    QCOMPARE(matcher.indexIn("l'\xc9T\xc9", 0, &pattern), 2);
+    QCOMPARE(pattern, 1);
+    // U+00B5 MICRO SIGN folds outside of Latin-1
+    QMultiByteArrayMatcher micro({ "\xb5" }, Qt::CaseInsensitive);
+    QCOMPARE(micro.indexIn("a\xb5"), 1);
+}
+
+void tst_QMultiStringMatcher::random_data()
+{
+    QTest::addColumn<QString>("alphabet");
+    QTest::addColumn<int>("patternCount");
+    QTest::addColumn<int>("maxLength");
+
+    QTest::newRow("small-alphabet") << "abc" << 5 << 4;
+    QTest::newRow("few-patterns") << "abcdefghijklmnopqrstuvwxyz0123456789" << 3 << 8;
+    QTest::newRow("latin") << "abcdefghijklmnopqrstuvwxyzABCDEFGHIJ .,-" << 50 << 8;
+    QTest::newRow("many-patterns") << "abcdefghijklmnopqrstuvwxyz" << 400 << 6;
+    QTest::newRow("non-latin") << QStringLiteral("abéÉāĀσΣς一 ") << 20 << 5;
+}
+
+void tst_QMultiStringMatcher::random()
+{
+    QFETCH(QString, alphabet);
+    QFETCH(int, patternCount);
+    QFETCH(int, maxLength);
+
+    QRandomGenerator rng(patternCount * 31 + maxLength);
+    auto randomString = [&](int length) {
+        QString str;
+        for (int i = 0; i < length; ++i)
+            str += alphabet.at(rng.bounded(int(alphabet.size())));
+        return str;
+    };
+
+    for (int round = 0; round < 20; ++round) {
+        QStringList patterns;
+        for (int i = 0; i < patternCount; ++i)
+            patterns.append(randomString(1 + rng.bounded(maxLength)));
+        // long runs without matches exercise the prefilter
+        QString haystack = randomString(rng.bounded(50));
+        haystack += QString(rng.bounded(100), u'_') + randomString(rng.bounded(50));
+        haystack += QString(rng.bounded(100), u'_') + randomString(rng.bounded(50));
+
+        for (Qt::CaseSensitivity cs : { Qt::CaseSensitive, Qt::CaseInsensitive }) {
+            QMultiStringMatcher matcher(patterns, cs);
+            QCOMPARE(matcher.matchesIn(haystack), naiveMatches(haystack, patterns, cs));
+            qsizetype expectedPattern;
+            const qsizetype expected = naiveIndexIn(haystack, patterns, cs, &expectedPattern);
+            qsizetype pattern;
+            QCOMPARE(matcher.indexIn(haystack, 0, &pattern), expected);
+            QCOMPARE(pattern, expectedPattern);
+
+            if (QtPrivate::isLatin1(haystack) && QtPrivate::isLatin1(patterns.join(QString()))) {
+                QByteArrayList byteArrayPatterns;
+                for (const QString &p : patterns)
+                    byteArrayPatterns.append(p.toLatin1());
+                QMultiByteArrayMatcher byteArrayMatcher(byteArrayPatterns, cs);
+                QCOMPARE(toMatches(byteArrayMatcher.matchesIn(haystack.toLatin1())),
+                         naiveMatches(haystack, patterns, cs));
+            }
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_QMultiStringMatcher)
+#include "tst_qmultistringmatcher.moc"
@@ -80,6 +80,7 @@ private slots:
     void JOptionUsage_data();
     void JOptionUsage();
     void QStringAndQStringViewEquivalence();
+    void utf8Subject();
     void threadSafety_data();
     void threadSafety();
 
@@ -380,6 +381,70 @@ static void testMatch(const QRegularExpression &regexp,
                             result);
 }
 
+// Converts an offset in \a subject to the corresponding offset in its UTF-8
+// encoding; out of range offsets stay out of range
+static qsizetype utf8Offset(const QString &subject, qsizetype offset)
+{
+    const qsizetype utf8Size = subject.toUtf8().size();
+    if (offset < 0) {
+        if (-offset > subject.size())
+            return -utf8Size - 1;
+        return subject.left(subject.size() + offset).toUtf8().size() - utf8Size;
+    }
+    if (offset > subject.size())
+        return utf8Size + 1;
+    return subject.left(offset).toUtf8().size();
+}
+
+template<typename Result>
+static void testMatchUtf8(const QRegularExpression &regexp,
+                          const QString &subject,
+                          qsizetype offset,
+                          QRegularExpression::MatchType matchType,
+                          QRegularExpression::MatchOptions matchOptions,
+                          const Result &result)
+{
+    // only well-formed subjects, with offsets not splitting a surrogate pair,
+    // have a UTF-8 equivalent
+    const QByteArray subjectUtf8 = subject.toUtf8();
+    if (QString::fromUtf8(subjectUtf8) != subject)
+        return;
+    const qsizetype absoluteOffset = offset < 0 ? offset + subject.size() : offset;
+    if (absoluteOffset > 0 && absoluteOffset < subject.size()
+            && subject.at(absoluteOffset).isLowSurrogate()) {
+        return;
+    }
+
+    const QRegularExpressionMatch m16 = regexp.match(subject, offset, matchType, matchOptions);
+    const QRegularExpressionMatch m = regexp.match(QUtf8StringView(subjectUtf8),
+                                                   utf8Offset(subject, offset),
+                                                   matchType, matchOptions);
+    QVERIFY(m == result);
+    QCOMPARE(m.regularExpression(), regexp);
+    QCOMPARE(m.matchType(), matchType);
+    QCOMPARE(m.matchOptions(), matchOptions);
+    QCOMPARE(m.lastCapturedIndex(), m16.lastCapturedIndex());
+    for (int i = 0; i <= m.lastCapturedIndex(); ++i) {
+        const QUtf8StringView view = m.capturedUtf8View(i);
+        QVERIFY(m.capturedView(i).isNull());
+        if (m16.capturedStart(i) == -1) {
+            QCOMPARE(m.capturedStart(i), -1);
+            QVERIFY(view.isNull());
+        } else {
+            QCOMPARE(m.capturedStart(i), utf8Offset(subject, m16.capturedStart(i)));
+            QCOMPARE(m.capturedEnd(i), utf8Offset(subject, m16.capturedEnd(i)));
+            QCOMPARE(view.data(), subjectUtf8.constData() + m.capturedStart(i));
+            QCOMPARE(QByteArray(view.data(), view.size()), m16.captured(i).toUtf8());
+        }
+    }
+
+    // the QByteArrayView overload is the same function
+    const QRegularExpressionMatch mb = regexp.match(QByteArrayView(subjectUtf8),
+                                                    utf8Offset(subject, offset),
+                                                    matchType, matchOptions);
+    QVERIFY(mb == result);
+}
+
 typedef QRegularExpressionMatch (QRegularExpression::*QREMatchStringPMF)(const QString &, qsizetype, QRegularExpression::MatchType, QRegularExpression::MatchOptions) const;
 typedef QRegularExpressionMatch (QRegularExpression::*QREMatchStringViewPMF)(QStringView, qsizetype, QRegularExpression::MatchType, QRegularExpression::MatchOptions) const;
 typedef QRegularExpressionMatchIterator (QRegularExpression::*QREGlobalMatchStringPMF)(const QString &, qsizetype, QRegularExpression::MatchType, QRegularExpression::MatchOptions) const;
@@ -1006,6 +1071,8 @@ void tst_QRegularExpression::normalMatch()
                                        QRegularExpression::NormalMatch,
                                        matchOptions,
                                        match);
+
+    testMatchUtf8(regexp, subject, offset, QRegularExpression::NormalMatch, matchOptions, match);
 }
 
 void tst_QRegularExpression::partialMatch_data()
@@ -1278,6 +1345,8 @@ void tst_QRegularExpression::partialMatch()
                                        matchType,
                                        matchOptions,
                                        match);
+
+    testMatchUtf8(regexp, subject, offset, matchType, matchOptions, match);
 }
 
 void tst_QRegularExpression::globalMatch_data()
@@ -2254,6 +2323,58 @@ private:
     const QString &m_subject;
 };
 
+void tst_QRegularExpression::utf8Subject()
+{
+    const QRegularExpression re(QStringLiteral("(?<word>\\w+)-(\\d+)"),
+                                QRegularExpression::UseUnicodePropertiesOption);
+    const QByteArray subject = "\xd1\x87\xd0\xb0\xd0\xb9-42 \xe6\xbc\xa2\xe5\xad\x97-7";
+
+    QRegularExpressionMatch m = re.match(QUtf8StringView(subject));
+    QVERIFY(m.hasMatch());
+    QCOMPARE(m.capturedStart(), 0);
+    QCOMPARE(m.capturedEnd(), 9);
+    QCOMPARE(m.captured("word"), QString::fromUtf8("\xd1\x87\xd0\xb0\xd0\xb9"));
+    QCOMPARE(m.capturedUtf8View(u"word").size(), 6);
+    QCOMPARE(m.capturedUtf8View(u"word").data(), subject.constData());
+    QCOMPARE(m.captured(2), QStringLiteral("42"));
+    QVERIFY(m.capturedView(1).isNull());
+    QVERIFY(m.capturedUtf8View(u"nonexisting").isNull());
+
+    // offsets are byte offsets
+    m = re.match(QUtf8StringView(subject), 10);
+    QVERIFY(m.hasMatch());
+    QCOMPARE(m.capturedStart(1), 10);
+    QCOMPARE(m.capturedLength(1), 6);
+    QCOMPARE(m.captured(), QString::fromUtf8("\xe6\xbc\xa2\xe5\xad\x97-7"));
+
+    // an offset in the middle of a sequence is rejected...
+    m = re.match(QUtf8StringView(subject), 11);
+    QVERIFY(!m.isValid());
+    // ...and so is ill-formed UTF-8
+    m = re.match(QByteArrayView("\xc3\x28-1"));
+    QVERIFY(!m.isValid());
+
+    // UTF-16 matches don't have UTF-8 views
+    m = re.match(QString::fromUtf8(subject));
+    QVERIFY(m.hasMatch());
+    QVERIFY(m.capturedUtf8View(1).isNull());
+    QCOMPARE(m.capturedView(1), QString::fromUtf8("\xd1\x87\xd0\xb0\xd0\xb9"));
+
+    // copies share the compiled pattern, changing the pattern recompiles it
+    QRegularExpression copy = re;
+    QVERIFY(copy.match(QByteArrayView("abc-1")).hasMatch());
+    copy.setPattern(QStringLiteral("^\\d+$"));
+    QVERIFY(!copy.match(QByteArrayView("abc-1")).hasMatch());
+    QVERIFY(copy.match(QByteArrayView("123")).hasMatch());
+    QVERIFY(re.match(QByteArrayView("abc-1")).hasMatch());
+
+    // invalid patterns never match
+    const QRegularExpression invalid(QStringLiteral("("));
+    QTest::ignoreMessage(QtWarningMsg, "QRegularExpressionPrivate::doMatchUtf8(): called on an invalid QRegularExpression object");
+    m = invalid.match(QByteArrayView("("));
+    QVERIFY(!m.isValid());
+}
+
 void tst_QRegularExpression::threadSafety_data()
 {
     QTest::addColumn<QString>("pattern");
@@ -30,11 +30,15 @@
 #include <QSemaphore>
 #include <qcoreapplication.h>
 #include <qreadwritelock.h>
+#include <qdeadlinetimer.h>
 #include <qelapsedtimer.h>
 #include <qmutex.h>
 #include <qthread.h>
 #include <qwaitcondition.h>
 
+#include <functional>
+#include <memory>
+
 #ifdef Q_OS_UNIX
 #include <unistd.h>
 #endif
@@ -85,6 +89,7 @@ private slots:
     void countingTest();
     void limitedReaders();
     void deleteOnUnlock();
+    void writerPreference();
 
 /*
     Performance tests
@@ -889,6 +894,72 @@ void tst_QReadWriteLock::deleteOnUnlock()
 }
 
 
+class FunctionThread : public QThread
+{
+public:
+    explicit FunctionThread(std::function<void()> f) : f(std::move(f)) { }
+    void run() override { f(); }
+private:
+    std::function<void()> f;
+};
+
+// returns true once a writer waiting for the lock keeps new readers out
+static bool waitForBlockedReaders(QReadWriteLock &rwlock)
+{
+    QDeadlineTimer deadline(5000);
+    while (!deadline.hasExpired()) {
+        if (!rwlock.tryLockForRead())
+            return true;
+        rwlock.unlock();
+        QThread::msleep(1);
+    }
+    return false;
+}
+
+void tst_QReadWriteLock::writerPreference()
+{
+    QReadWriteLock rwlock;
+
+    // a waiting writer keeps new readers out, even if the lock is only held for read
+    rwlock.lockForRead();
+    QSemaphore writerDone;
+    std::unique_ptr<QThread> writer(new FunctionThread([&] {
+        rwlock.lockForWrite();
+        rwlock.unlock();
+        writerDone.release();
+    }));
+    writer->start();
+    QVERIFY(waitForBlockedReaders(rwlock));
+    QVERIFY(!writerDone.tryAcquire());
+    rwlock.unlock();
+    QVERIFY(writerDone.tryAcquire(1, 5000));
+    QVERIFY(writer->wait());
+
+    // ... and lets them in again when it gives up
+    rwlock.lockForRead();
+    bool writerTimedOut = false;
+    writer.reset(new FunctionThread([&] {
+        writerTimedOut = !rwlock.tryLockForWrite(500);
+    }));
+    QSemaphore readerDone;
+    std::unique_ptr<QThread> reader(new FunctionThread([&] {
+        rwlock.lockForRead();
+        readerDone.release();
+        rwlock.unlock();
+    }));
+    writer->start();
+    QVERIFY(waitForBlockedReaders(rwlock));
+    reader->start();
+    QVERIFY(readerDone.tryAcquire(1, 5000));
+    QVERIFY(writer->wait());
+    QVERIFY(reader->wait());
+    QVERIFY(writerTimedOut);
+    rwlock.unlock();
+
+    QVERIFY(rwlock.tryLockForWrite());
+    rwlock.unlock();
+}
+
 void tst_QReadWriteLock::uncontendedLocks()
 {
 
@@ -30,6 +30,8 @@
 #include <QTemporaryFile>
 #include <QString>
 #include <QDirIterator>
+#include <QEventLoop>
+#include <QTemporaryDir>
 
 #include <private/qfsfileengine_p.h>
 
@@ -107,6 +109,9 @@ private slots:
     void readBigFile_posix();
     void readBigFile_Win32();
 
+    void readFilesInParallel_data();
+    void readFilesInParallel();
+
 private:
     void readBigFile_data(BenchmarkType type, QIODevice::OpenModeFlag t, QIODevice::OpenModeFlag b);
     void readBigFile();
@@ -702,6 +707,87 @@ void tst_qfile::readSmallFiles()
     delete[] buffer;
 }
 
+void tst_qfile::readFilesInParallel_data()
+{
+    QTest::addColumn<bool>("asynchronous");
+    QTest::addColumn<int>("fileCount");
+
+    for (int fileCount : {1, 4, 16}) {
+        QTest::addRow("blocking-%d", fileCount) << false << fileCount;
+        QTest::addRow("asynchronous-%d", fileCount) << true << fileCount;
+    }
+}
+
+void tst_qfile::readFilesInParallel()
+{
+    QFETCH(bool, asynchronous);
+    QFETCH(int, fileCount);
+
+    const qint64 fileSize = 8 * 1024 * 1024;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QByteArray chunk(1024 * 1024, 'a');
+    QStringList names;
+    for (int i = 0; i < fileCount; ++i) {
+        names << dir.filePath(QString::number(i));
+        QFile file(names.constLast());
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        for (qint64 written = 0; written < fileSize; written += chunk.size())
+            QCOMPARE(file.write(chunk), chunk.size());
+    }
+
+    QList<QFile *> files;
+    for (const QString &name : qAsConst(names)) {
+        QFile *file = new QFile(name);
+        file->setAsynchronous(asynchronous);
+        QVERIFY(file->open(QIODevice::ReadOnly));
+        files << file;
+    }
+    if (asynchronous && !files.constFirst()->isAsynchronous())
+        QSKIP("Asynchronous file I/O is not available on this system");
+
+    QByteArray buffer(256 * 1024, Qt::Uninitialized);
+    QBENCHMARK {
+        qint64 total = 0;
+        if (asynchronous) {
+            QEventLoop loop;
+            int remaining = fileCount;
+            QList<QMetaObject::Connection> connections;
+            for (QFile *file : qAsConst(files)) {
+                file->seek(0);
+                connections << connect(file, &QIODevice::readyRead, &loop, [&, file] {
+                    qint64 n;
+                    while ((n = file->read(buffer.data(), buffer.size())) > 0)
+                        total += n;
+                    if (file->pos() == fileSize && --remaining == 0)
+                        loop.quit();
+                });
+            }
+            loop.exec();
+            for (const auto &c : qAsConst(connections))
+                disconnect(c);
+        } else {
+            // what a thread would do without asynchronous I/O: serve the
+            // files one chunk at a time, round-robin
+            for (QFile *file : qAsConst(files))
+                file->seek(0);
+            int remaining = fileCount;
+            while (remaining) {
+                for (QFile *file : qAsConst(files)) {
+                    if (file->atEnd())
+                        continue;
+                    total += file->read(buffer.data(), buffer.size());
+                    if (file->atEnd())
+                        --remaining;
+                }
+            }
+        }
+        QCOMPARE(total, fileSize * fileCount);
+    }
+
+    qDeleteAll(files);
+}
+
 QTEST_MAIN(tst_qfile)
 
 #include "main.moc"
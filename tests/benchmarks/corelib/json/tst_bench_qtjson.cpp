@@ -27,8 +27,15 @@
 ****************************************************************************/
 
 #include <QTest>
+#include <QElapsedTimer>
+#include <QTemporaryFile>
 #include <qjsondocument.h>
 #include <qjsonobject.h>
+#include <qjsonstreamreader.h>
+
+#ifdef Q_OS_LINUX
+#  include <malloc.h>
+#endif
 
 class BenchmarkQtJson: public QObject
 {
@@ -48,8 +55,47 @@ private Q_SLOTS:
 
     void jsonObjectInsert();
     void variantMapInsert();
+
+    void parseThroughput_data();
+    void parseThroughput();
+
+    void parseLargeFile();
+    void streamLargeFile();
+    void streamLargeFileSkipping();
+    void peakMemory_data();
+    void peakMemory();
+
+private:
+    QTemporaryFile largeFile;
 };
 
+#ifdef Q_OS_LINUX
+// Returns the value of a "Vm...:    1234 kB" line of /proc/self/status, in bytes.
+static qint64 procStatus(const char *field)
+{
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly))
+        return -1;
+    for (const QByteArray &line : status.readAll().split('\n')) {
+        if (line.startsWith(field))
+            return line.mid(qstrlen(field)).trimmed().split(' ').first().toLongLong() * 1024;
+    }
+    return -1;
+}
+
+// Resets the peak resident set size, which needs Linux 4.0. The memory
+// freed by the previous benchmarks is given back first, so that it doesn't
+// hide the memory used by the next one.
+static bool resetPeakMemory()
+{
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+    QFile clearRefs("/proc/self/clear_refs");
+    return clearRefs.open(QIODevice::WriteOnly) && clearRefs.write("5") == 1;
+}
+#endif
+
 BenchmarkQtJson::BenchmarkQtJson(QObject *parent) : QObject(parent)
 {
 
@@ -57,7 +103,24 @@ BenchmarkQtJson::BenchmarkQtJson(QObject *parent) : QObject(parent)
 
 void BenchmarkQtJson::initTestCase()
 {
-
+    // about 32 MB of records, like a large export
+    QVERIFY(largeFile.open());
+    QByteArray chunk;
+    for (int i = 0; chunk.size() + largeFile.size() < 32 * 1024 * 1024; ++i) {
+        chunk += i ? ",\n" : "[\n";
+        chunk += R"({"id": )" + QByteArray::number(i) + R"(, "name": "record )"
+                + QByteArray::number(i) + R"(", "score": )" + QByteArray::number(i * 0.37)
+                + R"(, "active": )" + (i % 3 ? "true" : "false")
+                + R"(, "tags": ["alpha", "beta", "gamma\u00e9"], "owner": {"name": )"
+                + R"("Jane \"JD\" Doe", "email": "jane.doe@example.com", "id": 4242}})";
+        if (chunk.size() > 1024 * 1024) {
+            QVERIFY(largeFile.write(chunk) == chunk.size());
+            chunk.clear();
+        }
+    }
+    chunk += "\n]\n";
+    QVERIFY(largeFile.write(chunk) == chunk.size());
+    QVERIFY(largeFile.flush());
 }
 
 void BenchmarkQtJson::cleanupTestCase()
@@ -141,6 +204,151 @@ void BenchmarkQtJson::variantMapInsert()
     }
 }
 
+void BenchmarkQtJson::parseThroughput_data()
+{
+    QTest::addColumn<QByteArray>("json");
+
+    // each document is about 4 MB
+    const int size = 4 * 1024 * 1024;
+    QByteArray records = "[";
+    for (int i = 0; records.size() < size; ++i) {
+        records += R"({"id":)" + QByteArray::number(i) + R"(,"name":"record )"
+                + QByteArray::number(i) + R"(","active":true,"tags":["alpha","beta"],)"
+                + R"("owner":{"name":"Jane Doe","email":"jane.doe@example.com"}},)";
+    }
+    records.back() = ']';
+    QTest::newRow("records") << records;
+
+    QByteArray pretty = "[\n";
+    for (int i = 0; pretty.size() < size; ++i) {
+        pretty += "    {\n        \"id\": " + QByteArray::number(i)
+                + ",\n        \"name\": \"record " + QByteArray::number(i)
+                + "\",\n        \"tags\": [\n            \"alpha\",\n            \"beta\"\n"
+                  "        ]\n    },\n";
+    }
+    pretty.chop(2);
+    pretty += "\n]\n";
+    QTest::newRow("pretty") << pretty;
+
+    QByteArray numbers = "[";
+    for (int i = 0; numbers.size() < size; ++i)
+        numbers += QByteArray::number(i * 1.37, 'g', 12) + ',' + QByteArray::number(-i) + ',';
+    numbers.back() = ']';
+    QTest::newRow("numbers") << numbers;
+
+    QByteArray strings = "[";
+    for (int i = 0; strings.size() < size; ++i) {
+        strings += R"("Lorem ipsum dolor sit amet, consectetur adipiscing elit",)"
+                   R"("Gr\u00fc\u00dfe aus K\u00f6ln \"quoted\"\ttab",)"
+                   "\"\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 \xe4\xb8\x96\xe7\x95\x8c\",";
+    }
+    strings.back() = ']';
+    QTest::newRow("strings") << strings;
+}
+
+void BenchmarkQtJson::parseThroughput()
+{
+    QFETCH(QByteArray, json);
+
+    QVERIFY(!QJsonDocument::fromJson(json).isNull());
+
+    // reported in bytes of input per second, so that the rows can be compared
+    QElapsedTimer timer;
+    qint64 iterations = 0;
+    timer.start();
+    do {
+        const QJsonDocument doc = QJsonDocument::fromJson(json);
+        Q_UNUSED(doc);
+        ++iterations;
+    } while (timer.elapsed() < 500);
+    const qint64 elapsed = timer.nsecsElapsed();
+    QTest::setBenchmarkResult(qreal(json.size()) * iterations * 1e9 / elapsed,
+                              QTest::BytesPerSecond);
+}
+
+void BenchmarkQtJson::parseLargeFile()
+{
+    QBENCHMARK {
+        QFile file(largeFile.fileName());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+        QVERIFY(doc.isArray());
+    }
+}
+
+void BenchmarkQtJson::streamLargeFile()
+{
+    QBENCHMARK {
+        QFile file(largeFile.fileName());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QJsonStreamReader reader(&file);
+        qsizetype textSize = 0;
+        while (!reader.atEnd()) {
+            if (reader.readNext() == QJsonStreamReader::String)
+                textSize += reader.text().size();
+        }
+        QVERIFY(!reader.hasError());
+        QVERIFY(textSize);
+    }
+}
+
+void BenchmarkQtJson::streamLargeFileSkipping()
+{
+    // only looks at the "id" of each record
+    QBENCHMARK {
+        QFile file(largeFile.fileName());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QJsonStreamReader reader(&file);
+        qint64 sum = 0;
+        while (!reader.atEnd()) {
+            if (reader.readNext() != QJsonStreamReader::Name)
+                continue;
+            if (reader.text() == "id" && reader.depth() == 2) {
+                reader.readNext();
+                sum += reader.toInteger();
+            } else {
+                reader.skipCurrentValue();
+            }
+        }
+        QVERIFY(!reader.hasError());
+        QVERIFY(sum);
+    }
+}
+
+void BenchmarkQtJson::peakMemory_data()
+{
+    QTest::addColumn<bool>("streaming");
+
+    QTest::newRow("fromJson") << false;
+    QTest::newRow("QJsonStreamReader") << true;
+}
+
+void BenchmarkQtJson::peakMemory()
+{
+#ifdef Q_OS_LINUX
+    QFETCH(bool, streaming);
+
+    if (!resetPeakMemory())
+        QSKIP("Cannot reset the peak memory usage");
+    const qint64 before = procStatus("VmRSS:");
+
+    QFile file(largeFile.fileName());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    if (streaming) {
+        QJsonStreamReader reader(&file);
+        while (!reader.atEnd())
+            reader.readNext();
+        QVERIFY(!reader.hasError());
+    } else {
+        const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+        QVERIFY(doc.isArray());
+    }
+    QTest::setBenchmarkResult(procStatus("VmHWM:") - before, QTest::BytesAllocated);
+#else
+    QSKIP("Only supported on Linux");
+#endif
+}
+
 QTEST_MAIN(BenchmarkQtJson)
 #include "tst_bench_qtjson.moc"
 
@@ -30,6 +30,18 @@
 #include <qtest.h>
 #include <qtesteventloop.h>
 
+#ifdef Q_OS_UNIX
+#  include <QtCore/private/qeventdispatcher_unix_p.h>
+#  if QT_CONFIG(epoll)
+#    include <QtCore/private/qeventdispatcher_epoll_p.h>
+#  endif
+#  include <sys/resource.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+#include <memory>
+
 class PingPong : public QObject
 {
 public:
@@ -96,6 +108,10 @@ private slots:
     void sendEvent();
     void postEvent_data();
     void postEvent();
+    void crossThreadPostEvent_data();
+    void crossThreadPostEvent();
+    void socketNotifierScaling_data();
+    void socketNotifierScaling();
 };
 
 void EventsBench::initTestCase()
@@ -169,6 +185,130 @@ void EventsBench::postEvent()
     }
 }
 
+void EventsBench::crossThreadPostEvent_data()
+{
+    QTest::addColumn<int>("producers");
+    for (int producers : { 1, 2, 4, 8 })
+        QTest::addRow("%d", producers) << producers;
+}
+
+// Measures the throughput of queued slot invocations posted from a number
+// of threads to a single object living in this one.
+void EventsBench::crossThreadPostEvent()
+{
+    QFETCH(int, producers);
+    const int eventsPerProducer = 10000;
+    const int total = producers * eventsPerProducer;
+
+    QObject receiver;
+    int received = 0;
+    auto slot = [&received, total] {
+        if (++received == total)
+            QTestEventLoop::instance().exitLoop();
+    };
+
+    QBENCHMARK {
+        received = 0;
+        std::vector<std::unique_ptr<QThread>> threads;
+        for (int i = 0; i < producers; ++i) {
+            threads.emplace_back(QThread::create([&receiver, &slot, eventsPerProducer] {
+                for (int j = 0; j < eventsPerProducer; ++j)
+                    QMetaObject::invokeMethod(&receiver, slot, Qt::QueuedConnection);
+            }));
+            threads.back()->start();
+        }
+        QTestEventLoop::instance().enterLoop(60);
+        for (const auto &thread : threads)
+            thread->wait();
+    }
+    QCOMPARE(received, total);
+}
+
+void EventsBench::socketNotifierScaling_data()
+{
+    QTest::addColumn<QByteArray>("dispatcher");
+    QTest::addColumn<int>("connections");
+
+    QByteArrayList dispatchers = { "unix" };
+#if defined(Q_OS_UNIX) && QT_CONFIG(epoll)
+    dispatchers << "epoll";
+#endif
+
+    for (const QByteArray &dispatcher : qAsConst(dispatchers)) {
+        for (int connections : { 1, 10, 100, 1000, 5000 })
+            QTest::addRow("%s-%d", dispatcher.constData(), connections) << dispatcher << connections;
+    }
+}
+
+// Measures the cost of one wakeup with a single ready connection while
+// many more idle connections are being watched.
+void EventsBench::socketNotifierScaling()
+{
+#ifdef Q_OS_UNIX
+    QFETCH(QByteArray, dispatcher);
+    QFETCH(int, connections);
+
+    // each connection uses a pipe, i.e. two descriptors
+    const rlim_t neededFds = rlim_t(connections) * 2 + 64;
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < neededFds) {
+        limit.rlim_cur = qMin(neededFds, limit.rlim_max);
+        setrlimit(RLIMIT_NOFILE, &limit);
+        if (limit.rlim_cur < neededFds)
+            QSKIP("Not enough file descriptors available");
+    }
+
+    std::unique_ptr<QAbstractEventDispatcher> eventDispatcher;
+#if QT_CONFIG(epoll)
+    if (dispatcher == "epoll")
+        eventDispatcher.reset(new QEventDispatcherEpoll);
+#endif
+    if (!eventDispatcher)
+        eventDispatcher.reset(new QEventDispatcherUNIX);
+
+    // The notifiers are registered with the dispatcher under test directly,
+    // bypassing the one installed for this thread.
+    QList<QSocketNotifier *> notifiers;
+    QList<int> writeFds;
+    int activations = 0;
+    for (int i = 0; i < connections; ++i) {
+        int fds[2];
+        if (::pipe(fds) == -1)
+            QFAIL("Cannot create pipe");
+        ::fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        writeFds << fds[1];
+
+        auto notifier = new QSocketNotifier(fds[0], QSocketNotifier::Read);
+        notifier->setEnabled(false);
+        connect(notifier, &QSocketNotifier::activated, notifier, [&activations](QSocketDescriptor socket) {
+            char c;
+            while (::read(socket, &c, 1) > 0)
+                ++activations;
+        });
+        eventDispatcher->registerSocketNotifier(notifier);
+        notifiers << notifier;
+    }
+
+    int next = 0;
+    QBENCHMARK {
+        ::write(writeFds.at(next), "x", 1);
+        next = (next + 1) % connections;
+        eventDispatcher->processEvents(QEventLoop::AllEvents);
+    }
+    QVERIFY(activations > 0);
+
+    for (QSocketNotifier *notifier : qAsConst(notifiers)) {
+        eventDispatcher->unregisterSocketNotifier(notifier);
+        ::close(int(notifier->socket()));
+        delete notifier;
+    }
+    for (int fd : qAsConst(writeFds))
+        ::close(fd);
+#else
+    QSKIP("This benchmark requires a UNIX event dispatcher");
+#endif
+}
+
 QTEST_MAIN(EventsBench)
 
 #include "main.moc"
@@ -32,6 +32,9 @@
 #include <qcoreapplication.h>
 #include <qdatetime.h>
 
+#include <atomic>
+#include <thread>
+
 enum {
     CreationDeletionBenckmarkConstant = 34567,
     SignalsAndSlotsBenchmarkConstant = 456789
@@ -45,6 +48,10 @@ private slots:
     void signal_slot_benchmark_data();
     void signal_many_receivers();
     void signal_many_receivers_data();
+    void queued_emit_benchmark_data();
+    void queued_emit_benchmark();
+    void multithreaded_emit_benchmark_data();
+    void multithreaded_emit_benchmark();
     void qproperty_benchmark_data();
     void qproperty_benchmark();
     void dynamic_property_benchmark();
@@ -198,6 +205,87 @@ void QObjectBenchmark::signal_many_receivers()
     }
 }
 
+void QObjectBenchmark::queued_emit_benchmark_data()
+{
+    QTest::addColumn<bool>("batched");
+    QTest::newRow("queued") << false;
+    QTest::newRow("batched") << true;
+}
+
+void QObjectBenchmark::queued_emit_benchmark()
+{
+    QFETCH(bool, batched);
+    Object sender;
+    QObject receiver;
+    int calls = 0;
+    const auto type = batched ? Qt::ConnectionType(Qt::QueuedConnection | Qt::BatchedConnection)
+                              : Qt::QueuedConnection;
+    QObject::connect(&sender, &Object::signal0, &receiver, [&calls] { ++calls; }, type);
+
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i)
+            sender.emitSignal0();
+        QCoreApplication::sendPostedEvents(&receiver, QEvent::MetaCall);
+    }
+    QVERIFY(calls >= 1000);
+}
+
+void QObjectBenchmark::multithreaded_emit_benchmark_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::addColumn<bool>("churn");
+    for (int threadCount : {1, 2, 4, 8}) {
+        QTest::addRow("%d threads", threadCount) << threadCount << false;
+        QTest::addRow("%d threads, concurrent connect/disconnect", threadCount) << threadCount << true;
+    }
+}
+
+void QObjectBenchmark::multithreaded_emit_benchmark()
+{
+    QFETCH(int, threadCount);
+    QFETCH(bool, churn);
+    const int emissionsPerThread = 100000;
+
+    // the receivers live in this thread, so every emission is a cross-thread one
+    Object sender;
+    Object receivers[4];
+    std::atomic<int> calls{0};
+    for (Object &receiver : receivers) {
+        QObject::connect(&sender, &Object::signal0, &receiver,
+                         [&calls] { calls.fetch_add(1, std::memory_order_relaxed); },
+                         Qt::DirectConnection);
+    }
+
+    QBENCHMARK {
+        std::atomic<bool> done{false};
+        std::thread churner;
+        if (churn) {
+            churner = std::thread([&] {
+                Object receiver;
+                while (!done.load(std::memory_order_relaxed)) {
+                    QObject::disconnect(QObject::connect(&sender, &Object::signal0,
+                                                         &receiver, &Object::slot0,
+                                                         Qt::DirectConnection));
+                }
+            });
+        }
+
+        std::vector<std::thread> emitters;
+        for (int i = 0; i < threadCount; ++i) {
+            emitters.emplace_back([&] {
+                for (int j = 0; j < emissionsPerThread; ++j)
+                    sender.emitSignal0();
+            });
+        }
+        for (std::thread &t : emitters)
+            t.join();
+        done.store(true, std::memory_order_relaxed);
+        if (churner.joinable())
+            churner.join();
+    }
+    QVERIFY(calls.load() >= threadCount * emissionsPerThread * 4);
+}
+
 void QObjectBenchmark::qproperty_benchmark_data()
 {
     QTest::addColumn<QByteArray>("name");
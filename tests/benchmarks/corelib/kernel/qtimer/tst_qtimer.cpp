@@ -0,0 +1,121 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QCoreApplication>
+#include <QTest>
+#include <QTimer>
+
+class tst_QTimer : public QObject
+{
+    Q_OBJECT
+private slots:
+    void start_data();
+    void start();
+    void restart_data() { start_data(); }
+    void restart();
+    void processEventsWithPendingTimers_data() { start_data(); }
+    void processEventsWithPendingTimers();
+
+private:
+    QList<QTimer *> createTimers(QObject *parent);
+};
+
+void tst_QTimer::start_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<Qt::TimerType>("timerType");
+
+    for (int count : { 1000, 100000 }) {
+        const QByteArray suffix = QByteArray::number(count);
+        QTest::newRow(("precise-" + suffix).constData()) << count << Qt::PreciseTimer;
+        QTest::newRow(("coarse-" + suffix).constData()) << count << Qt::CoarseTimer;
+        QTest::newRow(("verycoarse-" + suffix).constData()) << count << Qt::VeryCoarseTimer;
+    }
+}
+
+QList<QTimer *> tst_QTimer::createTimers(QObject *parent)
+{
+    QFETCH(int, count);
+    QFETCH(Qt::TimerType, timerType);
+
+    // intervals between one minute and a bit over one hour, so that the
+    // timers never fire while the benchmark runs
+    QList<QTimer *> timers;
+    timers.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QTimer *timer = new QTimer(parent);
+        timer->setTimerType(timerType);
+        timer->setInterval(60 * 1000 + (i * 7919) % (3600 * 1000));
+        timers.append(timer);
+    }
+    return timers;
+}
+
+void tst_QTimer::start()
+{
+    QObject parent;
+    const QList<QTimer *> timers = createTimers(&parent);
+
+    QBENCHMARK {
+        for (QTimer *timer : timers)
+            timer->start();
+        for (QTimer *timer : timers)
+            timer->stop();
+    }
+}
+
+void tst_QTimer::restart()
+{
+    QObject parent;
+    const QList<QTimer *> timers = createTimers(&parent);
+    for (QTimer *timer : timers)
+        timer->start();
+
+    QBENCHMARK {
+        for (QTimer *timer : timers)
+            timer->start();
+    }
+}
+
+void tst_QTimer::processEventsWithPendingTimers()
+{
+    QObject parent;
+    const QList<QTimer *> timers = createTimers(&parent);
+    for (QTimer *timer : timers)
+        timer->start();
+
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i)
+            QCoreApplication::processEvents();
+    }
+}
+
+QTEST_MAIN(tst_QTimer)
+
+#include "tst_qtimer.moc"
@@ -0,0 +1,193 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QByteArrayMatcher>
+#include <QMultiStringMatcher>
+#include <QRandomGenerator>
+#include <QStringMatcher>
+#include <QTest>
+
+/*
+    Compares searching a log for many keywords, one QStringMatcher pass per
+    keyword, with a single pass of QMultiStringMatcher.
+*/
+class tst_QMultiStringMatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void stringMatcherPerPattern_data() { data(); }
+    void stringMatcherPerPattern();
+    void multiStringMatcher_data() { data(); }
+    void multiStringMatcher();
+    void byteArrayMatcherPerPattern_data() { data(); }
+    void byteArrayMatcherPerPattern();
+    void multiByteArrayMatcher_data() { data(); }
+    void multiByteArrayMatcher();
+    void compile_data() { data(); }
+    void compile();
+
+private:
+    void data();
+
+    QStringList keywords;
+    QString log;
+};
+
+static QString randomWord(QRandomGenerator &rng, int minLength, int maxLength)
+{
+    QString word;
+    const int length = minLength + rng.bounded(maxLength - minLength + 1);
+    for (int i = 0; i < length; ++i)
+        word += QChar(u'a' + rng.bounded(26));
+    return word;
+}
+
+void tst_QMultiStringMatcher::initTestCase()
+{
+    QRandomGenerator rng(42);
+    for (int i = 0; i < 1000; ++i)
+        keywords.append(randomWord(rng, 6, 12));
+
+    // about 1 MB of log lines, with a keyword on one line out of 50,
+    // half of them taken from the first ten keywords
+    for (int line = 0; log.size() < 1024 * 1024; ++line) {
+        log += QLatin1String("2021-03-01 12:00:00.000 [worker-")
+                + QString::number(rng.bounded(16)) + QLatin1String("] ");
+        for (int i = 0; i < 8; ++i)
+            log += randomWord(rng, 3, 8) + u' ';
+        if (line % 100 == 0)
+            log += keywords.at(rng.bounded(int(keywords.size())));
+        else if (line % 100 == 50)
+            log += keywords.at(rng.bounded(10));
+        log += u'\n';
+    }
+}
+
+void tst_QMultiStringMatcher::data()
+{
+    QTest::addColumn<int>("patternCount");
+    QTest::addColumn<Qt::CaseSensitivity>("cs");
+
+    for (int count : { 10, 100, 1000 }) {
+        QTest::addRow("%d-sensitive", count) << count << Qt::CaseSensitive;
+        QTest::addRow("%d-insensitive", count) << count << Qt::CaseInsensitive;
+    }
+}
+
+void tst_QMultiStringMatcher::stringMatcherPerPattern()
+{
+    QFETCH(int, patternCount);
+    QFETCH(Qt::CaseSensitivity, cs);
+
+    QList<QStringMatcher> matchers;
+    for (const QString &keyword : keywords.mid(0, patternCount))
+        matchers.append(QStringMatcher(keyword, cs));
+
+    qsizetype found = 0;
+    QBENCHMARK {
+        found = 0;
+        for (const QStringMatcher &matcher : qAsConst(matchers)) {
+            for (qsizetype i = matcher.indexIn(log); i != -1; i = matcher.indexIn(log, i + 1))
+                ++found;
+        }
+    }
+    QVERIFY(found > 0);
+}
+
+void tst_QMultiStringMatcher::multiStringMatcher()
+{
+    QFETCH(int, patternCount);
+    QFETCH(Qt::CaseSensitivity, cs);
+
+    const QMultiStringMatcher matcher(keywords.mid(0, patternCount), cs);
+    qsizetype found = 0;
+    QBENCHMARK {
+        found = matcher.matchesIn(log).size();
+    }
+    QVERIFY(found > 0);
+}
+
+void tst_QMultiStringMatcher::byteArrayMatcherPerPattern()
+{
+    QFETCH(int, patternCount);
+    QFETCH(Qt::CaseSensitivity, cs);
+    if (cs == Qt::CaseInsensitive)
+        QSKIP("QByteArrayMatcher is case sensitive");
+
+    QList<QByteArrayMatcher> matchers;
+    for (const QString &keyword : keywords.mid(0, patternCount))
+        matchers.append(QByteArrayMatcher(keyword.toLatin1()));
+    const QByteArray data = log.toLatin1();
+
+    qsizetype found = 0;
+    QBENCHMARK {
+        found = 0;
+        for (const QByteArrayMatcher &matcher : qAsConst(matchers)) {
+            for (qsizetype i = matcher.indexIn(data); i != -1; i = matcher.indexIn(data, i + 1))
+                ++found;
+        }
+    }
+    QVERIFY(found > 0);
+}
+
+void tst_QMultiStringMatcher::multiByteArrayMatcher()
+{
+    QFETCH(int, patternCount);
+    QFETCH(Qt::CaseSensitivity, cs);
+
+    QByteArrayList patterns;
+    for (const QString &keyword : keywords.mid(0, patternCount))
+        patterns.append(keyword.toLatin1());
+    const QMultiByteArrayMatcher matcher(patterns, cs);
+    const QByteArray data = log.toLatin1();
+
+    qsizetype found = 0;
+    QBENCHMARK {
+        found = matcher.matchesIn(data).size();
+    }
+    QVERIFY(found > 0);
+}
+
+void tst_QMultiStringMatcher::compile()
+{
+    QFETCH(int, patternCount);
+    QFETCH(Qt::CaseSensitivity, cs);
+
+    const QStringList patterns = keywords.mid(0, patternCount);
+    QBENCHMARK {
+        QMultiStringMatcher matcher(patterns, cs);
+        Q_UNUSED(matcher);
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_QMultiStringMatcher)
+
+#include "tst_bench_qmultistringmatcher.moc"
@@ -70,6 +70,14 @@ private slots:
     void queryMatchResultsByGroupIndex();
     void queryMatchResultsByGroupName();
     void iterateThroughGlobalMatchResults();
+
+    void matchUtf8ViaQString_data() { matchUtf8Data(); }
+    void matchUtf8ViaQString();
+    void matchUtf8_data() { matchUtf8Data(); }
+    void matchUtf8();
+
+private:
+    void matchUtf8Data();
 };
 
 void tst_QRegularExpressionBenchmark::createDefault()
@@ -295,6 +303,50 @@ void tst_QRegularExpressionBenchmark::iterateThroughGlobalMatchResults()
     }
 }
 
+void tst_QRegularExpressionBenchmark::matchUtf8Data()
+{
+    QTest::addColumn<QByteArray>("subject");
+
+    const QString latin = textToMatch + QLatin1String(". ");
+    const QString cyrillic = QString::fromUtf8("Съешь же ещё этих мягких французских булок. ");
+
+    QTest::newRow("short") << textToMatch.toUtf8();
+    QTest::newRow("long-latin") << latin.repeated(100).toUtf8();
+    QTest::newRow("long-cyrillic") << cyrillic.repeated(100).toUtf8();
+}
+
+/*!
+    \internal This benchmark measures matching UTF-8 data the way it had to
+    be done before the UTF-8 overload of match() existed, converting the
+    subject to QString first. Compare with matchUtf8().
+*/
+void tst_QRegularExpressionBenchmark::matchUtf8ViaQString()
+{
+    QFETCH(QByteArray, subject);
+    QRegularExpression re(nonEmptyPattern, nonEmptyPatternOptions | QRegularExpression::UseUnicodePropertiesOption);
+    re.optimize();
+    QBENCHMARK {
+        auto matchResult = re.match(QString::fromUtf8(subject));
+        Q_UNUSED(matchResult);
+    }
+}
+
+/*!
+    \internal This benchmark measures matching UTF-8 data directly, with the
+    pattern compiled for the 8-bit PCRE2 library. The first match (outside of
+    the measured loop) compiles it.
+*/
+void tst_QRegularExpressionBenchmark::matchUtf8()
+{
+    QFETCH(QByteArray, subject);
+    QRegularExpression re(nonEmptyPattern, nonEmptyPatternOptions | QRegularExpression::UseUnicodePropertiesOption);
+    QVERIFY(re.match(QUtf8StringView(subject)).hasMatch());
+    QBENCHMARK {
+        auto matchResult = re.match(QUtf8StringView(subject));
+        Q_UNUSED(matchResult);
+    }
+}
+
 QTEST_MAIN(tst_QRegularExpressionBenchmark)
 
 #include "tst_bench_qregularexpression.moc"
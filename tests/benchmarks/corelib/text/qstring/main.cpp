@@ -29,6 +29,8 @@
 #include <QFile>
 #include <QTest>
 
+#include <private/qsimd_p.h>
+
 class tst_QString: public QObject
 {
     Q_OBJECT
@@ -48,7 +50,28 @@ private slots:
     void toCaseFolded_data();
     void toCaseFolded();
 
+    // these are run once per instruction set supported by the CPU
+    void cleanup();
+    void fromLatin1_data() { simd_data(); }
+    void fromLatin1();
+    void toLatin1_data() { simd_data(); }
+    void toLatin1();
+    void indexOfChar_data() { simd_data(); }
+    void indexOfChar();
+    void compare_data() { simd_data(); }
+    void compare();
+    void compareLatin1_data() { simd_data(); }
+    void compareLatin1();
+    void toUtf8_data() { simd_data(); }
+    void toUtf8();
+    void fromUtf8_data() { simd_data(); }
+    void fromUtf8();
+
 private:
+    void simd_data();
+    bool restrictCpuFeatures();
+    quint64 originalCpuFeatures = 0;
+
     void section_data_impl(bool includeRegExOnly = true);
     template <typename RX> void section_impl();
 };
@@ -187,6 +210,161 @@ void tst_QString::toCaseFolded()
     }
 }
 
+void tst_QString::simd_data()
+{
+    QTest::addColumn<quint64>("required");
+    QTest::addColumn<quint64>("disabled");
+    QTest::addColumn<int>("size");
+
+    struct Isa {
+        const char *name;
+        quint64 required;
+        quint64 disabled;
+    };
+    const Isa isas[] = {
+#ifdef Q_PROCESSOR_X86
+        { "sse2", 0, CpuFeatureSSE4_1 | CpuFeatureAVX2 | CpuFeatureAVX512BW },
+        { "sse4.1", CpuFeatureSSE4_1, CpuFeatureAVX2 | CpuFeatureAVX512BW },
+        { "avx2", CpuFeatureAVX2, CpuFeatureAVX512BW },
+        { "avx512bw", CpuFeatureAVX512BW, 0 },
+#else
+        { "default", 0, 0 },
+#endif
+    };
+    for (const Isa &isa : isas) {
+        for (int size : { 7, 64, 1000 })
+            QTest::addRow("%s:%d", isa.name, size) << isa.required << isa.disabled << size;
+    }
+}
+
+// Hides CPU features from Qt's runtime dispatch, so that the code for each
+// instruction set can be measured on the same machine. cleanup() undoes it.
+bool tst_QString::restrictCpuFeatures()
+{
+    QFETCH(quint64, required);
+    QFETCH(quint64, disabled);
+
+    const quint64 features = qCpuFeatures();
+    if ((features & required) != required || (qCompilerCpuFeatures & disabled))
+        return false;
+    originalCpuFeatures = features;
+#ifdef Q_ATOMIC_INT64_IS_SUPPORTED
+    qt_cpu_features[0].storeRelaxed(features & ~disabled);
+#else
+    qt_cpu_features[0].storeRelaxed(uint(features & ~disabled));
+    qt_cpu_features[1].storeRelaxed(uint((features & ~disabled) >> 32));
+#endif
+    return true;
+}
+
+void tst_QString::cleanup()
+{
+    if (!originalCpuFeatures)
+        return;
+#ifdef Q_ATOMIC_INT64_IS_SUPPORTED
+    qt_cpu_features[0].storeRelaxed(originalCpuFeatures);
+#else
+    qt_cpu_features[0].storeRelaxed(uint(originalCpuFeatures));
+    qt_cpu_features[1].storeRelaxed(uint(originalCpuFeatures >> 32));
+#endif
+    originalCpuFeatures = 0;
+}
+
+#define RESTRICT_CPU_FEATURES() \
+    if (!restrictCpuFeatures()) \
+        QSKIP("Instruction set not available or always enabled in this build")
+
+static QByteArray latin1Text(int size)
+{
+    QByteArray result(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i)
+        result[i] = char('a' + i % 26);
+    return result;
+}
+
+void tst_QString::fromLatin1()
+{
+    QFETCH(int, size);
+    const QByteArray latin1 = latin1Text(size);
+    RESTRICT_CPU_FEATURES();
+
+    QBENCHMARK {
+        QString s = QString::fromLatin1(latin1);
+        Q_UNUSED(s);
+    }
+}
+
+void tst_QString::toLatin1()
+{
+    QFETCH(int, size);
+    const QString s = QString::fromLatin1(latin1Text(size));
+    RESTRICT_CPU_FEATURES();
+
+    QBENCHMARK {
+        QByteArray latin1 = s.toLatin1();
+        Q_UNUSED(latin1);
+    }
+}
+
+void tst_QString::indexOfChar()
+{
+    QFETCH(int, size);
+    const QString s = QString::fromLatin1(latin1Text(size)) + u'\u00e9';
+    RESTRICT_CPU_FEATURES();
+
+    QBENCHMARK {
+        QCOMPARE(s.indexOf(u'\u00e9'), size);
+    }
+}
+
+void tst_QString::compare()
+{
+    QFETCH(int, size);
+    const QString s1 = QString::fromLatin1(latin1Text(size));
+    const QString s2 = QString::fromLatin1(latin1Text(size));
+    RESTRICT_CPU_FEATURES();
+
+    QBENCHMARK {
+        QCOMPARE(s1.compare(s2), 0);
+    }
+}
+
+void tst_QString::compareLatin1()
+{
+    QFETCH(int, size);
+    const QByteArray latin1 = latin1Text(size);
+    const QString s = QString::fromLatin1(latin1);
+    RESTRICT_CPU_FEATURES();
+
+    QBENCHMARK {
+        QCOMPARE(s.compare(QLatin1String(latin1)), 0);
+    }
+}
+
+void tst_QString::toUtf8()
+{
+    QFETCH(int, size);
+    const QString s = QString::fromLatin1(latin1Text(size));
+    RESTRICT_CPU_FEATURES();
+
+    QBENCHMARK {
+        QByteArray utf8 = s.toUtf8();
+        Q_UNUSED(utf8);
+    }
+}
+
+void tst_QString::fromUtf8()
+{
+    QFETCH(int, size);
+    const QByteArray utf8 = latin1Text(size);
+    RESTRICT_CPU_FEATURES();
+
+    QBENCHMARK {
+        QString s = QString::fromUtf8(utf8);
+        Q_UNUSED(s);
+    }
+}
+
 QTEST_APPLESS_MAIN(tst_QString)
 
 #include "main.moc"
@@ -0,0 +1,160 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QBuffer>
+#include <QStringDecoder>
+#include <QStringEncoder>
+#include <QTest>
+#include <QTextStream>
+
+class tst_QStringConverter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fromUtf8_data() { corpus_data(); }
+    void fromUtf8();
+    void decoderChunked_data() { corpus_data(); }
+    void decoderChunked();
+    void textStream_data() { corpus_data(); }
+    void textStream();
+    void toUtf8_data() { corpus_data(); }
+    void toUtf8();
+
+private:
+    void corpus_data();
+};
+
+// Builds about 64 kB of UTF-8 text by repeating the lines from \a lines
+static QByteArray makeCorpus(std::initializer_list<const char *> lines)
+{
+    QByteArray result;
+    while (result.size() < 64 * 1024) {
+        for (const char *line : lines) {
+            result += line;
+            result += '\n';
+        }
+    }
+    return result;
+}
+
+void tst_QStringConverter::corpus_data()
+{
+    QTest::addColumn<QByteArray>("utf8");
+
+    QTest::newRow("ascii") << makeCorpus({
+        "The quick brown fox jumps over the lazy dog.",
+        "Pack my box with five dozen liquor jugs, said the sphinx of black quartz."
+    });
+    QTest::newRow("latin") << makeCorpus({
+        "Voix ambiguë d'un cœur qui, au zéphyr, préfère les jattes de kiwis.",
+        "Falsches Üben von Xylophonmusik quält jeden größeren Zwerg."
+    });
+    QTest::newRow("cyrillic") << makeCorpus({
+        "Съешь же ещё этих мягких французских булок, да выпей чаю.",
+        "Широкая электрификация южных губерний даст мощный толчок подъёму сельского хозяйства."
+    });
+    QTest::newRow("greek") << makeCorpus({
+        "Ξεσκεπάζω την ψυχοφθόρα βδελυγμία.",
+        "Τάχιστη αλώπηξ βαφής ψημένη γη, δρασκελίζει υπέρ νωθρού κυνός."
+    });
+    QTest::newRow("arabic") << makeCorpus({
+        "نص حكيم له سر قاطع وذو شأن عظيم مكتوب على ثوب أخضر ومغلف بجلد أزرق",
+        "صِف خَلقَ خَودِ كَمِثلِ الشَمسِ إِذ بَزَغَت"
+    });
+    QTest::newRow("chinese") << makeCorpus({
+        "天地玄黄，宇宙洪荒。日月盈昃，辰宿列张。寒来暑往，秋收冬藏。",
+        "我能吞下玻璃而不伤身体。敏捷的棕色狐狸跳过了懒狗。"
+    });
+    QTest::newRow("japanese") << makeCorpus({
+        "いろはにほへと　ちりぬるを　わかよたれそ　つねならむ",
+        "色は匂へど散りぬるを我が世誰ぞ常ならむ有為の奥山今日越えて"
+    });
+    QTest::newRow("emoji") << makeCorpus({
+        "😀😃😄😁😆😅🤣😂🙂🙃😉😊😇🥰😍🤩😘😗☺😚😙",
+        "🚀 deploy finished ✅ 🎉🎉 — 3 warnings ⚠️, 0 errors 🟢"
+    });
+    QTest::newRow("mixed-log") << makeCorpus({
+        R"({"ts":"2021-04-01T12:00:00Z","level":"info","user":"Łukasz","msg":"Zalogowano pomyślnie"})",
+        R"({"ts":"2021-04-01T12:00:01Z","level":"warn","user":"田中","msg":"セッションの有効期限が切れました 🔒"})",
+        R"({"ts":"2021-04-01T12:00:02Z","level":"info","user":"Дмитрий","msg":"Файл загружен: отчёт.pdf"})",
+        R"({"ts":"2021-04-01T12:00:03Z","level":"error","user":"张伟","msg":"无法连接到服务器，请稍后重试"})"
+    });
+}
+
+void tst_QStringConverter::fromUtf8()
+{
+    QFETCH(QByteArray, utf8);
+
+    QBENCHMARK {
+        QString s = QString::fromUtf8(utf8);
+        Q_UNUSED(s);
+    }
+}
+
+void tst_QStringConverter::decoderChunked()
+{
+    QFETCH(QByteArray, utf8);
+    constexpr qsizetype ChunkSize = 4096;
+
+    QBENCHMARK {
+        QStringDecoder decoder(QStringDecoder::Utf8);
+        QString result;
+        for (qsizetype i = 0; i < utf8.size(); i += ChunkSize)
+            result += decoder.decode(QByteArrayView(utf8.constData() + i, qMin(ChunkSize, utf8.size() - i)));
+        QVERIFY(!decoder.hasError());
+    }
+}
+
+void tst_QStringConverter::textStream()
+{
+    QFETCH(QByteArray, utf8);
+
+    QBENCHMARK {
+        QBuffer buffer(&utf8);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        QTextStream stream(&buffer);
+        QString s = stream.readAll();
+        Q_UNUSED(s);
+    }
+}
+
+void tst_QStringConverter::toUtf8()
+{
+    QFETCH(QByteArray, utf8);
+    const QString s = QString::fromUtf8(utf8);
+
+    QBENCHMARK {
+        QByteArray encoded = s.toUtf8();
+        Q_UNUSED(encoded);
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_QStringConverter)
+
+#include "tst_bench_qstringconverter.moc"
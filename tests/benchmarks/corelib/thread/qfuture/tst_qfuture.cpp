@@ -0,0 +1,136 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <qtest.h>
+#include <QtCore>
+
+class tst_QFuture : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void thenChainReady_data();
+    void thenChainReady();
+    void thenChainPending_data();
+    void thenChainPending();
+    void thenChainString_data();
+    void thenChainString();
+    void thenChainThreadPool_data();
+    void thenChainThreadPool();
+};
+
+static void chainLengthData()
+{
+    QTest::addColumn<int>("length");
+
+    QTest::newRow("10") << 10;
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+}
+
+void tst_QFuture::thenChainReady_data()
+{
+    chainLengthData();
+}
+
+// every continuation is attached to a future that has already finished
+void tst_QFuture::thenChainReady()
+{
+    QFETCH(int, length);
+
+    QBENCHMARK {
+        QFuture<int> future = QtFuture::makeReadyFuture(0);
+        for (int i = 0; i < length; ++i)
+            future = future.then([](int value) { return value + 1; });
+        QCOMPARE(future.result(), length);
+    }
+}
+
+void tst_QFuture::thenChainPending_data()
+{
+    chainLengthData();
+}
+
+// the whole chain is built first and runs when the promise is fulfilled
+void tst_QFuture::thenChainPending()
+{
+    QFETCH(int, length);
+
+    QBENCHMARK {
+        QFutureInterface<int> promise;
+        promise.reportStarted();
+        QFuture<int> future = promise.future();
+        for (int i = 0; i < length; ++i)
+            future = future.then([](int value) { return value + 1; });
+
+        promise.reportResult(0);
+        promise.reportFinished();
+        QCOMPARE(future.result(), length);
+    }
+}
+
+void tst_QFuture::thenChainString_data()
+{
+    chainLengthData();
+}
+
+void tst_QFuture::thenChainString()
+{
+    QFETCH(int, length);
+
+    QBENCHMARK {
+        QFuture<QString> future = QtFuture::makeReadyFuture(QString());
+        for (int i = 0; i < length; ++i)
+            future = future.then([](const QString &value) { return QString(value); });
+        QVERIFY(future.result().isEmpty());
+    }
+}
+
+void tst_QFuture::thenChainThreadPool_data()
+{
+    chainLengthData();
+}
+
+// each step is scheduled on the pool; the benchmark includes the hand-offs
+void tst_QFuture::thenChainThreadPool()
+{
+    QFETCH(int, length);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(1);
+    QBENCHMARK {
+        QFuture<int> future = QtFuture::makeReadyFuture(0);
+        for (int i = 0; i < length; ++i)
+            future = future.then(&pool, [](int value) { return value + 1; });
+        QCOMPARE(future.result(), length);
+    }
+}
+
+QTEST_MAIN(tst_QFuture)
+#include "tst_qfuture.moc"
@@ -66,7 +66,8 @@ private slots:
     void readOnly();
     void writeOnly_data();
     void writeOnly();
-    // void readWrite();
+    void readWrite_data();
+    void readWrite();
 };
 
 struct FunctionPtrHolder
@@ -255,5 +256,76 @@ void tst_QReadWriteLock::writeOnly()
     holder.value();
 }
 
+// Every thread does one write for every writeInterval reads
+template <typename Mutex, typename ReadLocker, typename WriteLocker, int writeInterval>
+void testReadWrite()
+{
+    struct Thread : QThread
+    {
+        Mutex *lock;
+        void run() override
+        {
+            for (int i = 0; i < Iterations; ++i) {
+                QString s = QString::number(i); // Do something outside the lock
+                if (i % writeInterval == 0) {
+                    WriteLocker locker(lock);
+                    global_hash.insert(s, s);
+                } else {
+                    ReadLocker locker(lock);
+                    global_hash.contains(s);
+                }
+            }
+        }
+    };
+    Mutex lock;
+    global_hash.clear();
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < threadCount; ++i) {
+        auto t = std::make_unique<Thread>();
+        t->lock = &lock;
+        threads.push_back(std::move(t));
+    }
+    QBENCHMARK {
+        for (auto &t : threads) {
+            t->start();
+        }
+        for (auto &t : threads) {
+            t->wait();
+        }
+    }
+    global_hash.clear();
+}
+
+template <int writeInterval>
+static void addReadWriteRows(const char *mix)
+{
+    QTest::addRow("QMutex, %s", mix) << FunctionPtrHolder(
+        testReadWrite<QMutex, QMutexLocker<QMutex>, QMutexLocker<QMutex>, writeInterval>);
+    QTest::addRow("QReadWriteLock, %s", mix) << FunctionPtrHolder(
+        testReadWrite<QReadWriteLock, QReadLocker, QWriteLocker, writeInterval>);
+#ifdef __cpp_lib_shared_mutex
+    QTest::addRow("std::shared_mutex, %s", mix) << FunctionPtrHolder(
+        testReadWrite<std::shared_mutex,
+                      LockerWrapper<std::shared_lock<std::shared_mutex>>,
+                      LockerWrapper<std::unique_lock<std::shared_mutex>>, writeInterval>);
+#endif
+}
+
+void tst_QReadWriteLock::readWrite_data()
+{
+    QTest::addColumn<FunctionPtrHolder>("holder");
+
+    addReadWriteRows<1000>("0.1% writes");
+    addReadWriteRows<100>("1% writes");
+    addReadWriteRows<10>("10% writes");
+    addReadWriteRows<2>("50% writes");
+}
+
+void tst_QReadWriteLock::readWrite()
+{
+    QFETCH(FunctionPtrHolder, holder);
+    holder.value();
+}
+
 QTEST_MAIN(tst_QReadWriteLock)
 #include "tst_qreadwritelock.moc"
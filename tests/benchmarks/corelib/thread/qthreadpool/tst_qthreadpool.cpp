@@ -40,6 +40,10 @@ public:
 private slots:
     void startRunnables();
     void activeThreadCount();
+    void manyTinyTasks_data();
+    void manyTinyTasks();
+    void manyTinyTasksFromPoolThreads_data();
+    void manyTinyTasksFromPoolThreads();
 };
 
 tst_QThreadPool::tst_QThreadPool()
@@ -75,5 +79,62 @@ void tst_QThreadPool::activeThreadCount()
     }
 }
 
+static void threadCountData()
+{
+    QTest::addColumn<int>("threadCount");
+
+    const int ideal = QThread::idealThreadCount();
+    for (int threadCount = 1; threadCount < ideal; threadCount *= 2)
+        QTest::addRow("%d", threadCount) << threadCount;
+    QTest::addRow("%d", ideal) << ideal;
+}
+
+void tst_QThreadPool::manyTinyTasks_data()
+{
+    threadCountData();
+}
+
+void tst_QThreadPool::manyTinyTasks()
+{
+    QFETCH(int, threadCount);
+    const int taskCount = 100000;
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threadCount);
+    QAtomicInt counter;
+    QBENCHMARK {
+        for (int i = 0; i < taskCount; ++i)
+            threadPool.start([&counter] { counter.ref(); });
+        threadPool.waitForDone();
+    }
+    QVERIFY(counter.loadRelaxed() % taskCount == 0);
+}
+
+void tst_QThreadPool::manyTinyTasksFromPoolThreads_data()
+{
+    threadCountData();
+}
+
+// tasks starting tasks, as divide and conquer algorithms do
+void tst_QThreadPool::manyTinyTasksFromPoolThreads()
+{
+    QFETCH(int, threadCount);
+    const int tasksPerThread = 100000 / threadCount;
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threadCount);
+    QAtomicInt counter;
+    QBENCHMARK {
+        for (int i = 0; i < threadCount; ++i) {
+            threadPool.start([&] {
+                for (int j = 0; j < tasksPerThread; ++j)
+                    threadPool.start([&counter] { counter.ref(); });
+            });
+        }
+        threadPool.waitForDone();
+    }
+    QVERIFY(counter.loadRelaxed() % (tasksPerThread * threadCount) == 0);
+}
+
 QTEST_MAIN(tst_QThreadPool)
 #include "tst_qthreadpool.moc"